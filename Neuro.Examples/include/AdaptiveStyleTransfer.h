@@ -126,15 +126,9 @@ public:
         {
             NameScope scope("style_loss_" + to_string(i));
 #ifdef USE_GRAMS
-            /*auto gramMatrix = [](TensorLike* x)
-            {
-                uint32_t featureMapSize = x->GetShape().Width() * x->GetShape().Height();
-                auto features = reshape(x, Shape(featureMapSize, x->GetShape().Depth()));
-                return div(matmul(features, transpose(features)), (float)featureMapSize);
-            };*/
-
-            auto gramS = GramMatrix(styleFeat[i], "s_gram_" + to_string(i));
-            auto gramG = GramMatrix(stylizedFeat[i], "g_gram_" + to_string(i));
+            float gramScale = 1.f / (styleFeat[i]->GetShape().Width() * styleFeat[i]->GetShape().Height());
+            auto gramS = gram_matrix(styleFeat[i], gramScale, "s_gram_" + to_string(i));
+            auto gramG = gram_matrix(stylizedFeat[i], gramScale, "g_gram_" + to_string(i));
 
             styleLosses.push_back(mean(square(sub(gramG, gramS))));
 #else
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <numeric>
+
+#include "Args.h"
+#include "Neuro.h"
+
+using namespace std;
+using namespace Neuro;
+
+// Loopback client for BatchingServer. Every client thread sends single-sample requests one after another (next request is sent
+// when previous result arrives), so number of clients bounds achievable batch size. Each max batch size is compared against
+// unbatched serving (max batch size 1).
+// Usage: --clients 16 --requests 200 --batches 1,4,16 --delay 2000 --mode cpu_mkl
+class BatchingServerBenchmark
+{
+public:
+    void Run(const Args& args)
+    {
+        uint32_t clientsNum = args.HasArg("clients") ? args.GetArgInt("clients") : 16;
+        uint32_t requestsNum = args.HasArg("requests") ? args.GetArgInt("requests") : 200;
+        uint32_t delayUs = args.HasArg("delay") ? args.GetArgInt("delay") : 2000;
+        vector<string> batches = args.HasArg("batches") ? args.GetArgArray("batches") : vector<string>{ "1", "4", "16" };
+        string mode = args.HasArg("mode") ? ToLower(args.GetArg("mode")) : "cpu_mkl";
+
+        Tensor::SetDefaultOpMode(mode == "gpu" ? GPU : (mode == "cpu_mt" ? CPU_MT : (mode == "cpu" ? CPU : CPU_MKL)));
+        GlobalRngSeed(1337);
+
+        // same architecture as MnistConvNetwork example
+        auto model = new Sequential("mnist_conv");
+        model->AddLayer(new Conv2D(Shape(28, 28, 1), 32, 3, 1, 0, new ReLU()));
+        model->AddLayer(new MaxPooling2D(2, 2));
+        model->AddLayer(new Conv2D(16, 3, 1, 0, new ReLU()));
+        model->AddLayer(new MaxPooling2D(2, 2));
+        model->AddLayer(new Flatten());
+        model->AddLayer(new Dense(128, new ReLU()));
+        model->AddLayer(new Dense(10, new Softmax()));
+
+        Tensor sample(Shape(28, 28, 1));
+        sample.FillWithRand(-1, 0.f, 1.f);
+        model->Predict(sample); // warmup
+
+        cout << "Clients: " << clientsNum << " requests per client: " << requestsNum << " max delay: " << delayUs << "us" << endl;
+
+        for (auto& batchStr : batches)
+        {
+            BatchingServer server(model, (uint32_t)stoi(batchStr), delayUs);
+
+            vector<vector<double>> latenciesUs(clientsNum);
+            vector<thread> clients;
+
+            Stopwatch timer;
+            timer.Start();
+            for (uint32_t c = 0; c < clientsNum; ++c)
+            {
+                clients.emplace_back([&, c]()
+                {
+                    for (uint32_t i = 0; i < requestsNum; ++i)
+                    {
+                        Stopwatch latency;
+                        latency.Start();
+                        server.Enqueue(sample).get();
+                        latency.Stop();
+                        latenciesUs[c].push_back((double)latency.ElapsedMicroseconds());
+                    }
+                });
+            }
+            for (auto& client : clients)
+                client.join();
+            timer.Stop();
+
+            vector<double> all;
+            for (auto& l : latenciesUs)
+                all.insert(all.end(), l.begin(), l.end());
+            sort(all.begin(), all.end());
+            auto percentile = [&](double p) { return all[min(all.size() - 1, (size_t)(p * (all.size() - 1) + 0.5))]; };
+
+            auto stats = server.GetStats();
+            cout << "  max batch " << setw(4) << server.MaxBatchSize() << fixed << setprecision(1)
+                 << setw(10) << all.size() * 1000000.0 / max<__int64>(timer.ElapsedMicroseconds(), 1) << " req/s"
+                 << "  latency p50 " << setw(8) << percentile(0.5) << "us p99 " << setw(8) << percentile(0.99) << "us"
+                 << "  avg batch " << setw(5) << stats.avgBatchSize << "  avg queue " << setw(8) << stats.avgQueueUs << "us (max " << stats.maxQueueUs << "us)"
+                 << "  avg compute " << setw(8) << stats.avgComputeUs << "us" << endl;
+        }
+
+        delete model;
+    }
+};
@@ -144,9 +144,7 @@ public:
         {
             // make sure this computation method is in sync with NeuralStyleTransfer::GramMatrix
             Tensor* x = targetStyleFeatures[i];
-            uint32_t featureMapSize = x->Width() * x->Height();
-            auto features = x->Reshaped(Shape(featureMapSize, x->Depth()));
-            targetStyleGrams.push_back(new Constant(features.MatMul(features.Transpose()).Div((float)features.GetShape().Length), "style_" + to_string(i) + "_gram"));
+            targetStyleGrams.push_back(new Constant(x->GramMatrix(1.f / x->GetShape().Dim0Dim1Dim2), "style_" + to_string(i) + "_gram"));
             ///targetStyleGrams.push_back(new Constant(features.Mul(features.Transposed()).Div((float)featureMapSize), "style_" + to_string(i) + "_gram"));
         }
 
@@ -198,7 +196,8 @@ public:
         float lastLoss = 0;
 
         ImageLoader contentLoader(contentFiles, BATCH_SIZE, 2);
-        DataPreloader preloader({ input->OutputPtr() }, { &contentLoader }, 4);
+        // content batch is staged by asynchronous run so loading next batch overlaps with current training step
+        DataPreloader preloader({ &contentBatch }, { &contentLoader }, 4);
 
         Tqdm progress(steps, 0);
         progress.ShowStep(true).ShowPercent(false).ShowElapsed(false).ShowIterTime(true);// .EnableSeparateLines(true);
@@ -210,14 +209,19 @@ public:
             preloader.Load();
 #endif
                 
-            auto results = Session::Default()->Run(MergeVectors({ vector<TensorLike*>{ stylizedContentPre, totalLoss, weightedContentLoss, weightedStyleLoss, minimize }, styleLosses }),
-                                                    { /*{ input, &contentBatch },*/ });
+            auto step = Session::Default()->RunAsync(MergeVectors({ vector<TensorLike*>{ stylizedContentPre, totalLoss, weightedContentLoss, weightedStyleLoss, minimize }, styleLosses }),
+                                                     { { input, &contentBatch } });
 
             if (i % DETAILS_ITER == 0)
             {
 #if !defined(SLOW) && !defined(FAST_SINGLE_CONTENT)
+                Session::Default()->Sync();
                 auto results = Session::Default()->Run({ stylizedContentPre, totalLoss, weightedContentLoss, weightedStyleLoss },
                                                         { { input, &testImage } });
+#else
+                vector<const Tensor*> results;
+                for (auto& result : step.get())
+                    results.push_back(&result);
 #endif
 
                 float loss = (*results[1])(0);
@@ -251,6 +255,8 @@ public:
                 cout << "----------------------------------------------------" << endl;
             }
         }
+
+        Session::Default()->Sync();
     }
 
     void Test()
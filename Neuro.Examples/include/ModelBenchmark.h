@@ -0,0 +1,329 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <omp.h>
+#include <concrt.h>
+
+#include "Args.h"
+#include "Neuro.h"
+#include "FastNeuralStyleTransfer.h"
+#include "Pix2Pix.h"
+
+using namespace std;
+using namespace Neuro;
+
+// Measures end-to-end inference and training throughput of example networks on synthetic data.
+// Usage: --models conv,mnist_conv,resnet20,fnst,pix2pix,vgg19 --modes cpu_mt,gpu --threads 0,4 --batch 8 --warmup 2 --steps 10 --data data/ --out model_benchmark.md
+// Thread count 0 means runtime default. VGG19 (feature extractor used by NeuralStyleTransfer) is benchmarked for inference only
+// and requires pretrained weights to be present in data directory.
+class ModelBenchmark
+{
+public:
+    struct Result
+    {
+        string model;
+        string mode;
+        int threads;
+        uint32_t batchSize;
+        string phase; // predict, train_on_batch or fit
+        uint32_t steps;
+        double meanMs;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double imagesPerSec;
+        size_t hostPeakBytes;
+        size_t devicePeakBytes;
+    };
+
+    void Run(const Args& args)
+    {
+        vector<string> models = args.HasArg("models") ? args.GetArgArray("models") : vector<string>{ "conv", "mnist_conv", "resnet20", "fnst", "pix2pix", "vgg19" };
+        vector<string> modes = args.HasArg("modes") ? args.GetArgArray("modes") : vector<string>{ "cpu_mt", "cpu_mkl" };
+        vector<string> threads = args.HasArg("threads") ? args.GetArgArray("threads") : vector<string>{ "0" };
+        m_BatchSize = args.HasArg("batch") ? args.GetArgInt("batch") : 8;
+        m_Warmup = args.HasArg("warmup") ? args.GetArgInt("warmup") : 2;
+        m_Steps = args.HasArg("steps") ? args.GetArgInt("steps") : 10;
+        m_DataDir = args.HasArg("data") ? args.GetArg("data") : "data/";
+        string outFile = args.HasArg("out") ? args.GetArg("out") : "model_benchmark.md";
+
+        vector<Result> results;
+
+        for (auto& modelName : models)
+        for (auto& modeName : modes)
+        for (auto& threadsStr : threads)
+        {
+            int threadsNum = stoi(threadsStr);
+            EOpMode mode = ParseMode(modeName);
+
+            if (mode == GPU && threadsNum > 0)
+                continue; // thread count doesn't affect GPU kernels
+
+            SetThreadsNum(threadsNum);
+            Tensor::SetDefaultOpMode(mode);
+            GlobalRngSeed(1337);
+
+            cout << "Benchmarking '" << modelName << "' mode: " << modeName << " threads: " << (threadsNum > 0 ? to_string(threadsNum) : "default") << endl;
+            Benchmark(ToLower(modelName), modeName, threadsNum, results);
+
+            SetThreadsNum(0);
+        }
+
+        SaveReport(results, outFile);
+        cout << "Report saved to '" << outFile << "'" << endl;
+    }
+
+private:
+    static EOpMode ParseMode(const string& name)
+    {
+        string n = ToLower(name);
+        if (n == "cpu_mt")
+            return CPU_MT;
+        if (n == "cpu_mkl")
+            return CPU_MKL;
+        if (n == "gpu")
+            return GPU;
+        NEURO_ASSERT(n == "cpu", "Unknown op mode '" << name << "'.");
+        return CPU;
+    }
+
+    // Limits both OpenMP and PPL (used by multi-threaded CPU ops) worker threads, 0 restores defaults
+    void SetThreadsNum(int threadsNum)
+    {
+        if (m_SchedulerAttached)
+        {
+            Concurrency::CurrentScheduler::Detach();
+            m_SchedulerAttached = false;
+        }
+
+        omp_set_num_threads(threadsNum > 0 ? threadsNum : omp_get_num_procs());
+
+        if (threadsNum > 0)
+        {
+            Concurrency::CurrentScheduler::Create(Concurrency::SchedulerPolicy(2, Concurrency::MinConcurrency, threadsNum, Concurrency::MaxConcurrency, threadsNum));
+            m_SchedulerAttached = true;
+        }
+    }
+
+    ModelBase* CreateModel(const string& name, bool& trainable)
+    {
+        trainable = true;
+
+        if (name == "conv")
+        {
+            // same architecture as ConvNetwork example
+            auto model = new Sequential("conv");
+            model->AddLayer(new Conv2D(Shape(64, 64, 4), 32, 8, 2, 0, new ELU(1)));
+            model->AddLayer(new Conv2D(64, 4, 2, 0, new ELU(1)));
+            model->AddLayer(new Conv2D(128, 4, 2, 0, new ELU(1)));
+            model->AddLayer(new Flatten());
+            model->AddLayer(new Dense(512, new ELU(1)));
+            model->AddLayer(new Dense(3, new Softmax()));
+            return model;
+        }
+
+        if (name == "mnist_conv")
+        {
+            // same architecture as MnistConvNetwork example
+            auto model = new Sequential("mnist_conv");
+            model->AddLayer(new Conv2D(Shape(28, 28, 1), 32, 3, 1, 0, new ReLU()));
+            model->AddLayer(new MaxPooling2D(2, 2));
+            model->AddLayer(new Conv2D(16, 3, 1, 0, new ReLU()));
+            model->AddLayer(new MaxPooling2D(2, 2));
+            model->AddLayer(new Dropout(0.2f));
+            model->AddLayer(new Flatten());
+            model->AddLayer(new Dense(128, new ReLU()));
+            model->AddLayer(new Dense(10, new Softmax()));
+            return model;
+        }
+
+        if (name == "resnet20")
+            return CreateResNet20();
+
+        if (name == "fnst")
+            return FastNeuralStyleTransfer().CreateGeneratorModel(256, 256);
+
+        if (name == "pix2pix")
+            return Pix2Pix().CreateGenerator(Shape(256, 256, 3));
+
+        if (name == "vgg19")
+        {
+            if (!ifstream(m_DataDir + "vgg19_weights_tf_dim_ordering_tf_kernels_notop.h5"))
+            {
+                cout << "Skipping, VGG19 weights not found in '" << m_DataDir << "'." << endl;
+                return nullptr;
+            }
+            trainable = false;
+            return VGG19::CreateModel(NCHW, Shape(224, 224, 3), false, MaxPool, m_DataDir);
+        }
+
+        cout << "Unknown model '" << name << "'." << endl;
+        return nullptr;
+    }
+
+    // CIFAR-10 ResNet with 3 stages of 3 basic blocks each (He et al. 2015)
+    static ModelBase* CreateResNet20()
+    {
+        NameScope scope("resnet20");
+
+        auto convBnRelu = [](TensorLike* x, uint32_t filters, uint32_t stride, bool doReLU)
+        {
+            x = (new Conv2D(filters, 3, stride, Tensor::GetPadding(Same, 3)))->Call(x)[0];
+            x = (new BatchNormalization())->Call(x)[0];
+            if (doReLU)
+                x = (new Activation(new ReLU()))->Call(x)[0];
+            return x;
+        };
+
+        auto input = new Input(Shape(32, 32, 3));
+        auto x = convBnRelu(input->Outputs()[0], 16, 1, true);
+
+        uint32_t filters = 16;
+        for (int stage = 0; stage < 3; ++stage)
+        {
+            for (int block = 0; block < 3; ++block)
+            {
+                uint32_t stride = (stage > 0 && block == 0) ? 2 : 1;
+                auto y = convBnRelu(x, filters, stride, true);
+                y = convBnRelu(y, filters, 1, false);
+                if (stride > 1)
+                    x = (new Conv2D(filters, 1, stride, 0))->Call(x)[0]; // projection shortcut
+                x = (new Merge(SumMerge, new ReLU()))->Call({ x, y })[0];
+            }
+            filters *= 2;
+        }
+
+        x = (new AvgPooling2D(8, 8))->Call(x)[0];
+        x = (new Flatten())->Call(x)[0];
+        x = (new Dense(10, new Softmax()))->Call(x)[0];
+
+        return new Flow(input->Outputs(), { x }, "resnet20");
+    }
+
+    void Benchmark(const string& modelName, const string& modeName, int threadsNum, vector<Result>& results)
+    {
+        bool trainable;
+        auto model = CreateModel(modelName, trainable);
+        if (!model)
+            return;
+
+        Tensor input(Shape::From(model->InputShapesAt(-1)[0], m_BatchSize));
+        input.FillWithRand(-1, -1.f, 1.f);
+
+        auto measure = [&](const string& phase, const function<void()>& step)
+        {
+            for (uint32_t i = 0; i < m_Warmup; ++i)
+                step();
+
+            HostMemoryManager::Default().ResetPeak();
+            DeviceMemoryManager::Default().ResetPeak();
+
+            vector<double> timesMs;
+            for (uint32_t i = 0; i < max(m_Steps, 1u); ++i)
+            {
+                Stopwatch timer;
+                timer.Start();
+                step();
+                timer.Stop();
+                timesMs.push_back(timer.ElapsedMicroseconds() * 0.001);
+            }
+
+            results.push_back(MakeResult(modelName, modeName, threadsNum, phase, timesMs));
+            Print(results.back());
+        };
+
+        measure("predict", [&]() { model->Predict(input); });
+
+        if (trainable)
+        {
+            // output shape is only known after graph has been evaluated once
+            Tensor target(model->Predict(input)[0]->GetShape());
+            target.FillWithRand(-1, 0.f, 1.f);
+
+            model->Optimize(new Adam(), new MeanSquareError());
+
+            measure("train_on_batch", [&]() { model->TrainOnBatch(input, target); });
+
+            // full Fit epoch over a few batches includes per-epoch overhead (shuffling, batch extraction, metrics)
+            const uint32_t FIT_BATCHES = 4;
+            Tensor fitInput(Shape::From(input.GetShape(), m_BatchSize * FIT_BATCHES));
+            fitInput.FillWithRand(-1, -1.f, 1.f);
+            Tensor fitTarget(Shape::From(target.GetShape(), m_BatchSize * FIT_BATCHES));
+            fitTarget.FillWithRand(-1, 0.f, 1.f);
+
+            HostMemoryManager::Default().ResetPeak();
+            DeviceMemoryManager::Default().ResetPeak();
+
+            Stopwatch timer;
+            timer.Start();
+            model->Fit(fitInput, fitTarget, (int)m_BatchSize, 1, nullptr, nullptr, 0, false);
+            timer.Stop();
+
+            auto r = MakeResult(modelName, modeName, threadsNum, "fit", { timer.ElapsedMicroseconds() * 0.001 / FIT_BATCHES });
+            r.steps = FIT_BATCHES;
+            results.push_back(r);
+            Print(r);
+        }
+
+        delete model;
+        Session::Default()->Clear();
+    }
+
+    Result MakeResult(const string& modelName, const string& modeName, int threadsNum, const string& phase, vector<double> timesMs) const
+    {
+        sort(timesMs.begin(), timesMs.end());
+        auto percentile = [&](double p) { return timesMs[min(timesMs.size() - 1, (size_t)(p * (timesMs.size() - 1) + 0.5))]; };
+
+        Result r;
+        r.model = modelName;
+        r.mode = modeName;
+        r.threads = threadsNum;
+        r.batchSize = m_BatchSize;
+        r.phase = phase;
+        r.steps = (uint32_t)timesMs.size();
+        r.meanMs = accumulate(timesMs.begin(), timesMs.end(), 0.0) / timesMs.size();
+        r.p50Ms = percentile(0.5);
+        r.p90Ms = percentile(0.9);
+        r.p99Ms = percentile(0.99);
+        r.imagesPerSec = m_BatchSize * 1000.0 / max(r.meanMs, 1e-3);
+        r.hostPeakBytes = HostMemoryManager::Default().AllocatedMemPeakSize();
+        r.devicePeakBytes = DeviceMemoryManager::Default().AllocatedMemPeakSize();
+        return r;
+    }
+
+    static void Print(const Result& r)
+    {
+        cout << "  " << PadRight(r.phase, 16) << fixed << setprecision(2)
+             << "mean " << setw(9) << r.meanMs << "ms  p50 " << setw(9) << r.p50Ms << "ms  p90 " << setw(9) << r.p90Ms << "ms  p99 " << setw(9) << r.p99Ms << "ms"
+             << setprecision(1) << setw(10) << r.imagesPerSec << " img/s  host peak " << (r.hostPeakBytes >> 20) << "MB  device peak " << (r.devicePeakBytes >> 20) << "MB" << endl;
+    }
+
+    void SaveReport(const vector<Result>& results, const string& filename) const
+    {
+        ofstream stream(filename);
+        stream << "# Model benchmark" << endl << endl;
+        stream << "Synthetic data, batch size " << m_BatchSize << ", " << m_Warmup << " warmup steps, " << m_Steps << " measured steps." << endl << endl;
+        stream << "| model | mode | threads | phase | steps | mean [ms] | p50 [ms] | p90 [ms] | p99 [ms] | images/s | host peak [MB] | device peak [MB] |" << endl;
+        stream << "|---|---|---|---|---|---|---|---|---|---|---|---|" << endl;
+        stream << fixed;
+        for (auto& r : results)
+        {
+            stream << "| " << r.model << " | " << r.mode << " | " << (r.threads > 0 ? to_string(r.threads) : "default") << " | " << r.phase << " | " << r.steps
+                   << setprecision(2) << " | " << r.meanMs << " | " << r.p50Ms << " | " << r.p90Ms << " | " << r.p99Ms
+                   << setprecision(1) << " | " << r.imagesPerSec << " | " << r.hostPeakBytes / (1024.0 * 1024.0) << " | " << r.devicePeakBytes / (1024.0 * 1024.0) << " |" << endl;
+        }
+    }
+
+    uint32_t m_BatchSize;
+    uint32_t m_Warmup;
+    uint32_t m_Steps;
+    string m_DataDir;
+    bool m_SchedulerAttached = false;
+};
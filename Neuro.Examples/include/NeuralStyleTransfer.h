@@ -12,7 +12,7 @@
 using namespace std;
 using namespace Neuro;
 
-TensorLike* GramMatrix(TensorLike* reshapedFeatures, uint32_t area, uint32_t depth, bool normalize, const string& name);
+TensorLike* GramMatrix(TensorLike* features, uint32_t area, uint32_t depth, bool normalize, const string& name);
 TensorLike* StyleLoss(TensorLike* styleFeatures, TensorLike* stylizedFeatures, int index, int mode = 1);
 TensorLike* StyleLossFromGram(TensorLike* styleGram, TensorLike* stylizedGram, uint32_t area, uint32_t depth, int index, int mode = 1);
 TensorLike* ContentLoss(TensorLike* contentFeatures, TensorLike* stylizedFeatures, int mode = 2);
@@ -52,36 +52,31 @@ public:
 
         assert(contentImage.GetShape() == styleImage.GetShape());
         
-        auto vggModel = VGG19::CreateModel(NCHW, contentImage.GetShape(), false, AvgPool, "data/");
-        vggModel->SetTrainable(false);
-
-        vector<TensorLike*> contentLayers = { vggModel->Layer("block4_conv2")->Outputs()[0] };
-        vector<TensorLike*> styleLayers = { vggModel->Layer("block1_conv1")->Outputs()[0], 
-                                            vggModel->Layer("block2_conv1")->Outputs()[0], 
-                                            vggModel->Layer("block3_conv1")->Outputs()[0], 
-                                            vggModel->Layer("block4_conv1")->Outputs()[0],
-                                            vggModel->Layer("block5_conv1")->Outputs()[0] };
+        vector<string> contentLayers = { "block4_conv2" };
+        vector<string> styleLayers = { "block1_conv1", "block2_conv1", "block3_conv1", "block4_conv1", "block5_conv1" };
         vector<float> styleLayersWeights = { 0.2f, 0.2f, 0.2f, 0.2f, 0.2f };
 
         NEURO_ASSERT(styleLayersWeights.size() == styleLayers.size(), "");
 
-        auto genImg = new Variable(contentImage, "output_image");
+        // only layers up to block5_conv1 will be created and loaded
+        auto model = VGG19::CreateFeatureExtractor(MergeVectors({ contentLayers, styleLayers }), NCHW, contentImage.GetShape(), AvgPool, "data/");
+        model->SetTrainable(false);
 
-        auto model = Flow(vggModel->InputsAt(-1), MergeVectors({ contentLayers, styleLayers }));
+        auto genImg = new Variable(contentImage, "output_image");
 
         // pre-compute content features of content image (we only need to do it once since that image won't change)
-        auto contentFeatures = model.Predict(contentImage)[0];
+        auto contentFeatures = model->Predict(contentImage)[0];
         Constant* content = new Constant(*contentFeatures, "content");
 
         // pre-compute style features of style image (we only need to do it once since that image won't change either)
-        auto styleFeatures = model.Predict(styleImage);
+        auto styleFeatures = model->Predict(styleImage);
         styleFeatures.erase(styleFeatures.begin()); //get rid of content feature
         vector<Constant*> styles;
         for (size_t i = 0; i < styleFeatures.size(); ++i)
             styles.push_back(new Constant(*styleFeatures[i], "style_" + to_string(i)));
 
         // generate beginning of the computational graph for processing output image
-        auto outputs = model(genImg);
+        auto outputs = (*model)(genImg);
 
         // compute content loss from first output...
         auto contentLoss = multiply(ContentLoss(content, outputs[0], 1), CONTENT_WEIGHT);
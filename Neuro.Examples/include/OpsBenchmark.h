@@ -0,0 +1,333 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include "Args.h"
+#include "Neuro.h"
+
+using namespace std;
+using namespace Neuro;
+
+// Measures throughput of CPU tensor kernels on shapes taken from VGG16, FastNeuralStyleTransfer generator and MnistConvNetwork.
+// Usage: --modes cpu,cpu_mt,cpu_mkl --iterations 10 --warmup 2 --budget 5000 --filter conv --out ops_benchmark.json
+class OpsBenchmark
+{
+public:
+    struct Case
+    {
+        string op;
+        string config; // source network and layer
+        Shape shape; // input shape
+        double flops; // floating point operations per single run
+        double bytes; // bytes read and written per single run (assuming every tensor is touched once)
+        function<void()> run;
+    };
+
+    struct Result
+    {
+        string op;
+        string config;
+        string mode;
+        Shape shape;
+        uint32_t iterations;
+        double meanUs;
+        double stdDevUs;
+        double minUs;
+        double gflops;
+        double gbps;
+        double nsPerElem;
+    };
+
+    void Run(const Args& args)
+    {
+        vector<string> modes = args.HasArg("modes") ? args.GetArgArray("modes") : vector<string>{ "cpu", "cpu_mt", "cpu_mkl" };
+        uint32_t iterations = args.HasArg("iterations") ? args.GetArgInt("iterations") : 10;
+        uint32_t warmup = args.HasArg("warmup") ? args.GetArgInt("warmup") : 2;
+        // upper limit of time spent measuring single case, at least one iteration is always measured
+        __int64 budgetMs = args.HasArg("budget") ? args.GetArgInt("budget") : 5000;
+        string filter = args.HasArg("filter") ? ToLower(args.GetArg("filter")) : "";
+        string outFile = args.HasArg("out") ? args.GetArg("out") : "ops_benchmark.json";
+
+        GlobalRngSeed(1337);
+
+        vector<Result> results;
+
+        for (auto& modeName : modes)
+        {
+            EOpMode mode = ParseMode(modeName);
+            Tensor::SetForcedOpMode(mode);
+
+            vector<Case> cases;
+            CreateCases(cases);
+
+            for (auto& c : cases)
+            {
+                if (!filter.empty() && ToLower(c.op + " " + c.config).find(filter) == string::npos)
+                    continue;
+
+                for (uint32_t i = 0; i < warmup; ++i)
+                    c.run();
+
+                vector<double> timesUs;
+                Stopwatch total;
+                total.Start();
+                while (timesUs.size() < max(iterations, 1u) && (timesUs.empty() || total.ElapsedMilliseconds() < budgetMs))
+                {
+                    Stopwatch timer;
+                    timer.Start();
+                    c.run();
+                    timer.Stop();
+                    timesUs.push_back((double)timer.ElapsedMicroseconds());
+                }
+
+                Result r;
+                r.op = c.op;
+                r.config = c.config;
+                r.mode = modeName;
+                r.shape = c.shape;
+                r.iterations = (uint32_t)timesUs.size();
+                r.meanUs = accumulate(timesUs.begin(), timesUs.end(), 0.0) / timesUs.size();
+                double var = 0;
+                for (auto t : timesUs)
+                    var += (t - r.meanUs) * (t - r.meanUs);
+                r.stdDevUs = ::sqrt(var / timesUs.size());
+                r.minUs = *min_element(timesUs.begin(), timesUs.end());
+                double meanSec = max(r.meanUs, 1.0) * 1e-6;
+                r.gflops = c.flops / meanSec * 1e-9;
+                r.gbps = c.bytes / meanSec * 1e-9;
+                r.nsPerElem = r.meanUs * 1e3 / c.shape.Length;
+                results.push_back(r);
+
+                cout << PadRight(modeName, 8) << PadRight(c.op, 24) << PadRight(c.config, 28) << PadRight(c.shape.ToString(), 22)
+                     << fixed << setprecision(1) << setw(12) << r.meanUs << "us +/-" << setw(8) << r.stdDevUs
+                     << setprecision(2) << setw(10) << r.gflops << " GFLOP/s" << setw(8) << r.gbps << " GB/s"
+                     << setprecision(3) << setw(9) << r.nsPerElem << " ns/elem" << endl;
+            }
+        }
+
+        Tensor::ClearForcedOpMode();
+        SaveJson(results, outFile);
+        cout << "Results saved to '" << outFile << "'" << endl;
+    }
+
+private:
+    static EOpMode ParseMode(const string& name)
+    {
+        string n = ToLower(name);
+        if (n == "cpu_mt")
+            return CPU_MT;
+        if (n == "cpu_mkl")
+            return CPU_MKL;
+        if (n == "gpu")
+            return GPU;
+        NEURO_ASSERT(n == "cpu", "Unknown op mode '" << name << "'.");
+        return CPU;
+    }
+
+    // Tensors are kept alive in shared pointers captured by run functions so each case owns its buffers
+    typedef shared_ptr<Tensor> tensor_ptr;
+
+    static tensor_ptr Rand(const Shape& shape)
+    {
+        auto t = make_shared<Tensor>(shape);
+        t->FillWithRand();
+        return t;
+    }
+
+    static tensor_ptr Empty(const Shape& shape)
+    {
+        return make_shared<Tensor>(shape);
+    }
+
+    static void AddConv(vector<Case>& cases, const string& config, const Shape& inputShape, uint32_t kernelsNum, uint32_t kernelSize, uint32_t stride, uint32_t padding)
+    {
+        auto input = Rand(inputShape);
+        auto kernels = Rand(Shape(kernelSize, kernelSize, inputShape.Depth(), kernelsNum));
+        Shape outShape = Tensor::GetConvOutputShape(inputShape, kernelsNum, kernelSize, kernelSize, stride, padding, padding, NCHW);
+        auto output = Empty(outShape);
+        auto outputGrad = Rand(outShape);
+        auto inputGrad = Empty(inputShape);
+        auto kernelsGrad = Empty(kernels->GetShape());
+
+        double flops = 2.0 * outShape.Length * inputShape.Depth() * kernelSize * kernelSize;
+        double inputBytes = 4.0 * inputShape.Length, kernelsBytes = 4.0 * kernels->Length(), outputBytes = 4.0 * outShape.Length;
+
+        cases.push_back({ "Conv2D", config, inputShape, flops, inputBytes + kernelsBytes + outputBytes, [=]() { input->Conv2D(*kernels, stride, padding, NCHW, *output); } });
+        // each gradient is a convolution of the same size, they read output gradient and write gradient of one input
+        cases.push_back({ "Conv2DInputGradient", config, inputShape, flops, outputBytes + kernelsBytes + inputBytes, [=]() { outputGrad->Conv2DInputsGradient(*outputGrad, *kernels, stride, padding, NCHW, *inputGrad); } });
+        cases.push_back({ "Conv2DKernelsGradient", config, inputShape, flops, outputBytes + inputBytes + kernelsBytes, [=]() { outputGrad->Conv2DKernelsGradient(*input, *outputGrad, stride, padding, NCHW, *kernelsGrad); } });
+        // full backward pass reads input, kernels and output gradient once and writes both gradients
+        cases.push_back({ "Conv2DGradient", config, inputShape, 2 * flops, outputBytes + 2 * (inputBytes + kernelsBytes), [=]()
+        {
+            outputGrad->Conv2DInputsGradient(*outputGrad, *kernels, stride, padding, NCHW, *inputGrad);
+            outputGrad->Conv2DKernelsGradient(*input, *outputGrad, stride, padding, NCHW, *kernelsGrad);
+        } });
+    }
+
+    static void AddPool(vector<Case>& cases, const string& config, const Shape& inputShape, uint32_t filterSize, uint32_t stride, EPoolingMode type)
+    {
+        auto input = Rand(inputShape);
+        Shape outShape = Tensor::GetPooling2DOutputShape(inputShape, filterSize, filterSize, stride, 0, 0, NCHW);
+        auto output = Empty(outShape);
+        auto outputGrad = Rand(outShape);
+        auto inputGrad = Empty(inputShape);
+        input->Pool2D(filterSize, stride, type, 0, NCHW, *output);
+
+        double flops = (double)outShape.Length * filterSize * filterSize;
+        double bytes = 4.0 * (inputShape.Length + outShape.Length);
+        string name = type == MaxPool ? "MaxPool2D" : "AvgPool2D";
+
+        cases.push_back({ name, config, inputShape, flops, bytes, [=]() { input->Pool2D(filterSize, stride, type, 0, NCHW, *output); } });
+        cases.push_back({ name + "Gradient", config, inputShape, flops, 4.0 * (2 * inputShape.Length + 2 * outShape.Length),
+            [=]() { output->Pool2DGradient(*output, *input, *outputGrad, filterSize, stride, type, 0, NCHW, *inputGrad); } });
+    }
+
+    static void AddNorm(vector<Case>& cases, const string& config, const Shape& inputShape, bool instance)
+    {
+        auto input = Rand(inputShape);
+        // instance normalization has separate parameters for each sample
+        Shape paramsShape = Shape(1, 1, inputShape.Depth(), instance ? inputShape.Batch() : 1);
+        auto gamma = Rand(paramsShape);
+        auto beta = Rand(paramsShape);
+        auto runningMean = Rand(paramsShape);
+        auto runningVar = make_shared<Tensor>(paramsShape);
+        runningVar->FillWithValue(1.f);
+        auto saveMean = Empty(paramsShape);
+        auto saveInvVar = Empty(paramsShape);
+        auto output = Empty(inputShape);
+        auto outputGrad = Rand(inputShape);
+        auto inputGrad = Empty(inputShape);
+        auto gammaGrad = Empty(paramsShape);
+        auto betaGrad = Empty(paramsShape);
+
+        double n = inputShape.Length;
+        string name = instance ? "InstanceNorm" : "BatchNorm";
+
+        if (instance)
+        {
+            cases.push_back({ name + "Train", config, inputShape, 7 * n, 4.0 * 3 * n, [=]() { input->InstanceNormTrain(*gamma, *beta, 0.001f, *saveMean, *saveInvVar, *output); } });
+            cases.push_back({ name + "Gradient", config, inputShape, 12 * n, 4.0 * 3 * n, [=]() { outputGrad->InstanceNormGradient(*input, *gamma, 0.001f, *outputGrad, *saveMean, *saveInvVar, *gammaGrad, *betaGrad, true, *inputGrad); } });
+        }
+        else
+        {
+            cases.push_back({ name, config, inputShape, 4 * n, 4.0 * 2 * n, [=]() { input->BatchNorm(*gamma, *beta, 0.001f, runningMean.get(), runningVar.get(), *output); } });
+            cases.push_back({ name + "Train", config, inputShape, 7 * n, 4.0 * 3 * n, [=]() { input->BatchNormTrain(*gamma, *beta, 0.9f, 0.001f, runningMean.get(), runningVar.get(), *saveMean, *saveInvVar, *output); } });
+            cases.push_back({ name + "Gradient", config, inputShape, 12 * n, 4.0 * 3 * n, [=]() { outputGrad->BatchNormGradient(*input, *gamma, 0.001f, *outputGrad, *saveMean, *saveInvVar, *gammaGrad, *betaGrad, true, *inputGrad); } });
+        }
+    }
+
+    static void AddElementwise(vector<Case>& cases, const string& config, const Shape& inputShape)
+    {
+        auto input = Rand(inputShape);
+        auto other = Rand(inputShape);
+        auto output = Empty(inputShape);
+        auto outputGrad = Rand(inputShape);
+        auto inputGrad = Empty(inputShape);
+        auto mask = Empty(inputShape);
+        auto upSampled = Empty(Shape(inputShape.Width() * 2, inputShape.Height() * 2, inputShape.Depth(), inputShape.Batch()));
+
+        double n = inputShape.Length;
+
+        cases.push_back({ "Add", config, inputShape, n, 4.0 * 3 * n, [=]() { input->Add(*other, *output); } });
+        cases.push_back({ "MulElem", config, inputShape, n, 4.0 * 3 * n, [=]() { input->MulElem(*other, *output); } });
+        cases.push_back({ "ReLU", config, inputShape, n, 4.0 * 2 * n, [=]() { input->ReLU(*output); } });
+        cases.push_back({ "ReLUGradient", config, inputShape, n, 4.0 * 3 * n, [=]() { output->ReLUGradient(*output, *outputGrad, *inputGrad); } });
+        cases.push_back({ "Sigmoid", config, inputShape, 4 * n, 4.0 * 2 * n, [=]() { input->Sigmoid(*output); } });
+        cases.push_back({ "Tanh", config, inputShape, 4 * n, 4.0 * 2 * n, [=]() { input->Tanh(*output); } });
+        cases.push_back({ "Elu", config, inputShape, 3 * n, 4.0 * 2 * n, [=]() { input->Elu(1.f, *output); } });
+        cases.push_back({ "Dropout", config, inputShape, 2 * n, 4.0 * 3 * n, [=]() { input->Dropout(0.8f, *mask, *output); } });
+        cases.push_back({ "UpSample2D", config, inputShape, 0, 4.0 * 5 * n, [=]() { input->UpSample2D(2, *upSampled); } });
+    }
+
+    static void AddMatMul(vector<Case>& cases, const string& config, uint32_t m, uint32_t k, uint32_t n)
+    {
+        // neuro tensors are row major with width being number of columns
+        auto a = Rand(Shape(k, m));
+        auto b = Rand(Shape(n, k));
+        auto output = Empty(Shape(n, m));
+        auto outputGrad = Rand(Shape(n, m));
+        auto aGrad = Empty(a->GetShape());
+        auto bGrad = Empty(b->GetShape());
+
+        double flops = 2.0 * m * n * k;
+        double aBytes = 4.0 * m * k, bBytes = 4.0 * k * n, outputBytes = 4.0 * m * n;
+
+        cases.push_back({ "MatMul", config, a->GetShape(), flops, aBytes + bBytes + outputBytes, [=]() { a->MatMul(*b, *output); } });
+        // gradient of A is output gradient times transposed B, gradient of B is transposed A times output gradient
+        cases.push_back({ "MatMulGradient", config, a->GetShape(), 2 * flops, outputBytes + 2 * (aBytes + bBytes), [=]()
+        {
+            outputGrad->MatMul(false, *b, true, *aGrad);
+            a->MatMul(true, *outputGrad, false, *bGrad);
+        } });
+    }
+
+    static void AddSoftmax(vector<Case>& cases, const string& config, const Shape& inputShape)
+    {
+        auto input = Rand(inputShape);
+        auto output = Empty(inputShape);
+        auto outputGrad = Rand(inputShape);
+        auto inputGrad = Empty(inputShape);
+        input->Softmax(*output);
+
+        double n = inputShape.Length;
+        cases.push_back({ "Softmax", config, inputShape, 5 * n, 4.0 * 2 * n, [=]() { input->Softmax(*output); } });
+        cases.push_back({ "SoftmaxGradient", config, inputShape, 4 * n, 4.0 * 3 * n, [=]() { output->SoftmaxGradient(*output, *outputGrad, *inputGrad); } });
+    }
+
+    static void CreateCases(vector<Case>& cases)
+    {
+        // VGG16 (224x224 input)
+        AddConv(cases, "vgg16/block1_conv2", Shape(224, 224, 64, 1), 64, 3, 1, 1);
+        AddConv(cases, "vgg16/block3_conv2", Shape(56, 56, 256, 1), 256, 3, 1, 1);
+        AddConv(cases, "vgg16/block5_conv2", Shape(14, 14, 512, 1), 512, 3, 1, 1);
+        AddPool(cases, "vgg16/block1_pool", Shape(224, 224, 64, 1), 2, 2, MaxPool);
+        AddPool(cases, "vgg16/block4_pool", Shape(28, 28, 512, 1), 2, 2, MaxPool);
+        AddElementwise(cases, "vgg16/block2_conv1", Shape(112, 112, 128, 1));
+        AddMatMul(cases, "vgg16/fc1", 1, 7 * 7 * 512, 4096);
+        AddMatMul(cases, "vgg16/fc2_batch16", 16, 4096, 4096);
+        AddSoftmax(cases, "vgg16/predictions", Shape(1000, 1, 1, 16));
+
+        // FastNeuralStyleTransfer generator (256x256 input, batch 4)
+        AddConv(cases, "fnst/conv_1", Shape(256, 256, 3, 4), 32, 9, 1, 4);
+        AddConv(cases, "fnst/conv_3", Shape(128, 128, 64, 4), 128, 3, 2, 1);
+        AddConv(cases, "fnst/resi_conv", Shape(64, 64, 128, 4), 128, 3, 1, 1);
+        AddNorm(cases, "fnst/normal_1", Shape(256, 256, 32, 4), true);
+        AddNorm(cases, "fnst/resi_normal", Shape(64, 64, 128, 4), true);
+        AddElementwise(cases, "fnst/up_1", Shape(64, 64, 128, 4));
+
+        // MnistConvNetwork (batch 256)
+        AddConv(cases, "mnist/conv_1", Shape(28, 28, 1, 256), 32, 3, 1, 0);
+        AddConv(cases, "mnist/conv_2", Shape(13, 13, 32, 256), 16, 3, 1, 0);
+        AddPool(cases, "mnist/pool_1", Shape(26, 26, 32, 256), 2, 2, MaxPool);
+        AddNorm(cases, "mnist/batch_norm", Shape(26, 26, 32, 256), false);
+        AddMatMul(cases, "mnist/dense_1", 256, 5 * 5 * 16, 128);
+        AddSoftmax(cases, "mnist/dense_2", Shape(10, 1, 1, 256));
+    }
+
+    static void SaveJson(const vector<Result>& results, const string& file)
+    {
+        ofstream stream(file);
+        stream << "[\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            auto& r = results[i];
+            stream << "  { \"op\": \"" << r.op << "\", \"config\": \"" << r.config << "\", \"mode\": \"" << r.mode << "\""
+                   << ", \"shape\": [" << r.shape.Width() << ", " << r.shape.Height() << ", " << r.shape.Depth() << ", " << r.shape.Batch() << "]"
+                   << ", \"iterations\": " << r.iterations
+                   << setprecision(6) << ", \"mean_us\": " << r.meanUs << ", \"stddev_us\": " << r.stdDevUs << ", \"min_us\": " << r.minUs
+                   << ", \"gflops\": " << r.gflops << ", \"gbps\": " << r.gbps << ", \"ns_per_elem\": " << r.nsPerElem << " }"
+                   << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        stream << "]\n";
+        stream.close();
+    }
+};
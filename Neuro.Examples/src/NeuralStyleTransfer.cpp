@@ -6,15 +6,8 @@ TensorLike* GramMatrix(TensorLike* features, uint32_t area, uint32_t depth, bool
     NameScope scope(name + "_gram");
     assert(features->GetShape().Batch() == 1);
 
-    auto reshapedFeatures = reshape(features, Shape(area, depth));
-    auto gram = matmul(reshapedFeatures, false, name);
-
-    if (normalize)
-        gram = div(gram, (float)reshapedFeatures->GetShape().Length, name + "_norm");
-
-    return gram;
-    //return div(matmul(features, transpose(features)), (float)featureMapSize, "result");
-    //return matmul(reshapedFeatures, transpose(reshapedFeatures));
+    // normalization is fused into gram matrix computation
+    return gram_matrix(features, normalize ? 1.f / ((float)area * depth) : 1.f, name);
 }
 
 //////////////////////////////////////////////////////////////////////////
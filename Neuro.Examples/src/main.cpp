@@ -14,6 +14,9 @@
 #include "AdaptiveStyleTransfer.h"
 #include "Pix2Pix.h"
 #include "NeuralStyleTransferHD2.h"
+#include "OpsBenchmark.h"
+#include "ModelBenchmark.h"
+#include "BatchingServerBenchmark.h"
 
 int main(int argc, char *argv[])
 {
@@ -50,6 +53,9 @@ int main(int argc, char *argv[])
     //AdaptiveStyleTransfer().Test();
     //Pix2Pix().Run();
     //Pix2Pix().RunDiscriminatorTrainTest();
+    //OpsBenchmark().Run(args);
+    //ModelBenchmark().Run(args);
+    //BatchingServerBenchmark().Run(args);
 
     return 0;
 }
\ No newline at end of file
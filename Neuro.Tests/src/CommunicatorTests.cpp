@@ -0,0 +1,107 @@
+#include <numeric>
+#include <thread>
+#include "CppUnitTest.h"
+#include "Neuro.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace Neuro;
+
+namespace NeuroTests
+{
+    TEST_CLASS(CommunicatorTests)
+    {
+        TEST_METHOD(TcpRing_AllReduceSum)
+        {
+            const uint32_t WORLD_SIZE = 3;
+            const size_t COUNT = 1001; // not divisible by world size
+
+            // each thread acts as a separate process connected over loopback
+            RunRing(WORLD_SIZE, 29600, [&](Communicator& comm)
+            {
+                vector<float> data(COUNT);
+                for (size_t i = 0; i < COUNT; ++i)
+                    data[i] = (float)(i + comm.Rank() * 10);
+
+                comm.AllReduceSum(data.data(), data.size());
+
+                for (size_t i = 0; i < COUNT; ++i)
+                    Assert::AreEqual((float)(i * WORLD_SIZE + 30), data[i]);
+            });
+        }
+
+        TEST_METHOD(TcpRing_Broadcast)
+        {
+            RunRing(4, 29610, [&](Communicator& comm)
+            {
+                vector<float> data(100, (float)comm.Rank());
+                comm.Broadcast(data.data(), data.size(), 2);
+
+                for (auto v : data)
+                    Assert::AreEqual(2.f, v);
+            });
+        }
+
+        TEST_METHOD(GradientsAllReducer_MatchesSingleProcess)
+        {
+            const uint32_t WORLD_SIZE = 3;
+            const uint32_t SAMPLES = 7; // shards of 2, 2 and 3 samples
+
+            auto x = new Placeholder(Shape(5));
+            auto y = new Placeholder(Shape(2));
+            auto w = new Variable(Tensor(Shape(2, 5)).FillWithRand());
+            auto grads = gradients(mean(square(sub(matmul(x, w), y))), w);
+
+            Tensor input(Shape(5, 1, 1, SAMPLES)); input.FillWithRand();
+            Tensor target(Shape(2, 1, 1, SAMPLES)); target.FillWithRand();
+            Tensor expected = *Session::Default()->Run(grads, { { x, &input }, { y, &target } })[0];
+
+            // every rank computes gradient of mean loss over its own shard
+            vector<Variable*> rankVars;
+            vector<float> rankWeights;
+            for (uint32_t r = 0; r < WORLD_SIZE; ++r)
+            {
+                vector<uint32_t> ids((r + 1) * SAMPLES / WORLD_SIZE - r * SAMPLES / WORLD_SIZE);
+                iota(ids.begin(), ids.end(), r * SAMPLES / WORLD_SIZE);
+                Tensor shardInput = input.GetBatches(ids);
+                Tensor shardTarget = target.GetBatches(ids);
+
+                auto grad = Session::Default()->Run(grads, { { x, &shardInput }, { y, &shardTarget } })[0];
+                rankVars.push_back(new Variable(zeros(w->GetShape())));
+                rankVars.back()->OutputGrad().Resize(grad->GetShape());
+                grad->CopyTo(rankVars.back()->OutputGrad());
+                rankWeights.push_back(ids.size() / (float)SAMPLES);
+            }
+
+            RunRing(WORLD_SIZE, 29620, [&](Communicator& comm)
+            {
+                GradientsAllReducer reducer(&comm);
+                reducer.LocalWeight(rankWeights[comm.Rank()]);
+                reducer.GradientReady(rankVars[comm.Rank()]);
+                reducer.Finish();
+
+                Assert::IsTrue(rankVars[comm.Rank()]->OutputGrad().Equals(expected, 0.0001f));
+            });
+        }
+
+        void RunRing(uint32_t worldSize, int basePort, const function<void(Communicator&)>& body)
+        {
+            vector<string> addresses;
+            for (uint32_t r = 0; r < worldSize; ++r)
+                addresses.push_back("127.0.0.1:" + to_string(basePort + r));
+
+            vector<thread> processes;
+            for (uint32_t r = 0; r < worldSize; ++r)
+            {
+                processes.push_back(thread([&, r]()
+                {
+                    TcpRingCommunicator comm(r, addresses);
+                    body(comm);
+                    comm.Barrier();
+                }));
+            }
+
+            for (auto& p : processes)
+                p.join();
+        }
+    };
+}
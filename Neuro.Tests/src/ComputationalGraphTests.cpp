@@ -97,5 +97,170 @@ namespace NeuroTests
 
             //Assert::AreEqual(5.0, (double)(*result[0])(0));
         }
+
+        TEST_METHOD(Memoization)
+        {
+            auto x = new Placeholder(Shape(8, 4));
+            auto w = new Constant(Tensor(Shape(3, 8)).FillWithRand(), "w");
+            auto y = matmul(x, w);
+            auto z = add(y, new Constant(1.f));
+
+            Tensor input(Shape(8, 4)); input.FillWithRand();
+            Session::Default()->Run({ z }, { { x, &input } });
+            Session::Default()->Run({ z }, { { x, &input } });
+            Assert::IsFalse(static_cast<Operation*>(y)->WasMemoized()); // output is kept after its inputs were observed unchanged
+            auto result = Session::Default()->Run({ z }, { { x, &input } });
+            Assert::IsTrue(static_cast<Operation*>(y)->WasMemoized());
+            Assert::IsTrue(result[0]->Equals(input.MatMul(w->Output()).Add(1.f)));
+
+            input.FillWithRand();
+            result = Session::Default()->Run({ z }, { { x, &input } });
+            Assert::IsFalse(static_cast<Operation*>(y)->WasMemoized());
+            Assert::IsTrue(result[0]->Equals(input.MatMul(w->Output()).Add(1.f)));
+        }
+
+        TEST_METHOD(InPlace)
+        {
+            auto x = new Placeholder(Shape(8, 4));
+            auto w = new Constant(Tensor(Shape(3, 8)).FillWithRand(), "w");
+            auto y = matmul(x, w);
+            auto t = tanh(y);
+            auto z = add(y, t);
+
+            Tensor input(Shape(8, 4)); input.FillWithRand();
+            Tensor expected = input.MatMul(w->Output());
+            expected = expected.Add(expected.Map([](float v) { return ::tanh(v); }));
+
+            auto result = Session::Default()->Run({ z }, { { x, &input } });
+            Assert::IsTrue(result[0]->Equals(expected));
+            Assert::IsFalse(t->Output().IsOnHost()); // add took over tanh output
+            Assert::IsTrue(y->Output().IsOnHost()); // matmul output is consumed by both tanh and add
+
+            // kept outputs of memoized operations can't be taken over
+            for (int i = 0; i < 2; ++i)
+            {
+                result = Session::Default()->Run({ z }, { { x, &input } });
+                Assert::IsTrue(result[0]->Equals(expected));
+            }
+        }
+
+        TEST_METHOD(ConcatElision)
+        {
+            auto x = new Placeholder(Shape(4, 3, 2));
+            auto a = add(x, 1.f);
+            auto b = add(x, 2.f);
+            auto c = concat({ a, b }, DepthAxis);
+
+            auto expected = [](const Tensor& input)
+            {
+                Tensor a = input.Add(1.f), b = input.Add(2.f);
+                Tensor result(Shape(input.Width(), input.Height(), input.Depth() * 2, input.Batch()));
+                Tensor::Concat(DepthAxis, { &a, &b }, result);
+                return result;
+            };
+
+            Tensor input(Shape(4, 3, 2)); input.FillWithRand();
+            auto result = Session::Default()->Run({ c }, { { x, &input } });
+            Assert::IsTrue(result[0]->Equals(expected(input)));
+            Assert::IsTrue(a->Output().IsAlias() && b->Output().IsAlias());
+
+            // producers write directly into concatenated output
+            input.FillWithRand();
+            result = Session::Default()->Run({ c }, { { x, &input } });
+            Assert::IsTrue(result[0]->Equals(expected(input)));
+
+            // depth slices are not contiguous for multiple batches
+            Tensor input2(Shape(4, 3, 2, 2)); input2.FillWithRand();
+            result = Session::Default()->Run({ c }, { { x, &input2 } });
+            Assert::IsTrue(result[0]->Equals(expected(input2)));
+            Assert::IsFalse(a->Output().IsAlias());
+        }
+
+        TEST_METHOD(RunAsync)
+        {
+            auto x = new Placeholder(Shape(8, 4));
+            auto w = new Constant(Tensor(Shape(3, 8)).FillWithRand(), "w");
+            auto z = add(matmul(x, w), new Constant(1.f));
+
+            // feed tensor is refilled right after each submission, steps must see values staged at submission time
+            Tensor input(Shape(8, 4));
+            vector<Tensor> expected;
+            vector<shared_future<vector<Tensor>>> steps;
+            for (int i = 0; i < 4; ++i)
+            {
+                input.FillWithRand(i + 1);
+                expected.push_back(input.MatMul(w->Output()).Add(1.f));
+                steps.push_back(Session::Default()->RunAsync({ z }, { { x, &input } }));
+            }
+
+            for (int i = 0; i < 4; ++i)
+                Assert::IsTrue(steps[i].get()[0].Equals(expected[i]));
+            Session::Default()->Sync();
+        }
+
+        TEST_METHOD(Checkpointing)
+        {
+            auto x = new Placeholder(Shape(8, 4));
+            vector<Variable*> weights;
+            TensorLike* h = x;
+            for (int i = 0; i < 9; ++i)
+            {
+                weights.push_back(new Variable(Tensor(Shape(8, 8)).FillWithRand(), "w" + to_string(i)));
+                h = tanh(matmul(h, weights.back()));
+            }
+            auto grads = gradients(sum(square(h)), weights);
+
+            Tensor input(Shape(8, 4)); input.FillWithRand();
+            vector<Tensor> expected;
+            for (auto grad : Session::Default()->Run(grads, { { x, &input } }))
+                expected.push_back(*grad);
+
+            // intermediate activations are released during forward pass and recomputed from every sqrt(N)-th one
+            Graph::Default()->Checkpointing(SqrtCheckpointing);
+            auto result = Session::Default()->Run(grads, { { x, &input } });
+            Graph::Default()->Checkpointing(NoCheckpointing);
+
+            for (size_t i = 0; i < grads.size(); ++i)
+                Assert::IsTrue(result[i]->Equals(expected[i]));
+
+            // random operation can't be released even when its previous run was in inference mode
+            auto d = dropout(h, 0.5f);
+            auto dropoutGrads = gradients(sum(square(d)), weights);
+            Session::Default()->Run({ d }, { { x, &input } });
+
+            vector<TensorLike*> order;
+            Assert::IsTrue(Graph::Default()->BuildForwardOrder(dropoutGrads, order));
+            Graph::Default()->Checkpointing(SqrtCheckpointing);
+            auto schedule = Graph::Default()->BuildReleaseSchedule(order, dropoutGrads);
+            Graph::Default()->Checkpointing(NoCheckpointing);
+
+            size_t releasedNum = 0;
+            for (auto& released : schedule)
+            {
+                releasedNum += released.size();
+                Assert::IsTrue(find(released.begin(), released.end(), d) == released.end());
+            }
+            Assert::IsTrue(releasedNum > 0);
+        }
+
+        TEST_METHOD(Profiling)
+        {
+            auto x = new Variable(Tensor(Shape(8, 4)).FillWithRand());
+            auto w = new Variable(Tensor(Shape(3, 8)).FillWithRand());
+            auto y = matmul(x, w);
+
+            Session::Default()->ClearProfile();
+            Session::Default()->EnableProfiling();
+            Session::Default()->Run({ y });
+            Session::Default()->EnableProfiling(false);
+
+            auto events = Profiler::CollectEvents();
+            auto it = find_if(events.begin(), events.end(), [&](const ProfileEvent& e) { return e.name == y->Name(); });
+            Assert::IsTrue(it != events.end());
+            Assert::AreEqual(string("forward"), string(it->category));
+            Assert::AreEqual((double)(2 * 3 * 4 * 8), (double)it->flops);
+            Assert::IsTrue(Session::Default()->ProfileSummary().find("MatMulOp") != string::npos);
+            Session::Default()->ClearProfile();
+        }
     };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
-﻿#include "CppUnitTest.h"
+﻿#include <thread>
+#include "CppUnitTest.h"
 #include "Neuro.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
@@ -23,6 +24,266 @@ namespace NeuroTests
             TestDenseNetwork(2, 50, -1, 200);
         }
 
+        TEST_METHOD(TiledExecutor_Matches_Full_Predict)
+        {
+            auto createModel = [](uint32_t size)
+            {
+                auto model = new Sequential("tiled_test");
+                model->AddLayer((new Conv2D(Shape(size, size, 2), 3, 3, 1, 1, new ReLU()))->KernelInitializer(new Const(0.1f)));
+                model->AddLayer(new MaxPooling2D(2, 2));
+                model->AddLayer((new Conv2D(4, 3, 1, 1, new ReLU()))->KernelInitializer(new Const(-0.05f))->BiasInitializer(new Const(0.3f)));
+                model->AddLayer(new UpSampling2D(2));
+                model->AddLayer((new Conv2D(1, 3, 1, 1))->KernelInitializer(new Const(0.2f)));
+                return model;
+            };
+
+            auto fullModel = createModel(40);
+            auto tileModel = createModel(16);
+
+            Tensor input(Shape(40, 40, 2, 2));
+            input.FillWithRand();
+
+            TiledExecutor executor(tileModel, 16 * 1024);
+            Assert::AreEqual(2u, executor.Alignment());
+            Assert::AreEqual(6u, executor.Halo());
+
+            auto expected = *fullModel->Predict(input)[0];
+            auto result = executor.Predict(input);
+            Assert::IsTrue(result.Equals(expected));
+        }
+
+        TEST_METHOD(TiledExecutor_Padding_Halo)
+        {
+            auto createModel = [](uint32_t size)
+            {
+                auto model = new Sequential("tiled_padding_test");
+                model->AddLayer((new Conv2D(Shape(size, size, 2), 3, 3, 1, 1, new ReLU()))->KernelInitializer(new Const(0.1f)));
+                model->AddLayer(new ZeroPadding2D(4, 4, 4, 4));
+                model->AddLayer((new Conv2D(2, 9, 1, 0))->KernelInitializer(new Const(-0.05f))->BiasInitializer(new Const(0.3f)));
+                model->AddLayer(new ZeroPadding2D(4, 4, 4, 4));
+                model->AddLayer((new Conv2D(1, 9, 1, 0))->KernelInitializer(new Const(0.2f)));
+                return model;
+            };
+
+            auto fullModel = createModel(40);
+            auto tileModel = createModel(24);
+
+            Tensor input(Shape(40, 40, 2, 2));
+            input.FillWithRand();
+
+            // padding changes width without striding so valid convolutions still see neighbours 4 pixels away
+            TiledExecutor executor(tileModel, 16 * 1024);
+            Assert::AreEqual(1u, executor.Alignment());
+            Assert::AreEqual(9u, executor.Halo());
+
+            auto expected = *fullModel->Predict(input)[0];
+            auto result = executor.Predict(input);
+            Assert::IsTrue(result.Equals(expected));
+        }
+
+        TEST_METHOD(TiledExecutor_InstanceNormalization_Approximate)
+        {
+            auto createModel = [](uint32_t size)
+            {
+                auto model = new Sequential("tiled_in_test");
+                model->AddLayer((new Conv2D(Shape(size, size, 2), 3, 3, 1, 1, new ReLU()))->KernelInitializer(new Const(0.1f)));
+                model->AddLayer(new InstanceNormalization());
+                model->AddLayer((new Conv2D(1, 3, 1, 1))->KernelInitializer(new Const(0.2f)));
+                return model;
+            };
+
+            auto fullModel = createModel(40);
+            Tensor input(Shape(40, 40, 2, 2));
+            input.FillWithRand();
+            auto expected = *fullModel->Predict(input)[0];
+
+            // statistics of a single tile covering the whole image are the same as in full inference
+            TiledExecutor wholeExecutor(createModel(40), 16 * 1024, -1, true);
+            Assert::IsTrue(wholeExecutor.Predict(input).Equals(expected));
+
+            // per tile statistics differ from per image ones, that is why approximate tiling has to be requested explicitly
+            TiledExecutor executor(createModel(16), 16 * 1024, -1, true);
+            auto result = executor.Predict(input);
+            Assert::IsTrue(result.GetShape() == expected.GetShape());
+            Assert::IsFalse(result.Equals(expected));
+        }
+
+        TEST_METHOD(Gradient_Accumulation_Matches_Full_Batch)
+        {
+            auto createModel = []()
+            {
+                auto model = new Sequential("accumulation_test", 7);
+                model->AddLayer((new Dense(3, 2))->WeightsInitializer(new Const(0.5f)));
+                model->Optimize(new SGD(0.05f), new MeanSquareError(), {}, Nothing);
+                return model;
+            };
+
+            Tensor inputs(Shape(3, 1, 1, 10));
+            inputs.FillWithRand(10, -1, 1);
+            Tensor outputs(Shape(2, 1, 1, 10));
+            outputs.FillWithRand(11, -1, 1);
+
+            auto model = createModel();
+            model->Fit(inputs, outputs, 10, 5, nullptr, nullptr, 0, false);
+
+            // micro-batches of uneven sizes (3, 3, 4)
+            auto accModel = createModel();
+            accModel->Fit(inputs, outputs, 10, 5, nullptr, nullptr, 0, false, 3);
+
+            auto params = model->Layers().back()->Weights();
+            auto accParams = accModel->Layers().back()->Weights();
+            for (size_t i = 0; i < params.size(); ++i)
+                Assert::IsTrue(params[i]->Equals(*accParams[i], 1e-5f));
+        }
+
+        TEST_METHOD(TrainOnBatch_Gradient_Accumulation_Matches_Full_Batch)
+        {
+            auto createModel = []()
+            {
+                auto model = new Sequential("accumulation_test", 7);
+                model->AddLayer((new Dense(3, 2))->WeightsInitializer(new Const(0.5f)));
+                model->Optimize(new SGD(0.05f), new MeanSquareError(), {}, Nothing);
+                return model;
+            };
+
+            Tensor inputs(Shape(3, 1, 1, 10));
+            inputs.FillWithRand(10, -1, 1);
+            Tensor outputs(Shape(2, 1, 1, 10));
+            outputs.FillWithRand(11, -1, 1);
+
+            auto model = createModel();
+            model->TrainOnBatch(inputs, outputs);
+            model->TrainOnBatch(inputs, outputs);
+
+            // second call must make a regular step again, so accumulation state can't leak between calls
+            auto accModel = createModel();
+            accModel->TrainOnBatch(inputs, outputs, 3);
+            accModel->TrainOnBatch(inputs, outputs);
+
+            auto params = model->Layers().back()->Weights();
+            auto accParams = accModel->Layers().back()->Weights();
+            for (size_t i = 0; i < params.size(); ++i)
+                Assert::IsTrue(params[i]->Equals(*accParams[i], 1e-5f));
+        }
+
+        TEST_METHOD(DataParallel_Matches_Single_Replica)
+        {
+            auto createModel = [](uint32_t replicas)
+            {
+                auto model = new Sequential("data_parallel_test", 7);
+                model->AddLayer((new Dense(3, 4, new Tanh()))->WeightsInitializer(new Const(0.3f)));
+                model->AddLayer((new Dense(2))->WeightsInitializer(new Const(-0.2f)));
+                model->DataParallel(replicas);
+                model->Optimize(new SGD(0.05f), new MeanSquareError(), {}, Nothing);
+                return model;
+            };
+
+            Tensor inputs(Shape(3, 1, 1, 12));
+            inputs.FillWithRand(10, -1, 1);
+            Tensor outputs(Shape(2, 1, 1, 12));
+            outputs.FillWithRand(11, -1, 1);
+
+            auto model = createModel(1);
+            model->Fit(inputs, outputs, 12, 5, nullptr, nullptr, 0, false);
+
+            auto parallelModel = createModel(4);
+            parallelModel->Fit(inputs, outputs, 12, 5, nullptr, nullptr, 0, false);
+
+            for (size_t l = 0; l < model->Layers().size(); ++l)
+            {
+                auto params = model->Layers()[l]->Weights();
+                auto parallelParams = parallelModel->Layers()[l]->Weights();
+                for (size_t i = 0; i < params.size(); ++i)
+                    Assert::IsTrue(params[i]->Equals(*parallelParams[i], 1e-5f));
+            }
+        }
+
+        TEST_METHOD(Concurrent_Predicters_Match_Predict)
+        {
+            auto model = new Sequential("concurrent_predict_test", 7);
+            model->AddLayer(new Dense(3, 8, new Tanh()));
+            model->AddLayer(new Dense(2, new Sigmoid()));
+
+            const int THREADS = 4;
+            vector<Tensor> inputs, expected;
+            vector<Predicter*> predicters;
+            for (int t = 0; t < THREADS; ++t)
+            {
+                inputs.push_back(Tensor(Shape(3, 1, 1, 5)));
+                inputs.back().FillWithRand(10 + t, -1, 1);
+                expected.push_back(*model->Predict(inputs.back())[0]);
+                predicters.push_back(model->CreatePredicter());
+            }
+
+            vector<int> matches(THREADS, 1);
+            vector<thread> threads;
+            for (int t = 0; t < THREADS; ++t)
+            {
+                threads.emplace_back([&, t]()
+                {
+                    for (int i = 0; i < 20; ++i)
+                        matches[t] = matches[t] && predicters[t]->Predict({ &inputs[t] })[0]->Equals(expected[t]);
+                });
+            }
+            for (auto& t : threads)
+                t.join();
+
+            for (int t = 0; t < THREADS; ++t)
+            {
+                Assert::IsTrue(matches[t]);
+                delete predicters[t];
+            }
+        }
+
+        TEST_METHOD(BatchingServer_Matches_Predict)
+        {
+            auto model = new Sequential("batching_server_test", 7);
+            model->AddLayer(new Dense(3, 8, new Tanh()));
+            model->AddLayer(new Dense(2, new Sigmoid()));
+
+            const int REQUESTS = 10;
+            vector<Tensor> inputs, expected;
+            for (int i = 0; i < REQUESTS; ++i)
+            {
+                inputs.push_back(Tensor(Shape(3)));
+                inputs.back().FillWithRand(10 + i, -1, 1);
+                expected.push_back(*model->Predict(inputs.back())[0]);
+            }
+
+            BatchingServer server(model, 4, 50000);
+            vector<future<vector<Tensor>>> results;
+            for (int i = 0; i < REQUESTS; ++i)
+                results.push_back(server.Enqueue(inputs[i]));
+
+            for (int i = 0; i < REQUESTS; ++i)
+                Assert::IsTrue(results[i].get()[0].Equals(expected[i]));
+
+            auto stats = server.GetStats();
+            Assert::AreEqual(REQUESTS, (int)stats.requests);
+            Assert::IsTrue(stats.batches >= 3 && stats.batches < REQUESTS);
+        }
+
+        TEST_METHOD(BatchingServer_Rejects_Invalid_Requests)
+        {
+            auto model = new Sequential("batching_server_invalid_test", 7);
+            model->AddLayer(new Dense(3, 2, new Tanh()));
+
+            BatchingServer server(model, 4, 1000);
+            Tensor wrongShape(Shape(4)), wrongBatch(Shape(3, 1, 1, 2)), valid(Shape(3));
+            valid.FillWithRand(10, -1, 1);
+
+            auto wrongShapeResult = server.Enqueue(wrongShape);
+            auto wrongBatchResult = server.Enqueue(wrongBatch);
+            auto wrongCountResult = server.Enqueue(const_tensor_ptr_vec_t{ &valid, &valid });
+            Assert::ExpectException<invalid_argument>([&]() { wrongShapeResult.get(); });
+            Assert::ExpectException<invalid_argument>([&]() { wrongBatchResult.get(); });
+            Assert::ExpectException<invalid_argument>([&]() { wrongCountResult.get(); });
+
+            // rejected requests never reach the worker
+            Assert::IsTrue(server.Enqueue(valid).get()[0].Equals(*model->Predict(valid)[0]));
+            Assert::AreEqual(1, (int)server.GetStats().requests);
+        }
+
         ModelBase* CreateFitTestNet()
         {
             auto model = new Sequential("fit_test", 7);
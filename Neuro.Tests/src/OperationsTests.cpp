@@ -27,6 +27,14 @@ namespace NeuroTests
             Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new InstanceNormalizeOp(&x, &gamma, &beta, 0.00001f)).get(), false, { 0,0,0,1 }));
         }
 
+        TEST_METHOD(InstanceNormalize_SharedParams)
+        {
+            auto x = Variable(Shape(3, 4, 5, 2));
+            auto gamma = Variable(Shape(1, 1, 5, 1));
+            auto beta = Variable(gamma.GetShape());
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new InstanceNormalizeOp(&x, &gamma, &beta, 0.00001f)).get(), false, { 0,0,0,1 }));
+        }
+
         TEST_METHOD(BatchNormalize_Spatial)
         {
             auto x = Variable(Shape(3, 4, 5, 2));
@@ -54,6 +62,142 @@ namespace NeuroTests
             Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new Conv2dBiasActivationOp(&x, &kernels, 1, 1, &bias, _ReLU, 1)).get()));
         }
 
+        TEST_METHOD(UpSampleConv2d)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(5, 4, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 5));
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new UpSampleConv2dOp(&x, &kernels, 2, 1, 1)).get()));
+        }
+
+        TEST_METHOD(UpSampleConv2dBiasActivation)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(5, 4, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 5));
+            auto bias = Variable(Shape(1, 1, 5, 1));
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new UpSampleConv2dOp(&x, &kernels, 2, 1, 1, &bias, _ReLU, 1)).get()));
+        }
+
+        TEST_METHOD(PaddedConv2d_Constant)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(6, 5, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 4));
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new PaddedConv2dOp(&x, &kernels, 1, 2, 1, 1, 2, ConstantBorder, 0.5f)).get()));
+        }
+
+        TEST_METHOD(PaddedConv2dBiasActivation)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(6, 5, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 4));
+            auto bias = Variable(Shape(1, 1, 4, 1));
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new PaddedConv2dOp(&x, &kernels, 1, 2, 1, 1, 2, ConstantBorder, 0.5f, &bias, _ReLU, 1)).get()));
+        }
+
+        TEST_METHOD(PaddedConv2d_Reflect)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(6, 5, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 4));
+            // inputs gradient ignores border taps (same as Pad2DGradient) so it differs from numerical one
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new PaddedConv2dOp(&x, &kernels, 1, 2, 1, 1, 2, ReflectBorder)).get(), false, { true, false }));
+        }
+
+        TEST_METHOD(PaddedConv2d_Reflect_Matches_Pad_Conv2d)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Tensor(Shape(6, 5, 3, 2)).FillWithRand(10));
+            auto kernels = Variable(Tensor(Shape(3, 3, 3, 4)).FillWithRand(11));
+
+            // unfused pad followed by convolution is what GPU falls back to
+            unique_ptr<Operation> pad(new ReflectPad2dOp(&x, 2, 1, 1, 2));
+            unique_ptr<Operation> conv(new Conv2dOp(pad.get(), &kernels, 1, 0));
+            unique_ptr<Operation> fused(new PaddedConv2dOp(&x, &kernels, 1, 2, 1, 1, 2, ReflectBorder));
+
+            pad->Compute(true);
+            Tensor expected = conv->Compute(true);
+            Tensor result = fused->Compute(true);
+            Assert::IsTrue(result.Equals(expected));
+
+            Tensor grad(result.GetShape());
+            grad.FillWithRand(12);
+            conv->ComputeGradient(grad);
+            pad->ComputeGradient(conv->InputsGrads()[0]);
+            fused->ComputeGradient(grad);
+
+            Assert::IsTrue(fused->InputsGrads()[0].Equals(pad->InputsGrads()[0], 1e-4f));
+            Assert::IsTrue(fused->InputsGrads()[1].Equals(conv->InputsGrads()[1], 1e-4f));
+        }
+
+        TEST_METHOD(PaddedConv2d_LinearRamp_Matches_Pad_Conv2d)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Tensor(Shape(6, 5, 3, 2)).FillWithRand(10));
+            auto kernels = Variable(Tensor(Shape(3, 3, 3, 4)).FillWithRand(11));
+
+            unique_ptr<Operation> pad(new LinearRampPad2dOp(&x, 2, 1, 1, 2, 0.3f));
+            unique_ptr<Operation> conv(new Conv2dOp(pad.get(), &kernels, 1, 0));
+            unique_ptr<Operation> fused(new PaddedConv2dOp(&x, &kernels, 1, 2, 1, 1, 2, LinearRampBorder, 0.3f));
+
+            pad->Compute(true);
+            Tensor expected = conv->Compute(true);
+            Tensor result = fused->Compute(true);
+            Assert::IsTrue(result.Equals(expected, 1e-5f));
+
+            Tensor grad(result.GetShape());
+            grad.FillWithRand(12);
+            conv->ComputeGradient(grad);
+            pad->ComputeGradient(conv->InputsGrads()[0]);
+            fused->ComputeGradient(grad);
+
+            Assert::IsTrue(fused->InputsGrads()[0].Equals(pad->InputsGrads()[0], 1e-4f));
+            Assert::IsTrue(fused->InputsGrads()[1].Equals(conv->InputsGrads()[1], 1e-4f));
+        }
+
+        TEST_METHOD(Conv2dBatchNormalize)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(7, 7, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 4));
+            auto bias = Variable(Shape(1, 1, 4, 1));
+            auto gamma = Variable(Shape(1, 1, 4, 1));
+            auto beta = Variable(gamma.GetShape());
+            auto runningMean = Variable(zeros(gamma.GetShape()));
+            auto runningVar = Variable(ones(gamma.GetShape()));
+            // bias gradient vanishes as normalization removes per channel shift
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new Conv2dBatchNormalizeOp(&x, &kernels, &bias, 1, 1, &gamma, &beta, &runningMean, &runningVar, 0.9f, 0.00001f)).get(), false, { 0,0,0,0,1,1,1 }));
+        }
+
+        TEST_METHOD(Conv2dBatchNormalize_Folded)
+        {
+            Tensor::SetForcedOpMode(CPU);
+            auto x = Variable(Shape(7, 7, 3, 2));
+            auto kernels = Variable(Shape(3, 3, 3, 4));
+            auto bias = Variable(Shape(1, 1, 4, 1));
+            auto gamma = Variable(Shape(1, 1, 4, 1));
+            auto beta = Variable(gamma.GetShape());
+            auto runningMean = Variable(gamma.GetShape());
+            auto runningVar = Variable(gamma.GetShape());
+            for (auto node : vector<Variable*>{ &x, &kernels, &bias, &gamma, &beta, &runningMean })
+                node->Output().FillWithRand(-1, -1.f, 1.f);
+            runningVar.Output().FillWithRand(-1, 0.5f, 2.f);
+
+            auto op = unique_ptr<Operation>(new Conv2dBatchNormalizeOp(&x, &kernels, &bias, 1, 1, &gamma, &beta, &runningMean, &runningVar, 0.9f, 0.001f));
+
+            auto expected = x.Output().Conv2D(kernels.Output(), 1, 1, NCHW);
+            expected.Add(bias.Output(), expected);
+            Tensor expectedNorm(expected.GetShape());
+            expected.BatchNorm(gamma.Output(), beta.Output(), 0.001f, &runningMean.Output(), &runningVar.Output(), expectedNorm);
+            Assert::IsTrue(op->Compute(false).Equals(expectedNorm, 1e-4f));
+
+            // folded weights have to be refreshed after weights change
+            gamma.Output().Mul(2.f, gamma.Output());
+            expected.BatchNorm(gamma.Output(), beta.Output(), 0.001f, &runningMean.Output(), &runningVar.Output(), expectedNorm);
+            Assert::IsTrue(op->Compute(false).Equals(expectedNorm, 1e-4f));
+        }
+
         TEST_METHOD(Pool2d_Max)
         {
             auto x = Variable(Shape(9, 9, 3, 2));
@@ -202,6 +346,12 @@ namespace NeuroTests
             Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new MatMulOp(&x, &y)).get()));
         }
 
+        TEST_METHOD(GramMatrix)
+        {
+            auto x = Variable(Shape(4, 3, 5, 2));
+            Assert::IsTrue(ValidateOperation(unique_ptr<Operation>(new GramMatrixOp(&x, 0.5f)).get()));
+        }
+
         TEST_METHOD(SwapRedBlueChannels)
         {
             auto x = Variable(Shape(6, 7, 3, 2));
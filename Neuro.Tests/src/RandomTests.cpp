@@ -37,5 +37,35 @@ namespace NeuroTests
 
             Assert::IsTrue(v1 == v2);
         }
+
+        TEST_METHOD(Philox_KnownAnswer)
+        {
+            // reference values from Random123 test vectors
+            uint32_t r[4];
+            Philox::Generate(0, 0, 0, r);
+            Assert::AreEqual(0x6627e8d5u, r[0]);
+            Assert::AreEqual(0xe169c58du, r[1]);
+            Assert::AreEqual(0xbc57ac4cu, r[2]);
+            Assert::AreEqual(0x9b00dbd8u, r[3]);
+        }
+
+        TEST_METHOD(Philox_Determinism)
+        {
+            vector<float> v1(10001), v2(10001);
+            Philox rng(101);
+            rng.FillUniform(&v1[0], v1.size());
+            rng.FillNormal(&v2[0], v2.size(), 0.f, 1.f, 1.f, true);
+
+            Philox rng2(101);
+            vector<float> v3(10001), v4(10001);
+            rng2.FillUniform(&v3[0], v3.size());
+            rng2.FillNormal(&v4[0], v4.size(), 0.f, 1.f, 1.f, true);
+
+            Assert::IsTrue(v1 == v3);
+            Assert::IsTrue(v2 == v4);
+            Assert::IsTrue(v1 != v2);
+            for (auto v : v4)
+                Assert::IsTrue(::abs(v) <= 2.f);
+        }
     };
 }
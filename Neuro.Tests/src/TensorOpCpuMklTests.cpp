@@ -78,6 +78,43 @@ namespace NeuroTests
             Assert::IsTrue(r.Equals(r2));
         }
 
+        TEST_METHOD(MatMul_Self_CompareWithCpuResult)
+        {
+            // input and output slices have different sizes so mirrored triangle must be addressed at output offsets
+            Tensor t(Shape(40, 30, 3, 4)); t.FillWithRand();
+
+            Tensor::SetForcedOpMode(CPU);
+            NEURO_PROFILE("CPU", Tensor r = t.MatMul(false);)
+            Tensor rT = t.MatMul(true);
+
+            Tensor::SetForcedOpMode(CPU_MKL);
+            NEURO_PROFILE("CPU_MKL", Tensor r2 = t.MatMul(false);)
+            Tensor r2T = t.MatMul(true);
+
+            Assert::IsTrue(r.Equals(r2, 0.0001f));
+            Assert::IsTrue(rT.Equals(r2T, 0.0001f));
+        }
+
+        TEST_METHOD(GramMatrix_CompareWithCpuResult)
+        {
+            Tensor t(Shape(12, 10, 16, 2)); t.FillWithRand();
+            Tensor grad(Shape(16, 16, 1, 2)); grad.FillWithRand();
+            const float scale = 1.f / t.GetShape().Dim0Dim1Dim2;
+
+            Tensor::SetForcedOpMode(CPU);
+            NEURO_PROFILE("CPU", Tensor r = t.GramMatrix(scale);)
+            Tensor rGrad(t.GetShape());
+            t.GramMatrixGradient(grad, scale, rGrad);
+
+            Tensor::SetForcedOpMode(CPU_MKL);
+            NEURO_PROFILE("CPU_MKL", Tensor r2 = t.GramMatrix(scale);)
+            Tensor r2Grad(t.GetShape());
+            t.GramMatrixGradient(grad, scale, r2Grad);
+
+            Assert::IsTrue(r.Equals(r2));
+            Assert::IsTrue(rGrad.Equals(r2Grad));
+        }
+
         TEST_METHOD(Transpose_CompareWithCpuResult)
         {
             Tensor t(Shape(10, 20, 3, 4)); t.FillWithRand();
@@ -175,7 +175,8 @@ namespace NeuroTests
         {
             Tensor t(Shape(10, 20, 30, 40)); t.FillWithRand();
 
-            auto func = [](float x) { return 2 * x; };
+            // std::function selects Map overload going through active tensor op (lambda would bind to host-only template)
+            function<float(float)> func = [](float x) { return 2 * x; };
 
             Tensor::SetForcedOpMode(CPU);
             NEURO_PROFILE("CPU", Tensor r = t.Map(func);)
@@ -458,6 +458,26 @@ namespace NeuroTests
             Assert::IsTrue(r.Equals(r2, 0.0001f));
         }
 
+        TEST_METHOD(GramMatrix_CompareWithCpuResult)
+        {
+            Tensor t(Shape(12, 10, 16, 3)); t.FillWithRand();
+            Tensor grad(Shape(16, 16, 1, 3)); grad.FillWithRand();
+            const float scale = 1.f / t.GetShape().Dim0Dim1Dim2;
+
+            Tensor::SetForcedOpMode(CPU);
+            NEURO_PROFILE("CPU", Tensor r = t.GramMatrix(scale);)
+            Tensor rGrad(t.GetShape());
+            t.GramMatrixGradient(grad, scale, rGrad);
+
+            Tensor::SetForcedOpMode(GPU);
+            NEURO_PROFILE("GPU", Tensor r2 = t.GramMatrix(scale);)
+            Tensor r2Grad(t.GetShape());
+            t.GramMatrixGradient(grad, scale, r2Grad);
+
+            Assert::IsTrue(r.Equals(r2, 0.0001f));
+            Assert::IsTrue(rGrad.Equals(r2Grad, 0.0001f));
+        }
+
         TEST_METHOD(Add_SameDims_CompareWithCpuResult)
         {
             Tensor t1(Shape(20, 30, 40, 50)); t1.FillWithRand();
@@ -1154,7 +1174,8 @@ namespace NeuroTests
         {
             Tensor t(Shape(1, 2, 3, 4)); t.FillWithRand();
 
-            auto func = [](float x) { return 2 * x; };
+            // std::function selects Map overload going through active tensor op (lambda would bind to host-only template)
+            function<float(float)> func = [](float x) { return 2 * x; };
 
             Tensor::SetForcedOpMode(CPU);
             NEURO_PROFILE("CPU", Tensor r = t.Map(func);)
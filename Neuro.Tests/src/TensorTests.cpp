@@ -448,6 +448,32 @@ namespace NeuroTests
             Assert::IsTrue(r.Equals(correct));
         }
 
+        TEST_METHOD(MaxPool_Indices_Matches_Pool)
+        {
+            Tensor::SetDefaultOpMode(EOpMode::CPU);
+
+            // overlapping windows with padding, for 2x2, 3x3 and generic window kernels
+            for (uint32_t filterSize = 2; filterSize <= 4; ++filterSize)
+            for (auto dataFormat : { NCHW, NHWC })
+            {
+                Tensor input(Shape(9, 7, 5, 2)); input.FillWithRand(12);
+                uint32_t padding = filterSize / 2;
+                Tensor output = input.Pool2D(filterSize, 2, MaxPool, padding, dataFormat);
+                Tensor gradient(output.GetShape()); gradient.FillWithRand(13);
+                Tensor correct(input.GetShape());
+                output.Pool2DGradient(output, input, gradient, filterSize, 2, MaxPool, padding, dataFormat, correct);
+
+                Tensor r(output.GetShape());
+                vector<uint8_t> maxIndices(r.Length());
+                input.MaxPool2D(filterSize, 2, padding, dataFormat, r, maxIndices.data());
+                Assert::IsTrue(r.Equals(output));
+
+                Tensor result(input.GetShape());
+                gradient.MaxPool2DGradient(maxIndices.data(), filterSize, 2, padding, dataFormat, result);
+                Assert::IsTrue(result.Equals(correct));
+            }
+        }
+
         TEST_METHOD(Pool_Avg_Valid_2Batches_Stride2)
         {
             Tensor::SetDefaultOpMode(EOpMode::CPU);
@@ -1199,6 +1225,26 @@ namespace NeuroTests
                 Assert::AreEqual((double)result.GetFlat(i), (double)t.GetFlat(i) * other.GetFlat(i), 1e-7);
         }
 
+        TEST_METHOD(Zip_Broadcast)
+        {
+            Tensor::SetDefaultOpMode(EOpMode::CPU);
+
+            auto t = Tensor(Shape(2, 3, 4, 5)); t.FillWithRand();
+            auto other = Tensor(Shape(1, 3, 1, 5)); other.FillWithRand();
+            auto result = t.Zip([](float x, float x2) { return x - x2; }, other);
+
+            for (uint32_t n = 0; n < t.Batch(); ++n)
+            for (uint32_t d = 0; d < t.Depth(); ++d)
+            for (uint32_t h = 0; h < t.Height(); ++h)
+            for (uint32_t w = 0; w < t.Width(); ++w)
+                Assert::AreEqual((double)result(w, h, d, n), (double)t(w, h, d, n) - other(0, h, 0, n), 1e-7);
+
+            // in-place over three inputs
+            auto expected = result.Map([](float x) { return 3 * x; });
+            Tensor::ZipN([](float x, float x2, float x3) { return x + x2 + x3; }, result, result, result, result);
+            Assert::IsTrue(result.Equals(expected));
+        }
+
         TEST_METHOD(Concat_Width)
         {
             Tensor::SetDefaultOpMode(EOpMode::CPU);
@@ -1329,6 +1375,87 @@ namespace NeuroTests
             Assert::IsTrue(result.Equals(correct));
         }
 
+        TEST_METHOD(HalfFloat_Conversion)
+        {
+            Assert::AreEqual(1.f, Fp16ToFloat(FloatToFp16(1.f)));
+            Assert::AreEqual(-2.5f, Fp16ToFloat(FloatToFp16(-2.5f)));
+            Assert::AreEqual(65504.f, Fp16ToFloat(FloatToFp16(65504.f)));
+            Assert::IsTrue(isinf(Fp16ToFloat(FloatToFp16(70000.f))));
+            Assert::AreEqual(powf(2.f, -24.f), Fp16ToFloat(FloatToFp16(powf(2.f, -24.f)))); // smallest subnormal
+            Assert::AreEqual(0.f, Fp16ToFloat(FloatToFp16(powf(2.f, -26.f))));
+            Assert::AreEqual(1.f, Bf16ToFloat(FloatToBf16(1.f)));
+            Assert::AreEqual(3.140625f, Bf16ToFloat(FloatToBf16(3.14159265f)));
+            Assert::AreEqual(1e30f, Bf16ToFloat(FloatToBf16(1e30f)), 1e28f);
+            Assert::IsTrue(isnan(Bf16ToFloat(FloatToBf16(NAN))));
+        }
+
+        TEST_METHOD(Pack_Unpack_BFloat16)
+        {
+            Tensor t(Shape(5, 4, 3, 2));
+            t.FillWithRand();
+            Tensor copy = t;
+
+            t.SetDataType(BFloat16);
+            t.Pack();
+            Assert::IsTrue(t.IsPacked());
+
+            Tensor result = t.Mul(2.f);
+            Assert::IsFalse(t.IsPacked());
+            Assert::IsTrue(result.Equals(copy.Mul(2.f), 0.01f));
+        }
+
+        TEST_METHOD(Pack_Unpack_Float16)
+        {
+            Tensor t(Shape(5, 4, 3, 2));
+            t.FillWithRand();
+            Tensor copy = t;
+
+            t.SetDataType(Float16);
+            t.Pack();
+            Assert::IsTrue(t.IsPacked());
+            Assert::IsTrue(t.Equals(copy, 0.001f));
+
+            // writing through fp32 buffer has to invalidate packed data
+            t.FillWithValue(3.f);
+            t.Pack();
+            Assert::IsTrue(t.Equals(Tensor(Shape(5, 4, 3, 2)).FillWithValue(3.f)));
+        }
+
+        TEST_METHOD(FastMath_MatchStd)
+        {
+            // odd length so both vector body and scalar tail are exercised
+            vector<float> x(1003), y(1003);
+            for (size_t i = 0; i < x.size(); ++i)
+                x[i] = -20.f + 40.f * i / x.size();
+
+            for (int simd = 1; simd >= 0; --simd)
+            {
+                EnableFastMathSimd(simd == 1);
+
+                FastExp(&x[0], x.size(), &y[0]);
+                for (size_t i = 0; i < x.size(); ++i)
+                    Assert::AreEqual(::exp(x[i]), y[i], ::exp(x[i]) * 1e-6f);
+
+                FastTanh(&x[0], x.size(), &y[0]);
+                for (size_t i = 0; i < x.size(); ++i)
+                    Assert::AreEqual(::tanh(x[i]), y[i], 1e-6f);
+
+                FastSigmoid(&x[0], x.size(), &y[0]);
+                for (size_t i = 0; i < x.size(); ++i)
+                    Assert::AreEqual(1.f / (1.f + ::exp(-x[i])), y[i], 1e-6f);
+
+                FastLog(&x[0], x.size(), &y[0]);
+                for (size_t i = 0; i < x.size(); ++i)
+                {
+                    if (x[i] > 0)
+                        Assert::AreEqual(::log(x[i]), y[i], 1e-6f);
+                    else
+                        Assert::IsTrue(x[i] == 0 ? isinf(y[i]) : isnan(y[i]));
+                }
+            }
+            EnableFastMathSimd(true);
+        }
+
         /*TEST_METHOD(Image_Save_Load)
         {
             Tensor t(Shape(50, 50, 3));
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "Types.h"
 #include "Tensors/Shape.h"
 
@@ -14,6 +17,9 @@ namespace Neuro
     struct VGG16
     {
         static ModelBase* CreateModel(EDataFormat dataFormat, Shape inputShape = Shape(), bool includeTop = true, EPoolingMode poolMode = MaxPool, const string& weightsDir = "");
+        // Creates multi-output model with outputs of requested layers (i.e. "block4_conv2") in requested order. Only layers up to
+        // the deepest requested one are created and only their weights are read from notop weights file.
+        static ModelBase* CreateFeatureExtractor(const vector<string>& outputLayers, EDataFormat dataFormat, Shape inputShape = Shape(), EPoolingMode poolMode = MaxPool, const string& weightsDir = "");
         static TensorLike* Preprocess(TensorLike* image, EDataFormat dataFormat, bool swapChannels = true);
         static TensorLike* Deprocess(TensorLike* image, EDataFormat dataFormat, bool swapChannels = true, bool clipValues = true);
 
@@ -24,5 +30,8 @@ namespace Neuro
         static Tensor DeprocessImageCopy(const Tensor& image, EDataFormat dataFormat, bool swapChannels = true, bool clipValues = true);
 
         static void SwapChannels(Tensor& image);
+
+        // Shared by VGG16 and VGG19 feature extractors, they differ only in number of convolutions per block
+        static ModelBase* BuildFeatureExtractor(const string& name, const vector<uint32_t>& convsPerBlock, const string& weightsFile, const vector<string>& outputLayers, EDataFormat dataFormat, Shape inputShape, EPoolingMode poolMode);
     };
 }
@@ -11,5 +11,7 @@ namespace Neuro
     struct VGG19
     {
         static ModelBase* CreateModel(EDataFormat dataFormat, Shape inputShape = Shape(), bool includeTop = true, EPoolingMode poolMode = MaxPool, const string& weightsDir = "");
+        // See VGG16::CreateFeatureExtractor
+        static ModelBase* CreateFeatureExtractor(const vector<string>& outputLayers, EDataFormat dataFormat, Shape inputShape = Shape(), EPoolingMode poolMode = MaxPool, const string& weightsDir = "");
     };
 }
\ No newline at end of file
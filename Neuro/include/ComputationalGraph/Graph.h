@@ -1,8 +1,11 @@
 ﻿#pragma once
 
+#include <functional>
 #include <vector>
 #include <unordered_set>
 
+#include "Types.h"
+
 namespace Neuro
 {
     using namespace std;
@@ -12,6 +15,16 @@ namespace Neuro
     class Operation;
     class Variable;
     class Constant;
+    class Tensor;
+
+    // Execution order of a graph containing replicated sub-graphs (data parallelism), nodes exclusive to a single replica
+    // can be computed concurrently with other replicas
+    struct ReplicatedOrder
+    {
+        vector<TensorLike*> prologue; // nodes which have to be computed before replicas
+        vector<vector<TensorLike*>> replicas;
+        vector<TensorLike*> epilogue; // nodes which have to be computed after all replicas are done
+    };
 
     class Graph
     {
@@ -40,19 +53,45 @@ namespace Neuro
         size_t PreloadSteps() const { return m_PreloadSteps; }
         void PreloadSteps(size_t steps) { m_PreloadSteps = steps; }
 
+        /// When enabled operations whose inputs didn't change since last computation reuse their outputs. During inference feeds
+        /// are compared with previously fed values so repeated inputs don't invalidate dependent outputs, training runs skip
+        /// that comparison.
+        bool MemoizationEnabled() const { return m_MemoizationEnabled; }
+        void MemoizationEnabled(bool enabled) { m_MemoizationEnabled = enabled; }
+
+        /// When enabled element-wise operations computed during inference write their output into buffer of an input which
+        /// has no other consumers instead of allocating new one
+        bool InPlaceEnabled() const { return m_InPlaceEnabled; }
+        void InPlaceEnabled(bool enabled) { m_InPlaceEnabled = enabled; }
+
+        /// When enabled activations of training forward pass are released as soon as they are consumed (except for checkpoints)
+        /// and recomputed from the nearest checkpoints during backward pass, trading computation for memory
+        ECheckpointing Checkpointing() const { return m_Checkpointing; }
+        void Checkpointing(ECheckpointing mode) { m_Checkpointing = mode; }
+        // For each node in forward order returns list of nodes whose outputs can be released right after that node is computed
+        vector<vector<TensorLike*>> BuildReleaseSchedule(const vector<TensorLike*>& order, const vector<TensorLike*>& fetches) const;
+        void ReleaseOutput(TensorLike* node);
+
         // Builds nodes visitation order for forward pass, returns true when order contains training operation
         bool BuildForwardOrder(const vector<TensorLike*>& endNodes, vector<TensorLike*>& order);
         // Builds nodes visitation order for backward/gradients computation pass
         vector<TensorLike*> BuildBackwardOrder(const vector<TensorLike*>& endNodes, unordered_set<TensorLike*>& nodesAffectingEndNodes, const vector<Variable*>& params = {});
+        // Splits forward or backward order based on sets of nodes belonging to each replica. Nodes belonging to multiple replicas
+        // (like shared variables) are computed before replicas in forward pass and after replicas in backward pass.
+        ReplicatedOrder SplitOrder(const vector<TensorLike*>& order, const vector<unordered_set<TensorLike*>>& replicasNodes, bool backward) const;
 
         vector<Variable*> ComputeGradients(const vector<TensorLike*>& losses, const vector<Variable*>& params);
-        vector<Variable*> ComputeGradientsInOrder(const vector<TensorLike*>& order, const vector<TensorLike*>& losses, const unordered_set<TensorLike*> nodesAffectingLosses, const vector<Variable*>& params);
+        // Gradient ready callback is invoked as soon as gradient of a returned variable is final (allows overlapping its
+        // communication with the rest of backward pass)
+        vector<Variable*> ComputeGradientsInOrder(const vector<TensorLike*>& order, const vector<TensorLike*>& losses, const unordered_set<TensorLike*> nodesAffectingLosses, const vector<Variable*>& params, const function<void(Variable*)>& gradientReady = nullptr);
 
         TensorLike* GetNode(const string& name);
         void DebugLog();
 
     private:
         void ProcessForwardNode(TensorLike* node, vector<TensorLike*>& nodes, unordered_set<TensorLike*>& visited, bool& is_training);
+        void RecomputeOutput(TensorLike* node);
+        static void SumGradients(const vector<const Tensor*>& grads, Tensor& result);
         void ProcessBackwardNode(TensorLike* node, vector<TensorLike*>& nodes, const vector<Variable*>& params, bool ignoreConsumersCheck, unordered_set<TensorLike*>& visited, unordered_set<TensorLike*>& visitedParams, const unordered_set<TensorLike*>& required);
 
         vector<Placeholder*> m_Placeholders;
@@ -62,6 +101,9 @@ namespace Neuro
         vector<TensorLike*> m_Nodes;
         uint32_t m_CurrentStep = 0;
         size_t m_PreloadSteps = 8;
+        bool m_MemoizationEnabled = true;
+        bool m_InPlaceEnabled = true;
+        ECheckpointing m_Checkpointing = NoCheckpointing;
 
         static Graph* s_Default;
     };
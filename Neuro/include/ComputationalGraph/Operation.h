@@ -29,10 +29,26 @@ namespace Neuro
 
         // Existence of training operations in fetched list will cause network to automatically run in training mode
         virtual bool IsTrainingOp() const { return false; }
+        /// Operations with side effects or random output can't reuse output computed in previous run even when inputs didn't change.
+        /// Training flag refers to the run being computed or planned, not the previous one.
+        virtual bool IsMemoizable(bool training) const { return !IsTrainingOp(); }
+        /// Output was reused from previous run during last computation
+        bool WasMemoized() const { return m_Memoized; }
 
         virtual bool ShouldPreload() const override { return m_OpMode == GPU; }
         EOpMode OpMode() const { return m_OpMode; }
 
+        /// Estimated number of floating point operations in forward pass (used by profiler), by default one per output element
+        virtual uint64_t Flops() const { return m_Output.Length(); }
+
+        /// Outputs of other operations are aliasing output buffer so it can't be moved elsewhere
+        virtual bool SharesOutputBuffer() const { return false; }
+
+        /// Updates of state shared between data parallel replicas (like batch normalization running statistics) are postponed
+        /// while replicas are computed concurrently and applied afterwards in a fixed order
+        void DeferSharedUpdates(bool defer) { m_DeferSharedUpdates = defer; }
+        virtual void ApplySharedUpdates() {}
+
     protected:
         Operation(const vector<TensorLike*>& inputNodes, const string& name);
 
@@ -40,6 +56,18 @@ namespace Neuro
         virtual void ComputeInternal() = 0;
         virtual void ComputeGradientInternal(const Tensor& grad) = 0;
 
+        // In-place computation is allowed only during inference on CPU
+        bool InPlaceAllowed() const;
+        // Moves input's buffer to output when nothing else will read that input (inference only), output is expected to be
+        // already resized. Returns false when input has to be preserved.
+        bool TryTakeOverInput(size_t index);
+        // Makes input node write its output directly into output buffer at given offset in following computations (inference
+        // only). Output must be computed already as current input content is discarded. Returns false when input has to keep
+        // its own memory.
+        bool TryAliasInput(size_t index, size_t offset);
+        // Moves aliased inputs back to their own memory
+        void UnaliasInputs();
+
         EOpMode m_OpMode;
         vector<const Tensor*> m_Inputs;
         vector<Tensor> m_InputsGrads;
@@ -52,5 +80,17 @@ namespace Neuro
         bool m_InputsManuallyConsumed = false;
         bool m_CareAboutGradient = false;
         bool m_Training = false;
+        bool m_DeferSharedUpdates = false;
+
+    private:
+        bool CanReuseOutput(bool training) const;
+        bool CanReuseInputMemory(size_t index) const;
+
+        // inputs and output versions after last computation, used for memoization
+        vector<uint64_t> m_InputsVersions;
+        uint64_t m_OutputVersion = 0;
+        // inputs didn't change between last two computations so output is kept and reused until they change
+        bool m_KeepOutput = false;
+        bool m_Memoized = false;
     };
 }
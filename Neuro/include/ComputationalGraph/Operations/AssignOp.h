@@ -9,6 +9,8 @@ namespace Neuro
     public:
         AssignOp(TensorLike* x, TensorLike* val, const string& name = "");
 
+        virtual bool IsMemoizable(bool training) const override { return false; }
+
     protected:
         virtual void ComputeInternal() override;
         virtual void ComputeGradientInternal(const Tensor& grad) override { assert(false); }
@@ -9,6 +9,14 @@ namespace Neuro
     public:
         BatchNormalizeOp(TensorLike* x, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar, float momentum, float epsilon, const string& name = "");
 
+        // running mean and variance are updated in training mode
+        virtual bool IsMemoizable(bool training) const override { return !training; }
+        virtual void ApplySharedUpdates() override;
+
+        // Blends batch statistics into running ones (momentum is the weight of running statistics), running statistics can be
+        // shared between data parallel replicas so only this update is serialized
+        static void UpdateRunningStats(const Tensor& batchMean, const Tensor& batchVar, float momentum, Tensor& runningMean, Tensor& runningVar);
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeInternal() override;
@@ -24,6 +32,10 @@ namespace Neuro
         Tensor m_SaveMean;
         // Used as cache between forward and backward steps
         Tensor m_SaveInvVar;
+        // Statistics of the last training batch (variance is unbiased) not blended into running ones yet
+        Tensor m_BatchMean;
+        Tensor m_BatchVar;
+        bool m_RunningStatsPending = false;
     };
 
     static Operation* batch_norm(TensorLike* x, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar, float momentum, float epsilon, const string& name = "")
@@ -9,6 +9,8 @@ namespace Neuro
     public:
         ConcatenateOp(const vector<TensorLike*>& xs, EAxis axis = DepthAxis, const string& name = "");
 
+        virtual bool SharesOutputBuffer() const override;
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeInternal() override;
@@ -17,6 +19,9 @@ namespace Neuro
         virtual bool ForceAllocInputGradNode(size_t index) const override;
 
     private:
+        // Every input occupies single contiguous region of output when all dimensions above concatenation axis are 1
+        bool InputsContiguous() const;
+
         EAxis m_Axis;
     };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ComputationalGraph/Operation.h"
+
+namespace Neuro
+{
+    // Convolution (NCHW) with optional bias followed by spatial batch normalization. Training computes them one after another,
+    // inference folds normalization into convolution kernels and bias (refreshed only when any of the weights changes) so the
+    // whole layer is a single convolution with bias.
+    class Conv2dBatchNormalizeOp : public Operation
+    {
+    public:
+        Conv2dBatchNormalizeOp(TensorLike* x, TensorLike* kernels, TensorLike* bias, uint32_t stride, uint32_t padding, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar, float momentum, float epsilon, const string& name = "");
+
+        // running mean and variance are updated in training mode
+        virtual bool IsMemoizable(bool training) const override { return !training; }
+        virtual uint64_t Flops() const override;
+        virtual void ApplySharedUpdates() override;
+
+    protected:
+        virtual void UpdateOutputShape() override;
+        virtual void ComputeInternal() override;
+        virtual void ComputeGradientInternal(const Tensor& grad) override;
+
+        virtual bool ForceAllocInputGradNode(size_t index) const override;
+
+    private:
+        void FoldWeights();
+
+        uint32_t m_Stride;
+        uint32_t m_Padding;
+        float m_Momentum;
+        float m_Epsilon;
+        int m_BiasIndex = -1;
+
+        // Used as cache between forward and backward steps
+        Tensor m_ConvOutput;
+        Tensor m_ConvOutputGrad;
+        Tensor m_SaveMean;
+        Tensor m_SaveInvVar;
+        // Statistics of the last training batch not blended into running ones yet
+        Tensor m_BatchMean;
+        Tensor m_BatchVar;
+        bool m_RunningStatsPending = false;
+
+        Tensor m_FoldedKernels;
+        Tensor m_FoldedBias;
+        // versions of weights folded kernels and bias were computed from
+        vector<uint64_t> m_FoldedVersions;
+    };
+
+    // Bias can be null
+    static Operation* conv2d_batch_norm(TensorLike* x, TensorLike* kernels, TensorLike* bias, uint32_t stride, uint32_t padding, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar, float momentum, float epsilon, const string& name = "")
+    {
+        return new Conv2dBatchNormalizeOp(x, kernels, bias, stride, padding, gamma, beta, runningMean, runningVar, momentum, epsilon, name);
+    }
+}
@@ -9,6 +9,8 @@ namespace Neuro
     public:
         Conv2dTransposeOp(TensorLike* x, TensorLike* kernels, uint32_t stride, uint32_t padding, EDataFormat dataFormat = NCHW, const string& name = "");
 
+        virtual uint64_t Flops() const override;
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeInternal() override;
@@ -9,6 +9,8 @@ namespace Neuro
     public:
         DropoutOp(TensorLike* x, float prob, const string& name = "");
 
+        virtual bool IsMemoizable(bool training) const override { return !training; }
+
     protected:
         virtual void ComputeInternal() override;
         virtual void ComputeGradientInternal(const Tensor& grad) override;
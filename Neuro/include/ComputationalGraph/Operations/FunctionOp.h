@@ -9,6 +9,9 @@ namespace Neuro
     public:
         FunctionOp(const vector<TensorLike*>& inputs, const vector<TensorLike*>& outputs, const string& name = "");
 
+        // output depends on nodes which are not inputs of this operation
+        virtual bool IsMemoizable(bool training) const override { return false; }
+
     protected:
         virtual void ComputeInternal() override;
         virtual void ComputeGradientInternal(const Tensor& grad) override;
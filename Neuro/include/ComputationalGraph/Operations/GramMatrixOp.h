@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ComputationalGraph/Operation.h"
+
+namespace Neuro
+{
+    // Performs F*F' (scaled) for every batch where F is input feature map viewed as depth x (width * height) matrix.
+    // Input is read in place (no reshape is needed) and only one triangle of symmetric output is computed.
+    class GramMatrixOp : public Operation
+    {
+    public:
+        GramMatrixOp(TensorLike* x, float scale = 1.f, const string& name = "");
+
+        virtual uint64_t Flops() const override;
+
+    protected:
+        virtual void UpdateOutputShape() override;
+        virtual void ComputeInternal() override;
+        virtual void ComputeGradientInternal(const Tensor& grad) override;
+
+    private:
+        float m_Scale;
+    };
+
+    static Operation* gram_matrix(TensorLike* x, float scale = 1.f, const string& name = "")
+    {
+        return new GramMatrixOp(x, scale, name);
+    }
+}
@@ -8,6 +8,8 @@ namespace Neuro
     {
     public:
         MatMulOp(TensorLike* a, TensorLike* b, const string& name = "");
+
+        virtual uint64_t Flops() const override;
         
     protected:
         virtual void UpdateOutputShape() override;
@@ -26,6 +28,8 @@ namespace Neuro
     public:
         MatMulTransOp(TensorLike* a, bool transposeA, TensorLike* b, bool transposeB, const string& name = "");
 
+        virtual uint64_t Flops() const override;
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeInternal() override;
@@ -42,6 +46,8 @@ namespace Neuro
     public:
         MatMulSyrkOp(TensorLike* a, bool transpose, const string& name = "");
 
+        virtual uint64_t Flops() const override;
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeInternal() override;
@@ -9,6 +9,13 @@ namespace Neuro
     public:
         Pad2dOp(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, const string& name = "");
 
+        uint32_t Left() const { return m_Left; }
+        uint32_t Right() const { return m_Right; }
+        uint32_t Top() const { return m_Top; }
+        uint32_t Bottom() const { return m_Bottom; }
+        virtual EBorderMode Border() const = 0;
+        virtual float BorderValue() const { return 0; }
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeGradientInternal(const Tensor& grad) override;
@@ -24,6 +31,9 @@ namespace Neuro
     public:
         ConstantPad2dOp(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float value, const string& name = "");
 
+        virtual EBorderMode Border() const override { return ConstantBorder; }
+        virtual float BorderValue() const override { return m_Value; }
+
     protected:
         virtual void ComputeInternal() override;
 
@@ -36,8 +46,26 @@ namespace Neuro
     public:
         ReflectPad2dOp(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, const string& name = "");
 
+        virtual EBorderMode Border() const override { return ReflectBorder; }
+
+    protected:
+        virtual void ComputeInternal() override;
+    };
+
+    // Border ramps linearly from edge pixels (offset by end value) down to zero
+    class LinearRampPad2dOp : public Pad2dOp
+    {
+    public:
+        LinearRampPad2dOp(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float endValue, const string& name = "");
+
+        virtual EBorderMode Border() const override { return LinearRampBorder; }
+        virtual float BorderValue() const override { return m_EndValue; }
+
     protected:
         virtual void ComputeInternal() override;
+
+    private:
+        float m_EndValue;
     };
 
     static Operation* constant_pad2d(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float value, const string& name = "")
@@ -49,4 +77,9 @@ namespace Neuro
     {
         return new ReflectPad2dOp(x, left, right, top, bottom, name);
     }
+
+    static Operation* linear_ramp_pad2d(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float endValue = 0, const string& name = "")
+    {
+        return new LinearRampPad2dOp(x, left, right, top, bottom, endValue, name);
+    }
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ComputationalGraph/Operation.h"
+
+namespace Neuro
+{
+    // Valid convolution of padded input (NCHW only). On CPU border taps are resolved inside the convolution kernel so padded copy
+    // of input is never materialized, on GPU it falls back to padding followed by convolution.
+    // Optional bias and activation are applied in place on the output, same as conv2d_bias_activation.
+    class PaddedConv2dOp : public Operation
+    {
+    public:
+        PaddedConv2dOp(TensorLike* x, TensorLike* kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue = 0, TensorLike* bias = nullptr, EActivation activation = _Identity, float activationAlpha = 0, const string& name = "");
+
+        virtual uint64_t Flops() const override;
+
+    protected:
+        virtual void UpdateOutputShape() override;
+        virtual void ComputeInternal() override;
+        virtual void ComputeGradientInternal(const Tensor& grad) override;
+
+    private:
+        void Pad(const Tensor& x, Tensor& output) const;
+
+        uint32_t m_Stride;
+        uint32_t m_Left;
+        uint32_t m_Right;
+        uint32_t m_Top;
+        uint32_t m_Bottom;
+        EBorderMode m_Border;
+        float m_BorderValue;
+        bool m_UseBias;
+        EActivation m_Activation;
+        float m_ActivationAlpha;
+        Tensor m_Padded; // used only by GPU fallback
+        Tensor m_ActivationInputGrad;
+    };
+
+    static Operation* padded_conv2d(TensorLike* x, TensorLike* kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue = 0, TensorLike* bias = nullptr, EActivation activation = _Identity, float activationAlpha = 0, const string& name = "")
+    {
+        return new PaddedConv2dOp(x, kernels, stride, left, right, top, bottom, border, borderValue, bias, activation, activationAlpha, name);
+    }
+}
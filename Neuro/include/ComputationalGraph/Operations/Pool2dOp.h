@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "ComputationalGraph/Operation.h"
 
 namespace Neuro
@@ -20,6 +22,9 @@ namespace Neuro
         int m_Padding;
         EPoolingMode m_Mode;
         EDataFormat m_DataFormat;
+        // CPU max pooling saves window offset of every maximum so backward pass doesn't have to look for it again
+        vector<uint8_t> m_MaxIndices;
+        bool m_MaxIndicesSaved = false;
     };
 
     static Operation* pool2d(TensorLike* x, uint32_t filterSize, uint32_t stride, uint32_t padding, EPoolingMode mode, EDataFormat dataFormat, const string& name = "")
@@ -35,6 +35,8 @@ namespace Neuro
     public:
         RandomRollOp(TensorLike* x, uint32_t jitterScale = 1, const string& name = "");
 
+        virtual bool IsMemoizable(bool training) const override { return false; }
+
     protected:
         virtual void ComputeInternal() override;
         virtual void ComputeGradientInternal(const Tensor& grad) override;
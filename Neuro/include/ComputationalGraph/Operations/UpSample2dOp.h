@@ -9,6 +9,8 @@ namespace Neuro
     public:
         UpSample2dOp(TensorLike* x, int scaleFactor, const string& name = "");
 
+        int ScaleFactor() const { return m_ScaleFactor; }
+
     protected:
         virtual void UpdateOutputShape() override;
         virtual void ComputeInternal() override;
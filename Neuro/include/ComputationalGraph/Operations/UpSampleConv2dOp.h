@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ComputationalGraph/Operation.h"
+
+namespace Neuro
+{
+    // Convolution of nearest-neighbour upsampled input (NCHW only). On CPU it reads low resolution input directly through
+    // index mapping so upsampled intermediate is never materialized, on GPU it falls back to upsampling followed by convolution.
+    // Optional bias and activation are applied in place on the output, same as conv2d_bias_activation.
+    class UpSampleConv2dOp : public Operation
+    {
+    public:
+        UpSampleConv2dOp(TensorLike* x, TensorLike* kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, TensorLike* bias = nullptr, EActivation activation = _Identity, float activationAlpha = 0, const string& name = "");
+
+        virtual uint64_t Flops() const override;
+
+    protected:
+        virtual void UpdateOutputShape() override;
+        virtual void ComputeInternal() override;
+        virtual void ComputeGradientInternal(const Tensor& grad) override;
+
+    private:
+        uint32_t m_ScaleFactor;
+        uint32_t m_Stride;
+        uint32_t m_Padding;
+        bool m_UseBias;
+        EActivation m_Activation;
+        float m_ActivationAlpha;
+        Tensor m_UpSampled; // used only by GPU fallback
+        Tensor m_ActivationInputGrad;
+    };
+
+    static Operation* upsample_conv2d(TensorLike* x, TensorLike* kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, TensorLike* bias = nullptr, EActivation activation = _Identity, float activationAlpha = 0, const string& name = "")
+    {
+        return new UpSampleConv2dOp(x, kernels, scaleFactor, stride, padding, bias, activation, activationAlpha, name);
+    }
+}
@@ -10,6 +10,7 @@
 #include "ComputationalGraph/Operations/ClipOp.h"
 #include "ComputationalGraph/Operations/ConcatenateOp.h"
 #include "ComputationalGraph/Operations/Conv2dOp.h"
+#include "ComputationalGraph/Operations/Conv2dBatchNormalizeOp.h"
 #include "ComputationalGraph/Operations/Conv2dBiasActivationOp.h"
 #include "ComputationalGraph/Operations/Conv2dTransposeOp.h"
 #include "ComputationalGraph/Operations/DivideOp.h"
@@ -20,6 +21,7 @@
 #include "ComputationalGraph/Operations/ExtractSubTensorOp.h"
 #include "ComputationalGraph/Operations/FuseSubTensorsOp.h"
 #include "ComputationalGraph/Operations/GradientsOp.h"
+#include "ComputationalGraph/Operations/GramMatrixOp.h"
 #include "ComputationalGraph/Operations/IdentityOp.h"
 #include "ComputationalGraph/Operations/InstanceNormalizeOp.h"
 #include "ComputationalGraph/Operations/L2LossOp.h"
@@ -33,6 +35,7 @@
 #include "ComputationalGraph/Operations/NegativeOp.h"
 #include "ComputationalGraph/Operations/NormalizeGradientOp.h"
 #include "ComputationalGraph/Operations/Pad2dOp.h"
+#include "ComputationalGraph/Operations/PaddedConv2dOp.h"
 #include "ComputationalGraph/Operations/PowOp.h"
 #include "ComputationalGraph/Operations/Pool2dOp.h"
 #include "ComputationalGraph/Operations/ReLUOp.h"
@@ -50,4 +53,5 @@
 #include "ComputationalGraph/Operations/TotalVariationOp.h"
 #include "ComputationalGraph/Operations/TransposeOp.h"
 #include "ComputationalGraph/Operations/UpSample2dOp.h"
+#include "ComputationalGraph/Operations/UpSampleConv2dOp.h"
 #include "ComputationalGraph/Operations/VarianceOp.h"
@@ -13,7 +13,9 @@ namespace Neuro
     class Predicter
     {
     public:
-        Predicter(const vector<Placeholder*>& inputPlaceholders, const vector<TensorLike*>& outputOps);
+        // Isolated predicter computes only its own operations and doesn't modify any shared state, so it can be used concurrently
+        // with other isolated predicters as long as they don't share any operations (they can share variables and constants).
+        Predicter(const vector<Placeholder*>& inputPlaceholders, const vector<TensorLike*>& outputOps, bool isolated = false);
 
         tensor_ptr_vec_t Predict(const const_tensor_ptr_vec_t& inputs);
         tensor_ptr_vec_t Eval(const map<Placeholder*, const Tensor*>& feeds);
@@ -22,6 +24,7 @@ namespace Neuro
         vector<Placeholder*> m_InputPlaceholders;
         vector<TensorLike*> m_OutputOps;
         map<Placeholder*, const Tensor*> m_Feeds;
+        bool m_Isolated;
 
         vector<TensorLike*> m_Order;
     };
@@ -1,7 +1,11 @@
 ﻿#pragma once
 
+#include <future>
 #include <vector>
 #include <map>
+#include <string>
+
+#include "Tensors/Tensor.h"
 
 namespace Neuro
 {
@@ -10,9 +14,9 @@ namespace Neuro
     class TensorLike;
     class Operation;
     class Placeholder;
-    class Tensor;
     class Variable;
     class Graph;
+    struct ReplicatedOrder;
 
     class Session
     {
@@ -24,10 +28,32 @@ namespace Neuro
 
         vector<Tensor*> Run(const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds = {});
         vector<Tensor*> RunInOrder(const vector<TensorLike*>& order, const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds, bool training);
+        /// Replicas are computed concurrently, each on its own worker thread
+        vector<Tensor*> RunInOrder(const ReplicatedOrder& order, const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds, bool training);
+        /// Reentrant inference for orders not sharing any computed nodes with orders run concurrently (nodes like variables
+        /// have to be excluded from the order). Global graph state (step, variables initialization, debug step) is not touched.
+        vector<Tensor*> RunIsolated(const vector<TensorLike*>& order, const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds);
+        /// Asynchronous variant of Run. Feeds are staged into one of two per-placeholder buffers before returning, so caller can
+        /// reuse its tensors and prepare next step's feeds while this step is computing. Steps run on background thread in submission
+        /// order and future receives copies of fetched tensors. Synchronous runs have to be preceded by Sync.
+        shared_future<vector<Tensor>> RunAsync(const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds = {});
+        /// Waits until all steps submitted via RunAsync are finished
+        void Sync();
 
         void Clear();
 
+        /// Enables built-in profiler recording forward/backward pass of every operation (see Profiler)
+        void EnableProfiling(bool enable = true);
+        bool IsProfilingEnabled() const;
+        void ClearProfile();
+        void ExportProfileTrace(const string& filename) const;
+        string ProfileSummary() const;
+
     private:
+        void Feed(const map<Placeholder*, const Tensor*>& feeds, bool training);
+        void ComputeNode(TensorLike* node, const vector<TensorLike*>& fetches, bool training);
+        vector<Tensor*> Fetch(const vector<TensorLike*>& fetches) const;
+
         Graph* m_Graph;
 
         struct OrderCacheData
@@ -37,6 +63,16 @@ namespace Neuro
         };
         map<size_t, OrderCacheData> m_OrderCache;
 
+        // double-buffered feeds staging, buffer can be overwritten once step it was staged for is finished
+        struct StagedFeeds
+        {
+            map<Placeholder*, Tensor> feeds;
+            shared_future<vector<Tensor>> step;
+        };
+        StagedFeeds m_Staging[2];
+        uint32_t m_StagingIdx = 0;
+        shared_future<vector<Tensor>> m_LastAsyncStep;
+
         static Session* s_Default;
     };
 }
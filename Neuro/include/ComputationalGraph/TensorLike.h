@@ -29,6 +29,7 @@ namespace Neuro
         const string& Name() const { return m_Name; }
 
         const vector<TensorLike*>& InputNodes() const { return m_InputNodes; }
+        const vector<TensorLike*>& Consumers() const { return m_Consumers; }
 
         Graph* GetGraph() const { return m_Graph; }
 
@@ -59,6 +60,9 @@ namespace Neuro
         bool UndeterminedOutputShape() const { return m_UndeterminedOutputShape; }
         void SetAlwaysOffload(bool enabled) { m_AlwaysOffload = enabled; }
         void SetFetched(bool fetched) { m_Fetched = fetched; }
+        // Checkpoint's output is kept after forward pass when checkpointing is enabled (see Graph::Checkpointing)
+        void SetCheckpoint(bool enabled) { m_Checkpoint = enabled; }
+        bool IsCheckpoint() const { return m_Checkpoint; }
 
         struct metadata
         {
@@ -86,6 +90,9 @@ namespace Neuro
         bool m_UndeterminedOutputShape : 1;
         bool m_AlwaysOffload : 1;
         bool m_Fetched : 1;
+        bool m_Checkpoint : 1;
+        // output was released after forward pass and has to be recomputed before it is used in backward pass
+        bool m_OutputReleased : 1;
 
         friend class Operation;
         friend class Session;
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include "Types.h"
+#include "ComputationalGraph/Graph.h"
+#include "Tensors/Tensor.h"
 
 namespace Neuro
 {
@@ -14,15 +16,25 @@ namespace Neuro
     {
     public:
         Trainer(const vector<Placeholder*>& inputPlaceholders, const vector<Placeholder*>& targetPlaceholders, const vector<TensorLike*>& fetchOps);
+        // Data parallel trainer, each replica has its own input and target placeholders and fetches (nodes computed by that replica
+        // only, like its losses). Every batch is split between replicas as evenly as possible and replicas are computed concurrently.
+        Trainer(const vector<vector<Placeholder*>>& inputPlaceholders, const vector<vector<Placeholder*>>& targetPlaceholders, const vector<vector<TensorLike*>>& replicasFetches, const vector<TensorLike*>& fetchOps);
 
+        // Runs single forward and backward pass. When minimization operation accumulates gradients over N steps, given batch is
+        // treated as a micro-batch and weights are updated on every N-th call only (see ModelBase::TrainOnBatch for splitting).
         tensor_ptr_vec_t Train(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs);
 
     private:
-        vector<Placeholder*> m_InputPlaceholders;
-        vector<Placeholder*> m_TargetPlaceholders;
+        void FeedReplicas(const vector<vector<Placeholder*>>& placeholders, const const_tensor_ptr_vec_t& tensors, vector<vector<Tensor>>& shards);
+
+        vector<vector<Placeholder*>> m_InputPlaceholders;
+        vector<vector<Placeholder*>> m_TargetPlaceholders;
         vector<TensorLike*> m_FetchOps;
         map<Placeholder*, const Tensor*> m_Feeds;
 
         vector<TensorLike*> m_Order;
+        ReplicatedOrder m_ReplicatedOrder;
+        vector<vector<Tensor>> m_InputShards;
+        vector<vector<Tensor>> m_TargetShards;
     };
 }
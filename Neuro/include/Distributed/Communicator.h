@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Neuro
+{
+    /// Collective communication between processes participating in distributed training. All processes have to call
+    /// collective operations in the same order.
+    class Communicator
+    {
+    public:
+        virtual ~Communicator() {}
+
+        uint32_t Rank() const { return m_Rank; }
+        uint32_t WorldSize() const { return m_WorldSize; }
+
+        /// Replaces data in every process with element-wise sum of data from all processes
+        virtual void AllReduceSum(float* data, size_t count) = 0;
+        /// Replaces data in every process with data from root process
+        virtual void Broadcast(float* data, size_t count, uint32_t root = 0) = 0;
+        virtual void Barrier() = 0;
+
+    protected:
+        Communicator(uint32_t rank, uint32_t worldSize) : m_Rank(rank), m_WorldSize(worldSize) {}
+
+        uint32_t m_Rank;
+        uint32_t m_WorldSize;
+    };
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <future>
+#include <vector>
+
+namespace Neuro
+{
+    using namespace std;
+
+    class Communicator;
+    class Variable;
+
+    /// Averages variables' gradients across processes. Gradients are grouped into buckets as they become ready during
+    /// backward pass, full bucket is all-reduced on a background thread while backward pass carries on.
+    class GradientsAllReducer
+    {
+    public:
+        GradientsAllReducer(Communicator* communicator, size_t bucketSizeInBytes = 25 * 1024 * 1024);
+        ~GradientsAllReducer();
+
+        Communicator* GetCommunicator() const { return m_Communicator; }
+
+        /// Share of the step's samples processed by this process, gradients are scaled by it before being summed so the result
+        /// is a sample weighted average. By default every process has equal share (1 / world size).
+        void LocalWeight(float weight) { m_LocalWeight = weight; }
+
+        /// Has to be called for variables in the same order in all processes
+        void GradientReady(Variable* var);
+        /// Reduces remaining gradients and waits for all buckets, afterwards every ready variable's gradient is a weighted average across processes
+        void Finish();
+
+    private:
+        struct Bucket
+        {
+            vector<Variable*> vars;
+            vector<float> data;
+        };
+
+        void Flush();
+
+        Communicator* m_Communicator;
+        size_t m_BucketSize;
+        float m_LocalWeight = -1;
+        vector<Bucket*> m_Buckets;
+        Bucket* m_Current = nullptr;
+        shared_future<void> m_Pending;
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Distributed/Communicator.h"
+
+namespace Neuro
+{
+    using namespace std;
+
+    /// Communicator connecting processes in a ring over TCP, every process is connected to its next and previous neighbour.
+    /// All-reduce is bandwidth optimal ring algorithm (reduce-scatter followed by all-gather), each process sends and receives
+    /// 2 * (N - 1) / N of data regardless of number of processes.
+    class TcpRingCommunicator : public Communicator
+    {
+    public:
+        /// Addresses are in "host:port" format, one per rank. Process listens on the port from its own address.
+        /// Throws runtime_error when connection can't be established within timeout, communication failures throw as well.
+        TcpRingCommunicator(uint32_t rank, const vector<string>& addresses, uint32_t connectTimeoutMs = 60000);
+        ~TcpRingCommunicator();
+
+        /// Creates communicator based on environment variables set by LaunchLocal: NEURO_RANK, NEURO_WORLD_SIZE and either
+        /// NEURO_ADDRESSES (comma separated list of "host:port" per rank) or NEURO_MASTER_ADDR (default 127.0.0.1) and
+        /// NEURO_MASTER_PORT (default 29500) in which case rank R uses consecutive port NEURO_MASTER_PORT + R.
+        /// Returns null when NEURO_WORLD_SIZE is not set.
+        static TcpRingCommunicator* FromEnvironment();
+
+        /// Starts given command line in world size local processes with environment set for FromEnvironment, waits for all
+        /// of them to finish and returns their exit codes. Throws runtime_error when a process can't be started.
+        static vector<int> LaunchLocal(const string& commandLine, uint32_t worldSize, uint16_t basePort = 29500);
+
+        virtual void AllReduceSum(float* data, size_t count) override;
+        virtual void Broadcast(float* data, size_t count, uint32_t root = 0) override;
+        virtual void Barrier() override;
+
+    private:
+        void SendAll(const void* data, size_t size);
+        void ReceiveAll(void* data, size_t size);
+        // send to next and receive from previous process at the same time, so neighbours can't block each other
+        void SendReceive(const float* sendData, size_t sendCount, float* recvData, size_t recvCount);
+
+        uintptr_t m_NextSocket;
+        uintptr_t m_PrevSocket;
+        vector<float> m_RecvBuffer;
+    };
+}
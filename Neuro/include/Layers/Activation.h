@@ -11,6 +11,8 @@ namespace Neuro
         // This constructor should only be used for input layer
         Activation(const Shape& inputShape, ActivationBase* activation, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         Activation();
 
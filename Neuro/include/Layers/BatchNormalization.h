@@ -22,6 +22,9 @@ namespace Neuro
 
         virtual void SetTrainable(bool trainable) override;
 
+        // inference uses running statistics only
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         BatchNormalization(const string& constructorName, const Shape& inputShape, const string& name = "");
 
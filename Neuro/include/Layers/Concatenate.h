@@ -10,6 +10,8 @@ namespace Neuro
         // Make sure to link this layer to input when using this constructor.
         Concatenate(EAxis axis, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return m_Axis == DepthAxis; }
+
     protected:
         Concatenate() {}
 
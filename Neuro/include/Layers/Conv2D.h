@@ -27,6 +27,10 @@ namespace Neuro
         Conv2D* BiasInitializer(InitializerBase* initializer);
         Conv2D* UseBias(bool useBias);
 
+        virtual uint32_t SpatialKernelSize() const override { return m_FilterSize; }
+        virtual float SpatialStride() const override { return (float)m_Stride; }
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
 	protected:
         Conv2D() {}
 
@@ -26,6 +26,10 @@ namespace Neuro
         Conv2DTranspose* BiasInitializer(InitializerBase* initializer);
         Conv2DTranspose* UseBias(bool useBias);
 
+        virtual uint32_t SpatialKernelSize() const override { return (uint32_t)m_FilterSize; }
+        virtual float SpatialStride() const override { return 1.f / m_Stride; }
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         Conv2DTranspose() {}
 
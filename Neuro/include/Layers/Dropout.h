@@ -11,6 +11,8 @@ namespace Neuro
         // This constructor should only be used for input layer
         Dropout(const Shape& inputShape, float p, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         Dropout() {}
 
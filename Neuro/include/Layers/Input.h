@@ -13,6 +13,8 @@ namespace Neuro
         Input(const Shape& inputShape, const string& name = "");
         Input(TensorLike* input, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
 	protected:
         Input();
 
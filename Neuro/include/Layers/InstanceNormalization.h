@@ -12,6 +12,10 @@ namespace Neuro
         // This constructor should only be used for input layer
         InstanceNormalization(const Shape& inputShape, const string& name = "");
 
+        // Statistics are computed per image so in tiled execution they can only be approximated by per tile statistics
+        virtual bool IsSpatiallyLocal() const override { return false; }
+        virtual bool SupportsApproximateTiling() const override { return true; }
+
     protected:
         virtual void Build(const vector<Shape>& inputShapes) override;
         virtual vector<TensorLike*> InternalCall(const vector<TensorLike*>& inputs) override;
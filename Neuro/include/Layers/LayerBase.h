@@ -57,6 +57,16 @@ namespace Neuro
         //virtual Shape ComputeOutputShape(const vector<Shape>& inputShapes) = 0;
         virtual bool CheckInputCompatibility(const vector<TensorLike*>& inputNodes) { return true; }
 
+        // Spatial window of input pixels contributing to a single output pixel, it is used to compute receptive field for tiled execution
+        virtual uint32_t SpatialKernelSize() const { return 1; }
+        // Distance between neighbouring output pixels expressed in input pixels (stride, or inverse of upsampling factor)
+        virtual float SpatialStride() const { return 1; }
+        // Only layers whose output pixels depend on a bounded neighbourhood of input pixels (convolutions, pooling, element-wise
+        // layers) can be executed in tiles, layers have to opt in as tiling layers depending on the whole input gives wrong results
+        virtual bool IsSpatiallyLocal() const { return false; }
+        // Layers depending on per image statistics (like instance normalization) can be executed in tiles only approximately
+        virtual bool SupportsApproximateTiling() const { return IsSpatiallyLocal(); }
+
         const vector<TensorLike*>& Call(TensorLike* input, const string& name = "");
         const vector<TensorLike*>& Call(const vector<TensorLike*>& inputs, const string& name = "");
         const vector<TensorLike*>& operator()(const vector<TensorLike*>& inputs, const string& name = "");
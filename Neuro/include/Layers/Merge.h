@@ -11,6 +11,8 @@ namespace Neuro
         // This constructor should only be used for input layer
         Merge(const Shape& inputsShape, EMergeMode mergeMode, ActivationBase* activation = nullptr, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         Merge() {}
 
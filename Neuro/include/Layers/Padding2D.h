@@ -9,6 +9,8 @@ namespace Neuro
     public:
         Padding2D(uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         Padding2D(const string& constructorName, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, const string& name = "");
 
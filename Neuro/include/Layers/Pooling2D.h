@@ -12,6 +12,10 @@ namespace Neuro
         // Use this constructor for input layer only!
         Pooling2D(Shape inputShape, uint32_t filterSize, uint32_t stride = 1, uint32_t padding = 0, EPoolingMode mode = MaxPool, EDataFormat dataFormat = NCHW, const string& name = "");
 
+        virtual uint32_t SpatialKernelSize() const override { return (uint32_t)m_FilterSize; }
+        virtual float SpatialStride() const override { return (float)m_Stride; }
+        virtual bool IsSpatiallyLocal() const override { return true; }
+
     protected:
         Pooling2D(const string& constructorName, Shape inputShape, uint32_t filterSize, uint32_t stride, uint32_t padding, EPoolingMode mode, EDataFormat dataFormat, const string& name);
         Pooling2D(const string& constructorName, uint32_t filterSize, uint32_t stride, uint32_t padding, EPoolingMode mode, EDataFormat dataFormat, const string& name);
@@ -11,6 +11,9 @@ namespace Neuro
         // Use this constructor for input layer only!
         UpSampling2D(const Shape& inputShape, uint32_t scaleFactor, const string& name = "");
 
+        virtual bool IsSpatiallyLocal() const override { return true; }
+        virtual float SpatialStride() const override { return 1.f / m_ScaleFactor; }
+
     protected:
         UpSampling2D() {}
 
@@ -84,6 +84,11 @@ namespace Neuro
         EMemStatus DumpMemoryState(FILE* file) const;
         void UpdateAnnotation(void* ptr, const string& annotation);
 
+        size_t AllocatedMemSize() const { return m_AllocatedMemSize; }
+        size_t AllocatedMemPeakSize() const { return m_AllocatedMemPeakSize; }
+        /// Sets peak to currently allocated size so peak usage of specific workload can be measured
+        void ResetPeak() { m_AllocatedMemPeakSize = m_AllocatedMemSize; }
+
         EMemStatus ReleaseAll();
 
     protected:
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Tensors/Tensor.h"
+
+namespace Neuro
+{
+    using namespace std;
+
+    class ModelBase;
+
+    // Inference frontend coalescing single-sample requests coming from multiple threads into batches. Worker thread waits until
+    // either max batch size requests are queued or the oldest request waited for max delay, then it runs single prediction for
+    // the whole batch and scatters per-sample results back through futures. Model mustn't be used by other threads meanwhile.
+    class BatchingServer
+    {
+    public:
+        struct Stats
+        {
+            uint64_t requests = 0;
+            uint64_t batches = 0;
+            double avgBatchSize = 0;
+            double avgQueueUs = 0; // time between enqueuing request and start of its batch computation
+            double maxQueueUs = 0;
+            double avgComputeUs = 0; // per batch, includes gathering inputs and scattering outputs
+        };
+
+        BatchingServer(ModelBase* model, uint32_t maxBatchSize = 32, uint32_t maxDelayUs = 1000);
+        // Requests queued at the time of destruction are still processed
+        ~BatchingServer();
+
+        // Expects single-sample tensor per model input, inputs are copied so they don't have to outlive the call.
+        // Future receives single-sample tensor per model output. Request with mismatched number of inputs or input shapes
+        // fails immediately with invalid_argument, exception thrown by prediction fails all requests in its batch.
+        future<vector<Tensor>> Enqueue(const const_tensor_ptr_vec_t& inputs);
+        future<vector<Tensor>> Enqueue(const Tensor& input);
+
+        Stats GetStats() const;
+        void ResetStats();
+
+        uint32_t MaxBatchSize() const { return m_MaxBatchSize; }
+        uint32_t MaxDelayUs() const { return m_MaxDelayUs; }
+
+    private:
+        struct Request
+        {
+            vector<Tensor> inputs;
+            promise<vector<Tensor>> result;
+            chrono::steady_clock::time_point enqueueTime;
+        };
+
+        void WorkerLoop();
+        void RunBatch(vector<Request>& batch);
+
+        ModelBase* m_Model;
+        vector<Shape> m_InputShapes;
+        uint32_t m_MaxBatchSize;
+        uint32_t m_MaxDelayUs;
+        vector<Tensor> m_BatchInputs;
+
+        deque<Request> m_Queue;
+        mutex m_QueueMtx;
+        condition_variable m_QueueCond;
+        bool m_Stop = false;
+        thread m_Worker;
+
+        mutable mutex m_StatsMtx;
+        uint64_t m_Requests = 0;
+        uint64_t m_Batches = 0;
+        double m_TotalQueueUs = 0;
+        double m_MaxQueueUs = 0;
+        double m_TotalComputeUs = 0;
+    };
+}
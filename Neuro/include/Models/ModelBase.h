@@ -16,6 +16,8 @@ namespace Neuro
 	class Tensor;
     class LossBase;
     class OptimizerBase;
+    class MinimizationOperationBase;
+    class Communicator;
     class Trainer;
     class Predicter;
     class Placeholder;
@@ -28,16 +30,31 @@ namespace Neuro
         void Optimize(OptimizerBase* optimizer, LossBase* loss, const vector<float>& lossWeights = {}, int metrics = Loss);
         void Optimize(OptimizerBase* optimizer, const vector<LossBase*>& losses, const vector<float>& lossWeights = {}, int metrics = Loss);
         void Optimize(OptimizerBase* optimizer, map<string, LossBase*> lossDict, const vector<float>& lossWeights = {}, int metrics = Loss);
-
-        void Fit(const Tensor& input, const Tensor& output, int batchSize = -1, uint32_t epochs = 1, const Tensor* validInputs = nullptr, const Tensor* validOutputs = nullptr, uint32_t verbose = 1, bool shuffle = true);
+        // Number of model replicas (sharing parameters) trained concurrently on separate worker threads, every batch is split
+        // evenly between replicas and their gradients are summed before single optimizer step. It has to be set before Optimize.
+        void DataParallel(uint32_t replicas) { m_Replicas = replicas; }
+        // Enables training distributed across processes. Every process trains on its part of each batch (batches are shuffled
+        // identically in all processes), gradients are averaged across processes (weighted by number of samples in each part)
+        // and parameters are synchronized with rank 0 process at the beginning of Fit. Last batch smaller than number of processes
+        // is merged into the previous one. Every process should call Fit with the same data.
+        void Distributed(Communicator* communicator, size_t bucketSizeInBytes = 25 * 1024 * 1024);
+
+        void Fit(const Tensor& input, const Tensor& output, int batchSize = -1, uint32_t epochs = 1, const Tensor* validInputs = nullptr, const Tensor* validOutputs = nullptr, uint32_t verbose = 1, bool shuffle = true, uint32_t accumulationSteps = 1);
         // Training method, when batch size is -1 the whole training set is used for single gradient descent step (in other words, batch size equals to training set size)
-        void Fit(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, int batchSize = -1, uint32_t epochs = 1, const const_tensor_ptr_vec_t* validInputs = nullptr, const const_tensor_ptr_vec_t* validOutputs = nullptr, uint32_t verbose = 1, bool shuffle = true);
+        // Accumulation steps greater than 1 splits each batch into that many micro-batches, gradients are summed across micro-batches
+        // and single optimizer step is made per batch (batch size remains effective batch size while peak memory is that of micro-batch).
+        void Fit(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, int batchSize = -1, uint32_t epochs = 1, const const_tensor_ptr_vec_t* validInputs = nullptr, const const_tensor_ptr_vec_t* validOutputs = nullptr, uint32_t verbose = 1, bool shuffle = true, uint32_t accumulationSteps = 1);
 
-        tuple<float, float> TrainOnBatch(const Tensor& input, const Tensor& output);
-        tuple<float, float> TrainOnBatch(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs);
+        tuple<float, float> TrainOnBatch(const Tensor& input, const Tensor& output, uint32_t accumulationSteps = 1);
+        // Makes single optimizer step on given batch, accumulation steps work the same way as in Fit
+        tuple<float, float> TrainOnBatch(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, uint32_t accumulationSteps = 1);
 
         tensor_ptr_vec_t Predict(const const_tensor_ptr_vec_t& inputs);
         tensor_ptr_vec_t Predict(const Tensor& input);
+        // Creates independent inference context sharing model's weights, it owns its activations and execution order so
+        // different contexts can predict concurrently from different threads. Contexts have to be created upfront from single
+        // thread and weights mustn't change while predicting. Only CPU modes are supported. Caller takes ownership.
+        Predicter* CreatePredicter();
 
         tensor_ptr_vec_t Eval(const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds);
 
@@ -51,6 +68,9 @@ namespace Neuro
         virtual void Parameters(vector<Variable*>& params, bool onlyTrainable = true) const override;
 
         virtual void SetTrainable(bool trainable) override;
+        /// Sets host storage data type for activations and non-trainable weights (trainable weights always remain in fp32).
+        /// It reduces memory held between computations, computations themselves still run on fp32 copies.
+        void SetDataType(EDataType type);
         void ForceLearningPhase(bool force) { m_ForceLearningPhase = force; }
 
         string Summary() const;
@@ -92,19 +112,28 @@ namespace Neuro
         void MapGraphNetwork(const vector<TensorLike*>& inputs, const vector<TensorLike*>& outputs);
         void ProcessLayer(LayerBase* layer, unordered_set<LayerBase*>& visited);
 
+        void BuildLoss(const vector<TensorLike*>& outputs, const vector<LossBase*>& lossFuncs, const vector<float>& lossWeights, int metrics, vector<Placeholder*>& targets, vector<TensorLike*>& losses, TensorLike*& totalLoss, TensorLike*& totalAcc);
+
         // This is vectorized gradient descent
         void TrainStep(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, float* trainError = nullptr, float* trainAcc = nullptr);
+        // Splits batch made of given samples into micro-batches and makes single optimizer step after gradients of all of them are accumulated
+        void TrainStepAccumulated(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, const vector<uint32_t>& batchIndices, uint32_t accumulationSteps, float* trainError = nullptr, float* trainAcc = nullptr);
 
         // Build a single tensor with multiple batches for each input
         const_tensor_ptr_vec_t GenerateBatch(const const_tensor_ptr_vec_t& inputs, const vector<uint32_t>& batchIndices);
 
         OptimizerBase* m_Optimizer = nullptr;
+        MinimizationOperationBase* m_Minimization = nullptr;
+        uint32_t m_Replicas = 1;
+        Communicator* m_Communicator = nullptr;
+        size_t m_BucketSize = 0;
         vector<accuracy_func_t> m_AccuracyFuncs;
         bool m_ForceLearningPhase = false;
 
         Trainer* m_Trainer = nullptr;
         Predicter* m_Predicter = nullptr;
         map<size_t, Predicter*> m_EvalPredicters;
+        uint32_t m_PredictersNum = 0;
 
         map<EMetric, pair<TensorLike*, size_t>> m_Metrics;
         int m_TrackedMetrics;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "Tensors/Tensor.h"
+
+namespace Neuro
+{
+    using namespace std;
+
+    class ModelBase;
+    class LayerBase;
+
+    // Runs inference of fully-convolutional model (convolutions, pooling, upsampling, normalizations and element-wise layers)
+    // on images of arbitrary size. Model's input width and height define the tile size. Input is split into overlapping tiles
+    // extended by receptive field halo so after cropping halo the results can be stitched without seams. Tiles are computed in
+    // batches which size is limited by memory budget, computation within a batch is spread across all cores by tensor ops.
+    class TiledExecutor
+    {
+    public:
+        // Memory budget is an upper bound for activations of a single batch of tiles in bytes, halo override allows using
+        // smaller halo than computed one (for models with huge receptive fields like U-Net) at the cost of visible seams.
+        // Approximate mode allows layers depending on per image statistics (instance normalization), those are computed per
+        // tile instead so output differs from full image inference and can have visible seams as well.
+        TiledExecutor(ModelBase* model, size_t memoryBudget = 1024 * 1024 * 1024, int haloOverride = -1, bool approximate = false);
+
+        // Input can contain multiple images in batch
+        Tensor Predict(const Tensor& input);
+
+        uint32_t Halo() const { return m_Halo; }
+        // Tile offsets have to be multiple of total downsampling factor so strided layers sample the same pixels
+        uint32_t Alignment() const { return m_Alignment; }
+        uint32_t TilesPerBatch() const { return m_TilesPerBatch; }
+
+    private:
+        // Input jump is the distance between neighbouring pixels of inputs to given layers expressed in model input pixels,
+        // output jumps are collected per analyzed layer
+        void AnalyzeLayers(const vector<LayerBase*>& layers, float inputJump, float& halo, size_t& activationsSize, map<const LayerBase*, float>& outputJumps);
+
+        ModelBase* m_Model;
+        Shape m_TileShape;
+        Shape m_TileOutputShape;
+        uint32_t m_Halo = 0;
+        uint32_t m_Alignment = 1;
+        uint32_t m_TilesPerBatch = 1;
+        bool m_Approximate = false;
+    };
+}
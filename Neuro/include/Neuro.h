@@ -6,6 +6,7 @@
 #include "Random.h"
 #include "Tools.h"
 #include "Stopwatch.h"
+#include "Profiler.h"
 
 #include "Layers/LayerBase.h"
 #include "Layers/Activation.h"
@@ -28,12 +29,18 @@
 #include "Models/ModelBase.h"
 #include "Models/Sequential.h"
 #include "Models/Flow.h"
+#include "Models/TiledExecutor.h"
+#include "Models/BatchingServer.h"
 
 #include "Optimizers/OptimizerBase.h"
 #include "Optimizers/Adam.h"
 #include "Optimizers/SGD.h"
 #include "Optimizers/LBFGS.h"
 
+#include "Distributed/Communicator.h"
+#include "Distributed/TcpRingCommunicator.h"
+#include "Distributed/GradientsAllReducer.h"
+
 #include "Initializers/InitializerBase.h"
 #include "Initializers/Const.h"
 #include "Initializers/GlorotNormal.h"
@@ -46,12 +53,15 @@
 
 #include "Tensors/Shape.h"
 #include "Tensors/Tensor.h"
+#include "Tensors/HalfFloat.h"
+#include "Tensors/FastMath.h"
 
 #include "ComputationalGraph/TensorLike.h"
 #include "ComputationalGraph/Operation.h"
 #include "ComputationalGraph/Graph.h"
 #include "ComputationalGraph/Placeholder.h"
 #include "ComputationalGraph/Session.h"
+#include "ComputationalGraph/Predicter.h"
 #include "ComputationalGraph/Variable.h"
 #include "ComputationalGraph/Constant.h"
 #include "ComputationalGraph/NameScope.h"
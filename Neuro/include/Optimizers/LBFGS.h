@@ -65,6 +65,8 @@ namespace Neuro
         public:
             MinimizationOperation(const vector<TensorLike*>& losses, const vector<Variable*>& vars, size_t maxIterations, float epsilon);
 
+            virtual bool IsMemoizable(bool training) const override { return false; }
+
         protected:
             virtual void ComputeInternal();
             virtual void ComputeGradientInternal(const Tensor& grad) {}
@@ -2,10 +2,16 @@
 
 #include <vector>
 #include <string>
+#include <unordered_set>
+
 #include "ComputationalGraph/Operation.h"
+#include "ComputationalGraph/Graph.h"
 
 namespace Neuro
 {
+    class Communicator;
+    class GradientsAllReducer;
+
 	using namespace std;
 
     class Variable;
@@ -20,4 +26,53 @@ namespace Neuro
         virtual Operation* Minimize(const vector<TensorLike*>& losses, const vector<Variable*>& vars = {}, Variable* globalStep = nullptr) = 0;
         //virtual Operation* Maximize(const vector<TensorLike*>& losses) = 0;
 	};
+
+    // Base for minimization operations of first order optimizers. Variables' gradients can be accumulated over multiple
+    // consecutive computations (micro-batches), in which case update is applied only on every N-th computation.
+    class MinimizationOperationBase : public Operation
+    {
+    public:
+        ~MinimizationOperationBase();
+
+        virtual bool IsTrainingOp() const override { return true; }
+        virtual void Reset() override;
+
+        void AccumulationSteps(uint32_t steps);
+        uint32_t AccumulationSteps() const { return m_AccumulationSteps; }
+        // Gradient of each micro-batch is scaled by its weight before accumulation, it should be micro-batch size divided by
+        // effective batch size so accumulated gradient of mean loss is the same as if the whole batch was computed at once.
+        // By default it is 1 / accumulation steps.
+        void MicroBatchWeight(float weight) { m_MicroBatchWeight = weight; }
+        // Losses of data parallel replicas (sub-graphs sharing variables), gradients of each replica are computed on
+        // separate thread and gradients of shared variables are reduced once all replicas are done.
+        void Replicas(const vector<TensorLike*>& replicasLosses);
+        // Enables distributed training, gradients are averaged across all processes before variables are updated. All-reduce
+        // of gradients in buckets of given size overlaps with backward pass.
+        void Distribute(Communicator* communicator, size_t bucketSizeInBytes = 25 * 1024 * 1024);
+        // Share of the batch's samples processed by this process, processes' gradients are weighted by it when averaged.
+        // By default all processes have equal shares.
+        void DistributedWeight(float weight);
+
+    protected:
+        MinimizationOperationBase(const vector<TensorLike*>& losses, const vector<TensorLike*>& extraInputs, const vector<Variable*>& vars, const string& name);
+
+        virtual void UpdateOutputShape() override {}
+        virtual void ComputeGradientInternal(const Tensor& grad) override {}
+
+        // Computes gradients and returns variables which should be updated using their output gradients,
+        // when accumulating the list is empty until the last micro-batch
+        vector<Variable*> ComputeGradients();
+
+        vector<Variable*> m_Vars;
+        vector<TensorLike*> m_Order;
+        unordered_set<TensorLike*> m_NodesAffectingLosses;
+        ReplicatedOrder m_ReplicatedOrder;
+
+    private:
+        uint32_t m_AccumulationSteps = 1;
+        uint32_t m_AccumulatedSteps = 0;
+        float m_MicroBatchWeight = -1;
+        vector<Tensor> m_AccumulatedGradients;
+        GradientsAllReducer* m_AllReducer = nullptr;
+    };
 }
@@ -1,7 +1,5 @@
 ﻿#pragma once
 
-#include <unordered_set>
-
 #include "Optimizers/OptimizerBase.h"
 
 namespace Neuro
@@ -16,21 +14,15 @@ namespace Neuro
 
         virtual Operation* Minimize(const vector<TensorLike*>& losses, const vector<Variable*>& vars = {}, Variable* globalStep = nullptr) override { return new MinimizationOperation(losses, vars, m_LearningRate); }
 
-        class MinimizationOperation : public Operation
+        class MinimizationOperation : public MinimizationOperationBase
         {
         public:
             MinimizationOperation(const vector<TensorLike*>& losses, const vector<Variable*>& vars, float lr);
-            virtual bool IsTrainingOp() const override { return true; }
         protected:
-            virtual void UpdateOutputShape() override {}
             virtual void ComputeInternal() override;
-            virtual void ComputeGradientInternal(const Tensor& grad) override {}
 
         private:
             float m_LearningRate;
-            vector<Variable*> m_Vars;
-            vector<TensorLike*> m_Order;
-            unordered_set<TensorLike*> m_NodesAffectingLosses;
         };
 
     private:
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Neuro
+{
+    using namespace std;
+
+    class Operation;
+
+    struct ProfileEvent
+    {
+        string name;
+        string type; // operation type, empty for generic scopes
+        const char* category; // always points to static string
+        int64_t startUs; // relative to profiler epoch
+        int64_t durationUs;
+        uint32_t threadId;
+        size_t bytesAllocated; // bytes allocated by memory managers within event scope
+        uint64_t flops;
+    };
+
+    /// Built-in low overhead profiler recording operations forward/backward passes and all NVTXProfile scopes.
+    /// Each thread records into its own buffer so no locking is involved while recording. Exporting and clearing
+    /// has to be done when no computations are running.
+    class Profiler
+    {
+    public:
+        static void Enable(bool enable = true);
+        static bool IsEnabled() { return s_Enabled.load(memory_order_relaxed); }
+        static void Clear();
+
+        static int64_t NowUs();
+        static void Record(const string& name, const string& type, const char* category, int64_t startUs, size_t bytesAllocated, uint64_t flops);
+        static void RecordAllocation(size_t size);
+        static size_t ThreadAllocatedBytes();
+
+        /// Writes events in Chrome trace event format (can be viewed in chrome://tracing or Perfetto)
+        static void ExportChromeTrace(const string& filename);
+        /// Returns table with total/average time, bytes allocated and GFLOP/s aggregated per operation type and pass
+        static string Summary();
+
+        static vector<ProfileEvent> CollectEvents();
+
+    private:
+        // checked by every recording thread while profiling can be toggled from another one
+        static atomic<bool> s_Enabled;
+    };
+
+    /// Records single operation forward or backward pass when profiler is enabled.
+    class OpProfile
+    {
+    public:
+        OpProfile(const Operation* op, bool backward);
+        ~OpProfile();
+
+    private:
+        const Operation* m_Op = nullptr;
+        bool m_Backward;
+        int64_t m_StartUs;
+        size_t m_StartBytes;
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <random>
+#include <atomic>
+#include <cstdint>
 
 namespace Neuro
 {
@@ -21,4 +23,33 @@ namespace Neuro
 		mt19937 m_Engine;
         int m_GeneratedNumbersCount = 0;
 	};
+
+    /// Counter-based Philox4x32-10 generator (Salmon et al. "Parallel random numbers: as easy as 1, 2, 3").
+    /// Every block of 4 numbers is a pure function of key (seed), block index and stream index, so any part of
+    /// the sequence can be generated independently. Bulk fills are split between threads and produce the same
+    /// values regardless of number of threads used. Reserving part of the sequence is lock-free so generator
+    /// can be shared between threads.
+    class Philox
+    {
+    public:
+        Philox(uint64_t seed = 0);
+
+        void Seed(uint64_t seed);
+        /// Reserves blocks for given number of values and returns index of first reserved block
+        uint64_t Reserve(size_t count);
+
+        void FillUniform(float* dest, size_t count, float min = 0.f, float max = 1.f);
+        /// Follows Normal::NextSingle convention where result is (stdDeviation^2 * N(0,1) + mean) * scale.
+        /// When truncated, values whose magnitude is more than two standard deviations from the mean are re-picked.
+        void FillNormal(float* dest, size_t count, float mean, float stdDeviation, float scale = 1.f, bool truncated = false);
+        /// Fills with 0 for values dropped with given probability, otherwise with 1/prob (dropout mask)
+        void FillDropoutMask(float* dest, size_t count, float prob);
+
+        static void Generate(uint64_t key, uint64_t block, uint64_t stream, uint32_t out[4]);
+        static float ToUniform(uint32_t x) { return (x >> 8) * (1.f / 16777216.f); } // [0, 1)
+
+    private:
+        uint64_t m_Key;
+        atomic<uint64_t> m_NextBlock;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Neuro
+{
+    // Vectorized element-wise transcendental functions and activations operating on raw float arrays. Every kernel is
+    // written once against a lane abstraction and instantiated for AVX-512, AVX2+FMA and plain scalar code, widest
+    // instruction set supported by the CPU is picked at runtime. Large arrays are split into blocks processed in parallel.
+    //
+    // Exp and log use Cephes-style minimax polynomials after range reduction, tanh uses odd minimax polynomial for
+    // |x| < 0.625 and exp based formula otherwise. Maximum errors measured on every third float against double precision
+    // reference (the same for all instruction sets):
+    //   exp      1 ulp (including subnormal results)
+    //   log      1 ulp
+    //   tanh     1 ulp
+    //   sigmoid  3 ulp (for x < -87.3 result is subnormal and may flush to zero)
+    // Special values follow the standard library (NaN propagates, exp(inf) = inf, log(0) = -inf, log(x < 0) = NaN).
+    // Gradients are computed from activation outputs in a single pass, there is no need to re-evaluate exponent.
+
+    void FastExp(const float* input, size_t count, float* output);
+    void FastLog(const float* input, size_t count, float* output);
+    void FastSigmoid(const float* input, size_t count, float* output);
+    void FastSigmoidGradient(const float* output, const float* outputGradient, size_t count, float* inputGradient);
+    void FastTanh(const float* input, size_t count, float* output);
+    void FastTanhGradient(const float* output, const float* outputGradient, size_t count, float* inputGradient);
+    void FastElu(const float* input, size_t count, float alpha, float* output);
+    void FastEluGradient(const float* output, const float* outputGradient, size_t count, float alpha, float* inputGradient);
+    void FastLeakyReLU(const float* input, size_t count, float alpha, float* output);
+    void FastLeakyReLUGradient(const float* output, const float* outputGradient, size_t count, float alpha, float* inputGradient);
+
+    // Disabling SIMD forces scalar fallback (mostly useful for testing and benchmarking)
+    void EnableFastMathSimd(bool enable);
+    // Name of instruction set currently used by kernels ("avx512", "avx2" or "scalar")
+    const char* FastMathIsa();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "Types.h"
+
+namespace Neuro
+{
+    // Conversions between fp32 and 16-bit storage formats. Both directions use round-to-nearest-even,
+    // NaNs stay NaNs and fp16 values out of range saturate to infinity.
+
+    //////////////////////////////////////////////////////////////////////////
+    inline uint16_t FloatToBf16(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        if ((bits & 0x7FFFFFFF) > 0x7F800000)
+            return (uint16_t)((bits >> 16) | 0x0040); // keep it quiet NaN
+        bits += 0x7FFF + ((bits >> 16) & 1);
+        return (uint16_t)(bits >> 16);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    inline float Bf16ToFloat(uint16_t value)
+    {
+        uint32_t bits = (uint32_t)value << 16;
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    inline uint16_t FloatToFp16(float value)
+    {
+        uint32_t x;
+        memcpy(&x, &value, sizeof(x));
+        uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+        x &= 0x7FFFFFFF;
+
+        if (x >= 0x7F800000) // inf or NaN
+            return sign | (x > 0x7F800000 ? 0x7E00 : 0x7C00);
+        if (x >= 0x477FF000) // rounds to value above 65504
+            return sign | 0x7C00;
+
+        if (x < 0x38800000) // below smallest normal half, result is subnormal or zero
+        {
+            if (x < 0x33000000)
+                return sign;
+
+            uint32_t e = x >> 23;
+            uint32_t m = (x & 0x7FFFFF) | 0x800000;
+            uint32_t shift = 126 - e;
+            uint32_t h = m >> shift;
+            uint32_t rem = m & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (rem > halfway || (rem == halfway && (h & 1)))
+                ++h;
+            return sign | (uint16_t)h;
+        }
+
+        uint32_t h = (x - 0x38000000) >> 13;
+        uint32_t rem = x & 0x1FFF;
+        if (rem > 0x1000 || (rem == 0x1000 && (h & 1)))
+            ++h;
+        return sign | (uint16_t)h;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    inline float Fp16ToFloat(uint16_t value)
+    {
+        uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+        uint32_t e = (value >> 10) & 0x1F;
+        uint32_t m = value & 0x3FF;
+        uint32_t bits;
+
+        if (e == 0)
+        {
+            if (m == 0)
+                bits = sign;
+            else
+            {
+                // normalize subnormal
+                e = 113;
+                while (!(m & 0x400))
+                {
+                    m <<= 1;
+                    --e;
+                }
+                bits = sign | (e << 23) | ((m & 0x3FF) << 13);
+            }
+        }
+        else if (e == 31)
+            bits = sign | 0x7F800000 | (m << 13);
+        else
+            bits = sign | ((e + 112) << 23) | (m << 13);
+
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void PackFloats(const float* src, size_t count, EDataType type, uint16_t* dest);
+    void UnpackFloats(const uint16_t* src, size_t count, EDataType type, float* dest);
+    // Number of bytes single element occupies when stored in given format
+    inline size_t DataTypeSize(EDataType type) { return type == Float32 ? sizeof(float) : sizeof(uint16_t); }
+}
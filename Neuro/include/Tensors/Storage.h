@@ -6,6 +6,7 @@
 #include <string>
 
 #include "Types.h"
+#include "Tensors/HalfFloat.h"
 
 namespace Neuro
 {
@@ -31,10 +32,20 @@ namespace Neuro
         ~Storage();
 
         void ChangeType(int type);
+        /// Reduced precision data types are used only for keeping host data between computations (see Pack). It reduces memory
+        /// footprint only, kernels read fp32 data so every access to packed data first unpacks it into fp32 buffer.
+        void ChangeDataType(EDataType type);
+        EDataType DataType() const { return m_DataType; }
         void Resize(size_t size);
         void Rename(const string& name);
         /// Deallocates all memory on both host and device. Location will be changed to None. Size will remain unchanged.
         void Release();
+        /// Makes storage use host memory owned by someone else instead of its own, current content is discarded. Borrowed memory
+        /// is never freed by this storage, borrowing ends on any release or reallocation. Not supported for offloadable storage.
+        void BorrowHost(float* data);
+        /// Copies borrowed data to newly allocated own host memory
+        void StopBorrowing();
+        bool IsBorrowed() const { return m_Borrowed; }
 
         void AllocateOnHost() const;
         void FreeOnHost();
@@ -46,6 +57,13 @@ namespace Neuro
         void ScheduleOffload() const;
         void Preload() const;
 
+        /// Converts host data to reduced precision data type and releases fp32 host buffer. It is no-op for fp32 storage.
+        void Pack();
+        /// Restores fp32 host buffer from packed data. Called automatically whenever host data is accessed, restored buffer is
+        /// kept (packed copy remains valid until the first write) so following accesses are free until the next Pack.
+        void Unpack() const;
+        bool IsPacked() const { return m_PackedDataPtr && !m_DataPtr; }
+
         ELocation Location() const { return m_DataLocation; }
 
         void CopyToDevice() const;
@@ -69,20 +87,26 @@ namespace Neuro
 
         const float* Data() const;
         const float* DataUnsafe() const { return m_DataPtr; }
-        const float* DataEnd() const { return m_DataPtr + m_Size; }
+        const float* DataEnd() const { return Data() + m_Size; }
         const float* DeviceData() const;
         const float* DeviceDataUnsafe() const { return m_DeviceDataPtr; }
         float* Data();
         float* DeviceData();
 
-        bool IsHostAllocated() const { return m_DataPtr != nullptr; }
+        bool IsHostAllocated() const { return m_DataPtr != nullptr || m_PackedDataPtr != nullptr; }
         bool IsDeviceAllocated() const { return m_DeviceDataPtr != nullptr; }
 
         size_t Size() const { return m_Size; }
         size_t SizeInBytes() const { return m_Size * sizeof(float); }
         size_t AllocSizeInBytes() const { return m_AllocSize * sizeof(float); }
+        size_t PackedSizeInBytes() const { return m_Size * DataTypeSize(m_DataType); }
+
+        /// Incremented on every write access and whenever data is lost, can be used to detect whether content might have changed
+        uint64_t Version() const { return m_Version; }
 
     private:
+        void FreePacked() const;
+
         static void OffloadTriggerCallback(void* userData);
         static void OffloadDoneCallback(void* userData);
         static void PreloadDoneCallback(void* userData);
@@ -90,8 +114,14 @@ namespace Neuro
         void WaitForOffload() const;
         void WaitForPreload() const;
 
-        float* m_DataPtr = nullptr;
+        // host data can be unpacked on read access
+        mutable float* m_DataPtr = nullptr;
         float* m_DeviceDataPtr = nullptr;
+        mutable uint16_t* m_PackedDataPtr = nullptr;
+        // packed data is in sync with fp32 host data (fp32 data wasn't accessed for writing since last pack/unpack)
+        mutable bool m_PackedDataValid = false;
+        EDataType m_DataType = Float32;
+        uint64_t m_Version = 0;
         int m_Type = ST_Default;
         size_t m_AllocSize = 0;
         size_t m_Size = 0;
@@ -110,6 +140,7 @@ namespace Neuro
         mutable bool m_PreloadRequested = false;
         cudaEvent_t m_PreloadEvent = nullptr;
         mutable ELocation m_DataLocation = None;
+        bool m_Borrowed = false;
         string m_Name = "";
     };
 }
@@ -4,6 +4,7 @@
 #include <limits>
 #include <string>
 #include <sstream>
+#include <utility>
 #include <vector>
 #include "assert.h"
 
@@ -56,6 +57,13 @@ namespace Neuro
         float* Values();
         const float* Values() const;
         void SetStorageType(int type);
+        /// Host data of tensors with reduced precision data type is kept in 16-bit format between computations,
+        /// kernels still operate on fp32 values (conversion happens when data is accessed and when it is packed).
+        /// This saves memory only, memory traffic of kernels is not reduced.
+        void SetDataType(EDataType type);
+        EDataType DataType() const { return m_Storage.DataType(); }
+        void Pack();
+        bool IsPacked() const { return m_Storage.IsPacked(); }
 
         bool Validate() const;
 
@@ -90,6 +98,12 @@ namespace Neuro
         void MatMul(bool transpose, Tensor& result) const;
         Tensor MatMul(bool transpose) const;
 
+        // Performs F*F' (scaled) for every batch where F is this tensor viewed as depth x (width * height) matrix (no reshape
+        // is needed). Output is of shape (depth, depth, 1, batch).
+        void GramMatrix(float scale, Tensor& result) const;
+        Tensor GramMatrix(float scale = 1.f) const;
+        void GramMatrixGradient(const Tensor& outputGradient, float scale, Tensor& inputGradient) const;
+
 	public:
         void MatMul(const Tensor& t, Tensor& result) const;
         Tensor MatMul(const Tensor& t) const;
@@ -139,11 +153,23 @@ namespace Neuro
         void Sqrt(Tensor& output) const;
         Tensor Log() const;
         void Log(Tensor& output) const;
+        Tensor Exp() const;
+        void Exp(Tensor& output) const;
 
         void Map(const function<float(float)>& func, Tensor& result) const;
 		Tensor Map(const function<float(float)>& func) const;
 		void Map(const function<float(float, float)>&, const Tensor& other, Tensor& result) const;
 		Tensor Map(const function<float(float, float)>& func, const Tensor& other) const;
+        // Compile-time counterparts of function based element-wise API, callables are taken by type so they can be inlined
+        // and loops vectorized. Computation happens on host regardless of op mode, large tensors are processed in parallel
+        // blocks. Output can be the same tensor as one of inputs (in-place computation).
+        template<class F, class = decltype(declval<F&>()(0.f))> void Map(F func, Tensor& output) const;
+        template<class F, class = decltype(declval<F&>()(0.f))> Tensor Map(F func) const;
+        // Other tensor is broadcast (repeated) along dimensions in which it is smaller
+        template<class F> void Zip(F func, const Tensor& other, Tensor& output) const;
+        template<class F> Tensor Zip(F func, const Tensor& other) const;
+        // Callable receives one value from every input, all inputs must have the same length as output
+        template<class F, class... Ts> static void ZipN(F func, Tensor& output, const Ts&... inputs);
 
         Tensor AbsSum(EAxis axis) const;
         void AbsSum(EAxis axis, Tensor& output) const;
@@ -221,6 +247,10 @@ namespace Neuro
         void LinearRampPad2D(uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float endValue, Tensor& output) const;
         Tensor LinearRampPad2D(uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float endValue) const;
         void Pad2DGradient(const Tensor& gradient, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, Tensor& inputGradient) const;
+        /// Equivalent of padding followed by valid Conv2D (NCHW only) without materializing padded tensor
+        void PaddedConv2D(const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& output) const;
+        void PaddedConv2DInputsGradient(const Tensor& gradient, const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, Tensor& inputsGradient) const;
+        void PaddedConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& kernelsGradient) const;
 
         Tensor Roll2D(int xShift, int yShift) const;
         void Roll2D(int xShift, int yShift, Tensor& output) const;
@@ -242,10 +272,19 @@ namespace Neuro
         void Pool2D(uint32_t filterSize, uint32_t stride, EPoolingMode type, uint32_t padding, EDataFormat dataFormat, Tensor& output) const;
         Tensor Pool2D(uint32_t filterSize, uint32_t stride, EPoolingMode type, uint32_t padding, EDataFormat dataFormat) const;
         void Pool2DGradient(const Tensor& output, const Tensor& input, const Tensor& outputGradient, uint32_t filterSize, uint32_t stride, EPoolingMode type, uint32_t padding, EDataFormat dataFormat, Tensor& result) const;
+        /// Max pooling saving index of maximum within window for every output element (max indices have to have output's length),
+        /// gradient is then scattered directly to those positions without rescanning windows
+        void MaxPool2D(uint32_t filterSize, uint32_t stride, uint32_t padding, EDataFormat dataFormat, Tensor& output, uint8_t* maxIndices) const;
+        /// Called on output gradient
+        void MaxPool2DGradient(const uint8_t* maxIndices, uint32_t filterSize, uint32_t stride, uint32_t padding, EDataFormat dataFormat, Tensor& result) const;
 
         void UpSample2D(uint32_t scaleFactor, Tensor& output) const;
         Tensor UpSample2D(uint32_t scaleFactor) const;
         void UpSample2DGradient(const Tensor& outputGradient, uint32_t scaleFactor, Tensor& inputGradient) const;
+        /// Equivalent of UpSample2D followed by Conv2D (NCHW only) without materializing upsampled tensor
+        void UpSampleConv2D(const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, Tensor& output) const;
+        void UpSampleConv2DInputsGradient(const Tensor& gradient, const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, Tensor& inputsGradient) const;
+        void UpSampleConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t scaleFactor, uint32_t stride, uint32_t padding, Tensor& kernelsGradient) const;
 
         void BatchNorm(const Tensor& gamma, const Tensor& beta, float epsilon, const Tensor* runningMean, const Tensor* runningVar, Tensor& result) const;
         void BatchNormTrain(const Tensor& gamma, const Tensor& beta, float momentum, float epsilon, Tensor* runningMean, Tensor* runningVar, Tensor& saveMean, Tensor& saveInvVariance, Tensor& result) const;
@@ -323,6 +362,15 @@ namespace Neuro
         void IncRef(size_t n = 1);
         void DecRef(size_t n = 1);
         void ReleaseData();
+        /// Takes over other tensor's buffer (other is left without data), shape and name are kept
+        void TakeData(Tensor& other);
+        /// Makes tensor use part of owner's host buffer starting at given element offset instead of its own memory (current
+        /// content is discarded). Writes go directly to owner, aliasing ends when tensor is released or reallocated.
+        void AliasHost(Tensor& owner, size_t offset);
+        bool IsAliasOf(const Tensor& owner, size_t offset) const;
+        /// Copies aliased data to tensor's own buffer
+        void Unalias();
+        bool IsAlias() const { return m_Storage.IsBorrowed(); }
         void CopyToDevice() const;
         void CopyToHost(bool allowAlloc = false) const;
         /// Sync will copy data from device to host but it won't change location (useful for read-only operations performed on CPU)
@@ -333,6 +381,8 @@ namespace Neuro
         void OverrideDevice();
         bool IsOnHost() const { return m_Storage.Location() == Host; }
         bool IsOnDevice() const { return m_Storage.Location() == Device; }
+        /// Changes whenever tensor is accessed for writing (see Storage::Version)
+        uint64_t Version() const { return m_Storage.Version(); }
         
         const float* DataPtrUnsafe() const;
         const float* DeviceDataPtrUnsafe() const;
@@ -356,9 +406,15 @@ namespace Neuro
         TensorOpCpu* Op() const { return g_ForcedOp ? g_ForcedOp : m_Op; }
 
 		static TensorOpCpu* GetOpFromMode(EOpMode mode);
+        // Splits range into blocks of given size, blocks are processed in parallel when there is more than one
+        static void ParallelBlocks(uint32_t count, uint32_t blockSize, const function<void(uint32_t, uint32_t)>& body);
+        template<class F, class... Ps> static void ZipNBlock(F& func, float* output, uint32_t begin, uint32_t end, const Ps*... inputs);
+
+        static const uint32_t ELEMENTWISE_BLOCK_SIZE = 16 * 1024;
 
 		static TensorOpCpu* g_DefaultOp;
-        static TensorOpCpu* g_ForcedOp;
+        // forced op is set by operations for the duration of their computation, graph can be computed from multiple threads
+        static thread_local TensorOpCpu* g_ForcedOp;
 		static TensorOpCpu* g_OpCpu;
         static TensorOpCpu* g_OpCpuMt;
         static TensorOpCpu* g_OpCpuMkl;
@@ -414,6 +470,132 @@ namespace Neuro
         m_Storage.Data()[m_Shape.GetIndex(w, h, d, n)] = value;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    template<class F, class>
+    void Tensor::Map(F func, Tensor& output) const
+    {
+        NEURO_ASSERT(m_Shape == output.GetShape(), "Output shape doesn't match input shape.");
+        CopyToHost();
+        output.OverrideHost();
+
+        const float* inputValues = Values();
+        float* outputValues = output.Values();
+
+        ParallelBlocks(Length(), ELEMENTWISE_BLOCK_SIZE, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+                outputValues[i] = func(inputValues[i]);
+        });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<class F, class>
+    Tensor Tensor::Map(F func) const
+    {
+        Tensor result(m_Shape);
+        Map(func, result);
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<class F>
+    void Tensor::Zip(F func, const Tensor& other, Tensor& output) const
+    {
+        NEURO_ASSERT(m_Shape == output.GetShape(), "Output shape doesn't match input shape.");
+        CopyToHost();
+        other.CopyToHost();
+        output.OverrideHost();
+
+        const float* t1Values = Values();
+        const float* t2Values = other.Values();
+        float* outputValues = output.Values();
+
+        if (other.GetShape() == m_Shape)
+        {
+            ParallelBlocks(Length(), ELEMENTWISE_BLOCK_SIZE, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                    outputValues[i] = func(t1Values[i], t2Values[i]);
+            });
+            return;
+        }
+
+        NEURO_ASSERT(other.Width() == 1 || other.Width() == Width(), "Other tensor width can't be broadcasted.");
+        NEURO_ASSERT(other.Height() == 1 || other.Height() == Height(), "Other tensor height can't be broadcasted.");
+        NEURO_ASSERT(other.Depth() == 1 || other.Depth() == Depth(), "Other tensor depth can't be broadcasted.");
+        NEURO_ASSERT(other.Batch() == 1 || other.Batch() == Batch(), "Other tensor batch can't be broadcasted.");
+
+        // broadcasting is resolved per row so inner loop stays contiguous whenever other tensor has full width
+        const uint32_t width = Width(), otherWidth = other.Width();
+        const uint32_t rowsNum = Height() * Depth() * Batch();
+
+        ParallelBlocks(rowsNum, max(1u, ELEMENTWISE_BLOCK_SIZE / width), [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t row = begin; row < end; ++row)
+            {
+                const uint32_t h = row % Height(), d = (row / Height()) % Depth(), n = row / (Height() * Depth());
+                const float* t1Row = t1Values + row * width;
+                const float* t2Row = t2Values + other.GetShape().GetIndex(0u, h % other.Height(), d % other.Depth(), n % other.Batch());
+                float* outputRow = outputValues + row * width;
+
+                if (otherWidth == width)
+                {
+                    for (uint32_t w = 0; w < width; ++w)
+                        outputRow[w] = func(t1Row[w], t2Row[w]);
+                }
+                else if (otherWidth == 1)
+                {
+                    const float v = t2Row[0];
+                    for (uint32_t w = 0; w < width; ++w)
+                        outputRow[w] = func(t1Row[w], v);
+                }
+                else
+                {
+                    for (uint32_t w = 0; w < width; ++w)
+                        outputRow[w] = func(t1Row[w], t2Row[w % otherWidth]);
+                }
+            }
+        });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<class F>
+    Tensor Tensor::Zip(F func, const Tensor& other) const
+    {
+        Tensor result(m_Shape);
+        Zip(func, other, result);
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<class F, class... Ts>
+    void Tensor::ZipN(F func, Tensor& output, const Ts&... inputs)
+    {
+        static_assert(sizeof...(Ts) > 0, "At least one input is required.");
+        const uint32_t lengths[] = { inputs.Length()... };
+        for (auto length : lengths)
+            NEURO_ASSERT(length == output.Length(), "Mismatched input length, expected " << output.Length() << " received " << length << ".");
+
+        // inputs have to be copied before overriding output as it can be one of them
+        const bool copied[] = { (inputs.CopyToHost(), true)... };
+        (void)copied;
+        output.OverrideHost();
+
+        float* outputValues = output.Values();
+        ParallelBlocks(output.Length(), ELEMENTWISE_BLOCK_SIZE, [&](uint32_t begin, uint32_t end)
+        {
+            ZipNBlock(func, outputValues, begin, end, inputs.Values()...);
+        });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<class F, class... Ps>
+    void Tensor::ZipNBlock(F& func, float* output, uint32_t begin, uint32_t end, const Ps*... inputs)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            output[i] = func(inputs[i]...);
+    }
+
     Tensor operator*(const Tensor& t1, const Tensor& t2);
     Tensor operator*(const Tensor& t, float v);
     Tensor operator/(const Tensor& t1, const Tensor& t2);
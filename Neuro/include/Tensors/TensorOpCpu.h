@@ -16,6 +16,8 @@ namespace Neuro
         virtual void Sub(const Tensor& t1, const Tensor& t2, Tensor& output) const;
         virtual void MatMul(const Tensor& t1, bool transposeT1, const Tensor& t2, bool transposeT2, Tensor& output) const;
         virtual void MatMul(const Tensor& t, bool transpose, Tensor& output) const;
+        virtual void GramMatrix(const Tensor& features, float scale, Tensor& output) const;
+        virtual void GramMatrixGradient(const Tensor& features, const Tensor& outputGradient, float scale, Tensor& inputGradient) const;
 		virtual void Mul(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const;
         virtual void Div(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const;
         virtual void Mul(const Tensor& input, float v, Tensor& output) const;
@@ -30,6 +32,7 @@ namespace Neuro
         virtual void Abs(const Tensor& input, Tensor& output) const;
         virtual void AbsGradient(const Tensor& input, const Tensor& outputGradient, Tensor& inputGradient) const;
         virtual void Log(const Tensor& input, Tensor& output) const;
+        virtual void Exp(const Tensor& input, Tensor& output) const;
         virtual void Sqrt(const Tensor& input, Tensor& output) const;
         virtual void Negate(const Tensor& input, Tensor& output) const;
         virtual void Inverse(float alpha, const Tensor& input, Tensor& output) const;
@@ -41,6 +44,12 @@ namespace Neuro
         virtual void ReflectPad2D(const Tensor& input, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, Tensor& output) const;
         virtual void LinearRampPad2D(const Tensor& input, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float endValue, Tensor& output) const;
         virtual void Pad2DGradient(const Tensor& gradient, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, Tensor& inputsGradient) const;
+        /// Valid convolution of virtually padded input (NCHW only), border taps are resolved inside the kernel using the same
+        /// formulas as pad functions (border value is constant value or linear ramp end value and is ignored by reflect border).
+        /// Like Pad2DGradient, inputs gradient ignores border taps.
+        virtual void PaddedConv2D(const Tensor& input, const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& output) const;
+        virtual void PaddedConv2DInputGradient(const Tensor& gradient, const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, Tensor& inputGradient) const;
+        virtual void PaddedConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& kernelsGradient) const;
         virtual void Roll2D(const Tensor& input, int xShift, int yShift, Tensor& output) const;
         virtual void Roll2D(Tensor& input, int xShift, int yShift) const;
         virtual void Conv2D(const Tensor& input, const Tensor& kernels, uint32_t stride, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& output) const;
@@ -50,7 +59,14 @@ namespace Neuro
         virtual void Conv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t stride, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& kernelsGradient) const;
         virtual void Pool2D(const Tensor& input, uint32_t filterSize, uint32_t stride, EPoolingMode type, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& output) const;
         virtual void Pool2DGradient(const Tensor& output, const Tensor& input, const Tensor& outputGradient, uint32_t filterSize, uint32_t stride, EPoolingMode type, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& inputGradient) const;
+        /// Max pooling recording offset of maximum within its window (row-major) for every output element, indices have output's length
+        virtual void MaxPool2D(const Tensor& input, uint32_t filterSize, uint32_t stride, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& output, uint8_t* maxIndices) const;
+        virtual void MaxPool2DGradient(const Tensor& outputGradient, const uint8_t* maxIndices, uint32_t filterSize, uint32_t stride, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& inputGradient) const;
         virtual void UpSample2D(const Tensor& input, uint32_t scaleFactor, Tensor& output) const;
+        /// Convolution of nearest-neighbour upsampled input computed directly from low resolution input (NCHW only)
+        virtual void UpSampleConv2D(const Tensor& input, const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t paddingX, uint32_t paddingY, Tensor& output) const;
+        virtual void UpSampleConv2DInputGradient(const Tensor& gradient, const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t paddingX, uint32_t paddingY, Tensor& inputGradient) const;
+        virtual void UpSampleConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t scaleFactor, uint32_t stride, uint32_t paddingX, uint32_t paddingY, Tensor& kernelsGradient) const;
         virtual void UpSample2DGradient(const Tensor& outputGradient, uint32_t scaleFactor, Tensor& inputGradient) const;
         virtual void BatchNormalization(const Tensor& input, EBatchNormMode mode, const Tensor& gamma, const Tensor& beta, float epsilon, const Tensor* runningMean, const Tensor* runningVar, Tensor& output) const;
         virtual void BatchNormalizationTrain(const Tensor& input, EBatchNormMode mode, const Tensor& gamma, const Tensor& beta, float momentum, float epsilon, Tensor* runningMean, Tensor* runningVar, Tensor& saveMean, Tensor& saveInvVariance, Tensor& output) const;
@@ -17,6 +17,8 @@ namespace Neuro
         //virtual void Scale(Tensor& input, float v) const override;
         virtual void MatMul(const Tensor& t1, bool transposeT1, const Tensor& t2, bool transposeT2, Tensor& output) const override;
         virtual void MatMul(const Tensor& t, bool transpose, Tensor& output) const override;
+        virtual void GramMatrix(const Tensor& features, float scale, Tensor& output) const override;
+        virtual void GramMatrixGradient(const Tensor& features, const Tensor& outputGradient, float scale, Tensor& inputGradient) const override;
         virtual void Transpose(const Tensor& input, Tensor& output) const override;
 #endif
     };
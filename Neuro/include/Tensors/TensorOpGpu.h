@@ -20,6 +20,8 @@ namespace Neuro
         virtual void Add(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const override;
         virtual void MatMul(const Tensor& t1, bool transposeT1, const Tensor& t2, bool transposeT2, Tensor& output) const override;
         virtual void MatMul(const Tensor& t, bool transpose, Tensor& output) const override;
+        virtual void GramMatrix(const Tensor& features, float scale, Tensor& output) const override;
+        virtual void GramMatrixGradient(const Tensor& features, const Tensor& outputGradient, float scale, Tensor& inputGradient) const override;
         virtual void Mul(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const override;
         virtual void Div(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const override;
         virtual void Mul(const Tensor& input, float v, Tensor& output) const override;
@@ -30,6 +30,8 @@ namespace Neuro
     const float _EPSILON = 10e-7f;
     
     Random& GlobalRng();
+    /// Counter-based generator used for bulk generation (dropout masks, initializers), seeded together with GlobalRng
+    Philox& GlobalPhilox();
     void GlobalRngSeed(unsigned int seed);
 
     template<typename C> void DeleteContainer(C& container);
@@ -94,11 +96,17 @@ namespace Neuro
     static const uint32_t NVTX_COLOR_MAGENTA = 0xFFFF00FF;
     static const uint32_t NVTX_COLOR_CYAN = 0xFF00FFFF;
 
+    /// Marks range in Nsight timeline (when CUDA_PROFILING_ENABLED is defined) and in built-in profiler when it is enabled (see Profiler)
     class NVTXProfile
     {
     public:
         NVTXProfile(const char* message, uint32_t color);
         ~NVTXProfile();
+
+    private:
+        string m_Message; // copied only when profiler is enabled since message is often temporary
+        int64_t m_StartUs = -1;
+        size_t m_StartBytes = 0;
     };
 
     struct ImageLoader : public ILoader
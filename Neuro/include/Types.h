@@ -37,6 +37,13 @@ namespace Neuro
         GPU
     };
 
+    enum ECheckpointing
+    {
+        NoCheckpointing, // all activations are kept until their gradients are computed
+        ManualCheckpointing, // only outputs of nodes marked as checkpoints are kept, remaining ones are recomputed during backward pass
+        SqrtCheckpointing, // in addition to manually marked nodes every sqrt(N)-th activation is kept
+    };
+
     enum ELocation
     {
         None,
@@ -51,6 +58,13 @@ namespace Neuro
         Full,  // output matrix's size will be increased (depending on kernel size)
     };
 
+    enum EBorderMode
+    {
+        ConstantBorder, // border is filled with constant value
+        ReflectBorder, // border mirrors input without repeating edge pixels
+        LinearRampBorder, // border ramps from edge pixels (offset by end value) down to zero
+    };
+
     enum EPoolingMode
     {
         MaxPool,
@@ -95,6 +109,13 @@ namespace Neuro
         NHWC,
     };
 
+    enum EDataType
+    {
+        Float32,
+        BFloat16, // 8-bit exponent, 7-bit mantissa (same range as float32)
+        Float16, // IEEE half precision
+    };
+
     enum EPixelFormat
     {
         RGB,
@@ -1,6 +1,10 @@
+#include <map>
+#include <set>
+
 #include "Applications/VGG16.h"
 #include "Tensors/Tensor.h"
 #include "Models/Sequential.h"
+#include "Layers/Input.h"
 #include "Layers/Conv2D.h"
 #include "Layers/Pooling2D.h"
 #include "Layers/Dense.h"
@@ -106,6 +110,55 @@ namespace Neuro
         return model;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    ModelBase* VGG16::CreateFeatureExtractor(const vector<string>& outputLayers, EDataFormat dataFormat, Shape inputShape, EPoolingMode poolMode, const string& weightsDir)
+    {
+        return BuildFeatureExtractor("vgg16", { 2, 2, 3, 3, 3 }, weightsDir + "vgg16_weights_tf_dim_ordering_tf_kernels_notop.h5", outputLayers, dataFormat, inputShape, poolMode);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ModelBase* VGG16::BuildFeatureExtractor(const string& name, const vector<uint32_t>& convsPerBlock, const string& weightsFile, const vector<string>& outputLayers, EDataFormat dataFormat, Shape inputShape, EPoolingMode poolMode)
+    {
+        NEURO_ASSERT(!outputLayers.empty(), "No output layers requested.");
+
+        if (!inputShape.IsValid())
+            inputShape = dataFormat == NHWC ? Shape(3, 224, 224) : Shape(224, 224, 3);
+
+        const uint32_t BLOCK_FILTERS[] = { 64, 128, 256, 512, 512 };
+
+        set<string> missingLayers(outputLayers.begin(), outputLayers.end());
+        map<string, TensorLike*> layersOutputs;
+
+        auto input = new Input(inputShape, name + "_input");
+        TensorLike* x = input->Outputs()[0];
+
+        for (uint32_t b = 0; b < convsPerBlock.size() && !missingLayers.empty(); ++b)
+        {
+            for (uint32_t c = 0; c < convsPerBlock[b] && !missingLayers.empty(); ++c)
+            {
+                string layerName = "block" + to_string(b + 1) + "_conv" + to_string(c + 1);
+                x = (new Conv2D(BLOCK_FILTERS[b], 3, 1, 1, new ReLU(), dataFormat, layerName))->Call(x)[0];
+                layersOutputs[layerName] = x;
+                missingLayers.erase(layerName);
+            }
+
+            // pooling is only needed when there are still deeper layers to build
+            if (!missingLayers.empty())
+                x = (new Pooling2D(2, 2, 0, poolMode, dataFormat, "block" + to_string(b + 1) + "_pool"))->Call(x)[0];
+        }
+
+        NEURO_ASSERT(missingLayers.empty(), "Layer '" << *missingLayers.begin() << "' is not a convolution layer of " << name << ".");
+
+        vector<TensorLike*> outputs;
+        for (auto& layerName : outputLayers)
+            outputs.push_back(layersOutputs[layerName]);
+
+        auto model = new Flow(input->Outputs(), outputs, name + "_features");
+        // loading by name reads only groups of layers present in the model
+        model->LoadWeights(weightsFile, true, true);
+        return model;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     TensorLike* VGG16::Preprocess(TensorLike* image, EDataFormat dataFormat, bool swapChannels)
     {
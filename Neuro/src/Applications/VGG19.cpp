@@ -56,5 +56,11 @@ namespace Neuro
 
         return model;
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    ModelBase* VGG19::CreateFeatureExtractor(const vector<string>& outputLayers, EDataFormat dataFormat, Shape inputShape, EPoolingMode poolMode, const string& weightsDir)
+    {
+        return BuildFeatureExtractor("vgg19", { 2, 2, 4, 4, 4 }, weightsDir + "vgg19_weights_tf_dim_ordering_tf_kernels_notop.h5", outputLayers, dataFormat, inputShape, poolMode);
+    }
 }
 
@@ -1,4 +1,6 @@
-﻿#include <fstream>
+﻿#include <cmath>
+#include <fstream>
+#include <unordered_map>
 
 #include "ComputationalGraph/Graph.h"
 #include "ComputationalGraph/TensorLike.h"
@@ -6,6 +8,7 @@
 #include "ComputationalGraph/Variable.h"
 #include "ComputationalGraph/Constant.h"
 #include "ComputationalGraph/Operation.h"
+#include "Tensors/TensorOpCpu.h"
 #include "Debug.h"
 #include "Tools.h"
 #include "Memory/MemoryManager.h"
@@ -121,6 +124,80 @@ namespace Neuro
         nodes.push_back(node);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    vector<vector<TensorLike*>> Graph::BuildReleaseSchedule(const vector<TensorLike*>& order, const vector<TensorLike*>& fetches) const
+    {
+        vector<vector<TensorLike*>> schedule(order.size());
+        if (m_Checkpointing == NoCheckpointing)
+            return schedule;
+
+        // only activations which will participate in backward pass are worth releasing, operations with side effects or random
+        // output in training mode (dropout, batch normalization) can't be recomputed; on GPU device memory is already bounded
+        // by offloading. Schedule is built before the run so memoizability has to be checked for training explicitly.
+        auto canRelease = [&](const TensorLike* node)
+        {
+            if (!node->IsOp() || node->IsCheckpoint() || node->m_AlwaysOffload || !node->CareAboutGradient())
+                return false;
+            if (find(fetches.begin(), fetches.end(), node) != fetches.end())
+                return false;
+            auto op = static_cast<const Operation*>(node);
+            return op->OpMode() != GPU && op->IsMemoizable(true);
+        };
+
+        unordered_map<TensorLike*, size_t> lastUse;
+        vector<TensorLike*> candidates;
+        for (size_t n = 0; n < order.size(); ++n)
+        {
+            for (auto inputNode : order[n]->m_InputNodes)
+                lastUse[inputNode] = n;
+
+            if (canRelease(order[n]))
+                candidates.push_back(order[n]);
+        }
+
+        // keeping every k-th activation makes both number of kept activations and length of recomputed segments ~sqrt(N)
+        unordered_set<TensorLike*> autoCheckpoints;
+        if (m_Checkpointing == SqrtCheckpointing)
+        {
+            size_t k = max<size_t>(1, (size_t)ceil(sqrt((double)candidates.size())));
+            for (size_t i = k - 1; i < candidates.size(); i += k)
+                autoCheckpoints.insert(candidates[i]);
+        }
+
+        for (auto node : candidates)
+        {
+            auto it = lastUse.find(node);
+            if (it == lastUse.end() || autoCheckpoints.find(node) != autoCheckpoints.end())
+                continue;
+            schedule[it->second].push_back(node);
+        }
+
+        return schedule;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Graph::ReleaseOutput(TensorLike* node)
+    {
+        GRAPH_DEBUG_INFO("##Graph: Releasing '%s' output...\n", node->Name().c_str());
+        node->m_Output.ReleaseData();
+        node->m_OutputReleased = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Graph::RecomputeOutput(TensorLike* node)
+    {
+        if (!node->m_OutputReleased)
+            return;
+
+        // recursion stops at nearest checkpoints so the whole segment is recomputed at once and kept until its gradients are computed
+        for (auto inputNode : node->m_InputNodes)
+            RecomputeOutput(inputNode);
+
+        NVTXProfile nvtxProf((string("Recompute ") + node->Name()).c_str(), 0xFFC0C0C0);
+        GRAPH_DEBUG_INFO("##Graph: Recomputing '%s'...\n", node->Name().c_str());
+        static_cast<Operation*>(node)->Compute(true);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     vector<TensorLike*> Graph::BuildBackwardOrder(const vector<TensorLike*>& endNodes, unordered_set<TensorLike*>& nodesAffectingEndNodes, const vector<Variable*>& params)
     {
@@ -148,6 +225,35 @@ namespace Neuro
         return result;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    ReplicatedOrder Graph::SplitOrder(const vector<TensorLike*>& order, const vector<unordered_set<TensorLike*>>& replicasNodes, bool backward) const
+    {
+        ReplicatedOrder result;
+        result.replicas.resize(replicasNodes.size());
+
+        for (auto node : order)
+        {
+            size_t owner = 0, ownersCount = 0;
+            for (size_t r = 0; r < replicasNodes.size(); ++r)
+            {
+                if (replicasNodes[r].find(node) == replicasNodes[r].end())
+                    continue;
+                owner = r;
+                ++ownersCount;
+            }
+
+            if (ownersCount == 1)
+                result.replicas[owner].push_back(node);
+            // shared nodes are inputs of replicas while nodes not belonging to any replica are consuming their outputs (like merged loss)
+            else if ((ownersCount > 1) != backward)
+                result.prologue.push_back(node);
+            else
+                result.epilogue.push_back(node);
+        }
+
+        return result;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Graph::ProcessBackwardNode(TensorLike* node, vector<TensorLike*>& nodes, const vector<Variable*>& params, bool ignoreConsumersCheck, unordered_set<TensorLike*>& visited, unordered_set<TensorLike*>& visitedParams, const unordered_set<TensorLike*>& required)
     {
@@ -205,7 +311,7 @@ namespace Neuro
     }
 
     //////////////////////////////////////////////////////////////////////////
-    vector<Variable*> Graph::ComputeGradientsInOrder(const vector<TensorLike*>& order, const vector<TensorLike*>& losses, const unordered_set<TensorLike*> nodesAffectingLosses, const vector<Variable*>& params)
+    vector<Variable*> Graph::ComputeGradientsInOrder(const vector<TensorLike*>& order, const vector<TensorLike*>& losses, const unordered_set<TensorLike*> nodesAffectingLosses, const vector<Variable*>& params, const function<void(Variable*)>& gradientReady)
     {
         //DeviceMemoryManager::Default().ForceMemoryStreamSync();
 
@@ -258,6 +364,7 @@ namespace Neuro
                 }
                 else
                 {
+                    vector<const Tensor*> consumersGrads;
                     for (auto consumer : node->m_Consumers)
                     {
                         assert(consumer->IsOp());
@@ -272,22 +379,28 @@ namespace Neuro
                         if (inputsGrad.size() == 1)
                         {
                             assert(inputsGrad[0].Length());
-                            nodeOutputGrad.Add(inputsGrad[0], nodeOutputGrad);
+                            consumersGrads.push_back(&inputsGrad[0]);
                         }
                         else
                         {
                             auto nodeIndexInConsumerInputs = distance(consumer->m_InputNodes.begin(), find(consumer->m_InputNodes.begin(), consumer->m_InputNodes.end(), node));
                             auto& lossGradWrtNode = inputsGrad[nodeIndexInConsumerInputs];
                             assert(lossGradWrtNode.Length());
-                            nodeOutputGrad.Add(lossGradWrtNode, nodeOutputGrad);
+                            consumersGrads.push_back(&lossGradWrtNode);
                         }
                     }
+
+                    SumGradients(consumersGrads, nodeOutputGrad);
                 }
 
                 Operation* opNode = node->IsOp() ? static_cast<Operation*>(node) : nullptr;
                 
                 if (opNode)
                 {
+                    RecomputeOutput(opNode);
+                    for (auto inputNode : opNode->m_InputNodes)
+                        RecomputeOutput(inputNode);
+
                     NVTXProfile nvtxProf((string("Compute grad ") + node->Name()).c_str(), 0xFF4242FF);
                     opNode->ComputeGradient(nodeOutputGrad);
 
@@ -314,6 +427,9 @@ namespace Neuro
                 {
                     if (Debug::ShouldLogGrad(node->Name()))
                         nodeOutputGrad.DebugDumpValues(node->Name() + "_grad_step" + to_string(Debug::GetStep()) + ".log");
+
+                    if (gradientReady && !variables.empty() && variables.back() == node)
+                        gradientReady(variables.back());
                 }
             }
 
@@ -325,6 +441,45 @@ namespace Neuro
         return variables;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Graph::SumGradients(const vector<const Tensor*>& grads, Tensor& result)
+    {
+        // few gradients or gradients living on device are simply accumulated one by one
+        if (grads.size() < 3 || Tensor::ActiveOp()->OpMode() == GPU)
+        {
+            for (auto grad : grads)
+                result.Add(*grad, result);
+            return;
+        }
+
+        // with many contributions (like variables shared between data parallel replicas) each thread sums all gradients
+        // for a single block of the result, so the block stays in cache instead of streaming whole result once per gradient
+        const size_t BLOCK_SIZE = 4096;
+
+        for (auto grad : grads)
+            grad->CopyToHost();
+        result.OverrideHost();
+
+        float* resultData = result.Values();
+        const size_t length = result.Length();
+        const int blocksNum = (int)((length + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+        #pragma omp parallel for
+        for (int b = 0; b < blocksNum; ++b)
+        {
+            const size_t start = b * BLOCK_SIZE;
+            const size_t end = min(start + BLOCK_SIZE, length);
+
+            copy(grads[0]->Values() + start, grads[0]->Values() + end, resultData + start);
+            for (size_t g = 1; g < grads.size(); ++g)
+            {
+                const float* gradData = grads[g]->Values();
+                for (size_t i = start; i < end; ++i)
+                    resultData[i] += gradData[i];
+            }
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     TensorLike* Graph::GetNode(const string& name)
     {
@@ -1,9 +1,13 @@
-﻿#include "ComputationalGraph/Operation.h"
+﻿#include <algorithm>
+
+#include "ComputationalGraph/Operation.h"
 #include "ComputationalGraph/Graph.h"
+#include "ComputationalGraph/Variable.h"
 #include "Tensors/Tensor.h"
 #include "Tensors/TensorOpCpu.h"
 #include "Tools.h"
 #include "Debug.h"
+#include "Profiler.h"
 
 #include "Memory/MemoryManager.h"
 
@@ -52,12 +56,52 @@ namespace Neuro
         return inputTensors;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool Operation::CanReuseOutput(bool training) const
+    {
+        if (!m_Graph->MemoizationEnabled() || !IsMemoizable(training) || m_InputsVersions.size() != m_Inputs.size() || training != m_Training)
+            return false;
+
+        // output must be recomputed when gradient will be propagated through it, backward pass relies on state from forward pass
+        if (training && m_CareAboutGradient)
+            return false;
+
+        for (size_t i = 0; i < m_Inputs.size(); ++i)
+        {
+            if (m_Inputs[i]->Version() != m_InputsVersions[i])
+                return false;
+        }
+        return true;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     const Tensor& Operation::Compute(bool training)
     {
         EOpMode oldMode = Tensor::ActiveOp()->OpMode();
         Tensor::SetForcedOpMode(m_OpMode);
 
+        m_OutputReleased = false;
+
+        bool inputsUnchanged = CanReuseOutput(training);
+        m_Memoized = inputsUnchanged && m_KeepOutput && m_Output.Version() == m_OutputVersion;
+        m_KeepOutput = inputsUnchanged;
+
+        if (m_Memoized)
+        {
+            m_Output.ResetDeviceRef(m_Consumers.size());
+            m_Output.IncRef();
+            m_LastComputeStep = m_Graph->CurrentStep();
+
+            for (auto consumer : m_Consumers)
+            {
+                if (consumer->IsOp() && static_cast<Operation*>(consumer)->OpMode() != GPU)
+                    OutputOnDeviceConsumed();
+            }
+
+            Tensor::SetForcedOpMode(oldMode);
+            return m_Output;
+        }
+
         if (m_Output.TryDeviceAllocate())
             m_Output.OverrideDevice();
         m_Output.ResetDeviceRef(m_Consumers.size());
@@ -68,14 +112,28 @@ namespace Neuro
         if (UndeterminedOutputShape())
             UpdateOutputShape();
 
-        ComputeInternal();
+        {
+            OpProfile p(this, false);
+            ComputeInternal();
+        }
 
         m_LastComputeStep = m_Graph->CurrentStep();
+
+        m_InputsVersions.resize(m_Inputs.size());
+        for (size_t i = 0; i < m_Inputs.size(); ++i)
+            m_InputsVersions[i] = m_Inputs[i]->Version();
         
         for (auto inputNode : m_InputNodes)
         {            
             if (!m_InputsManuallyConsumed && OpMode() == GPU)
                 inputNode->OutputOnDeviceConsumed();
+
+            // reduced precision inputs are kept packed between steps, trainable variables are always kept in full precision
+            // because optimizers update them in place (they are master weights). Input is packed once all its consumers
+            // computed in this step read it, otherwise it would be unpacked and packed again for every consumer.
+            if (OpMode() != GPU && inputNode->Output().DataType() != Float32 && !(inputNode->IsVar() && static_cast<Variable*>(inputNode)->Trainable()) &&
+                all_of(inputNode->Consumers().begin(), inputNode->Consumers().end(), [&](TensorLike* consumer) { return !consumer->IsOp() || static_cast<Operation*>(consumer)->LastComputeStep() == m_LastComputeStep; }))
+                inputNode->Output().Pack();
         }
 
         bool anyConsumerCareAboutGradient = false;
@@ -83,8 +141,11 @@ namespace Neuro
             anyConsumerCareAboutGradient |= consumer->CareAboutGradient();
 
         // operations not participating in gradient computation offload is not necessary, it can be simply deallocated when consumed
-        if (m_AlwaysOffload || m_Fetched || (m_Training && anyConsumerCareAboutGradient))
-            m_Output.Offload(m_AlwaysOffload || m_Fetched); // at this point output won't change so start offloading it, it will be released when all consumers used it
+        // kept outputs have to be offloaded as well otherwise they would be lost when device memory is released
+        if (m_AlwaysOffload || m_Fetched || m_KeepOutput || (m_Training && anyConsumerCareAboutGradient))
+            m_Output.Offload(m_AlwaysOffload || m_Fetched || m_KeepOutput); // at this point output won't change so start offloading it, it will be released when all consumers used it
+
+        m_OutputVersion = m_Output.Version();
 
         // reset the device ref count for all consumers working in non-GPU mode we so it gets a chance to be deallocated as soon as it's offloaded
         for (auto consumer : m_Consumers)
@@ -114,13 +175,77 @@ namespace Neuro
                 m_InputsGrads[i].OverrideDevice();
         }
 
-        ComputeGradientInternal(grad);
+        {
+            OpProfile p(this, true);
+            ComputeGradientInternal(grad);
+        }
 
         Tensor::SetForcedOpMode(oldMode);
 
         return m_InputsGradsPtrs;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool Operation::InPlaceAllowed() const
+    {
+        return m_Graph->InPlaceEnabled() && !m_Training && m_OpMode != GPU;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool Operation::CanReuseInputMemory(size_t index) const
+    {
+        if (!InPlaceAllowed())
+            return false;
+
+        auto inputNode = m_InputNodes[index];
+        if (!inputNode->IsOp() || inputNode->m_Fetched || inputNode->m_AlwaysOffload || inputNode->m_Consumers.size() != 1)
+            return false;
+
+        // the same node can be passed as multiple inputs
+        if (count(m_InputNodes.begin(), m_InputNodes.end(), inputNode) != 1)
+            return false;
+
+        auto inputOp = static_cast<Operation*>(inputNode);
+        return inputOp->m_OpMode != GPU && !inputOp->SharesOutputBuffer() && inputNode->m_Output.DataType() == Float32;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool Operation::TryTakeOverInput(size_t index)
+    {
+        // output aliased by consumer is already written in place
+        if (!CanReuseInputMemory(index) || m_Output.IsAlias())
+            return false;
+
+        // kept outputs are reused by memoization in the following runs
+        auto inputNode = m_InputNodes[index];
+        auto& input = inputNode->m_Output;
+        if (static_cast<Operation*>(inputNode)->m_KeepOutput || input.IsAlias() || input.GetShape() != m_Output.GetShape())
+            return false;
+
+        m_Output.TakeData(input);
+        m_Graph->ReleaseOutput(inputNode);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool Operation::TryAliasInput(size_t index, size_t offset)
+    {
+        if (!CanReuseInputMemory(index))
+            return false;
+
+        auto& input = m_InputNodes[index]->m_Output;
+        if (!input.IsAliasOf(m_Output, offset))
+            input.AliasHost(m_Output, offset);
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Operation::UnaliasInputs()
+    {
+        for (auto inputNode : m_InputNodes)
+            inputNode->m_Output.Unalias();
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Operation::RefreshCareAboutGradient()
     {
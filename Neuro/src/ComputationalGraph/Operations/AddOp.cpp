@@ -45,7 +45,13 @@ namespace Neuro
         else
         {
             m_Output.ResizeBatch(max(m_Inputs[0]->Batch(), m_Inputs[1]->Batch()));
-            m_Inputs[0]->Add(*m_Inputs[1], m_Output);
+            // residual connections usually add a freshly computed tensor which isn't used anywhere else
+            if (TryTakeOverInput(1))
+                m_Output.Add(*m_Inputs[0], m_Output);
+            else if (TryTakeOverInput(0))
+                m_Output.Add(*m_Inputs[1], m_Output);
+            else
+                m_Inputs[0]->Add(*m_Inputs[1], m_Output);
         }
     }
 
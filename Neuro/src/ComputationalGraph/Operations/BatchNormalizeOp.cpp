@@ -1,7 +1,12 @@
+#include <mutex>
+
 #include "ComputationalGraph/Operations/BatchNormalizeOp.h"
 
 namespace Neuro
 {
+    // running statistics can be shared between data parallel replicas
+    static mutex g_RunningStatsMtx;
+
     //////////////////////////////////////////////////////////////////////////
     BatchNormalizeOp::BatchNormalizeOp(TensorLike* x, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar, float momentum, float epsilon, const string& name)
         : Operation({ x, gamma, beta, runningMean, runningVar }, name.empty() ? "batch_normalize" : name), m_Epsilon(epsilon), m_Momentum(momentum)
@@ -29,11 +34,40 @@ namespace Neuro
         m_SaveInvVar.Resize(gamma.GetShape());
 
         if (m_Training)
-            m_Inputs[0]->BatchNormTrain(gamma, beta, 1.f - m_Momentum, m_Epsilon, &runningMean, &runningVar, m_SaveMean, m_SaveInvVar, m_Output);
+        {
+            // batch statistics are captured in private tensors and blended into running ones separately, running statistics
+            // are their initial values so nothing changes when batch is too small to be normalized
+            m_BatchMean.Resize(runningMean.GetShape());
+            m_BatchVar.Resize(runningVar.GetShape());
+            runningMean.CopyTo(m_BatchMean);
+            runningVar.CopyTo(m_BatchVar);
+            m_Inputs[0]->BatchNormTrain(gamma, beta, 1.f, m_Epsilon, &m_BatchMean, &m_BatchVar, m_SaveMean, m_SaveInvVar, m_Output);
+            m_RunningStatsPending = true;
+            if (!m_DeferSharedUpdates)
+                ApplySharedUpdates();
+        }
         else
             m_Inputs[0]->BatchNorm(gamma, beta, m_Epsilon, &runningMean, &runningVar, m_Output);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void BatchNormalizeOp::ApplySharedUpdates()
+    {
+        if (!m_RunningStatsPending)
+            return;
+
+        UpdateRunningStats(m_BatchMean, m_BatchVar, m_Momentum, m_InputNodes[3]->Output(), m_InputNodes[4]->Output());
+        m_RunningStatsPending = false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void BatchNormalizeOp::UpdateRunningStats(const Tensor& batchMean, const Tensor& batchVar, float momentum, Tensor& runningMean, Tensor& runningVar)
+    {
+        lock_guard<mutex> lock(g_RunningStatsMtx);
+        runningMean.Add(momentum, 1.f - momentum, batchMean, runningMean);
+        runningVar.Add(momentum, 1.f - momentum, batchVar, runningVar);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void BatchNormalizeOp::ComputeGradientInternal(const Tensor& grad)
     {
@@ -45,11 +45,65 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void ConcatenateOp::ComputeInternal()
     {
-        if (m_Axis == BatchAxis)
-            m_Output.ResizeBatch((uint32_t)m_Inputs.size());
-        else
-            m_Output.ResizeBatch(m_Inputs[0]->Batch());
-        Tensor::Concat(m_Axis, m_Inputs, m_Output);
+        uint32_t batch = m_Axis == BatchAxis ? (uint32_t)m_Inputs.size() : m_Inputs[0]->Batch();
+
+        // during inference producers of contiguous regions write directly into output, there is nothing left to copy for them
+        bool elide = InPlaceAllowed() && InputsContiguous();
+
+        // aliases must be dropped before output buffer gets reallocated or when some of them point to outdated regions
+        bool aliasesValid = elide && m_Output.Batch() == batch;
+        size_t offset = 0;
+        for (auto input : m_Inputs)
+        {
+            if (input->IsAlias() && !input->IsAliasOf(m_Output, offset))
+                aliasesValid = false;
+            offset += input->Length();
+        }
+        if (!aliasesValid)
+            UnaliasInputs();
+
+        m_Output.ResizeBatch(batch);
+
+        if (!elide)
+        {
+            Tensor::Concat(m_Axis, m_Inputs, m_Output);
+            return;
+        }
+
+        m_Output.OverrideHost();
+        offset = 0;
+        for (size_t i = 0; i < m_Inputs.size(); ++i)
+        {
+            auto input = m_Inputs[i];
+            if (!input->IsAliasOf(m_Output, offset))
+            {
+                input->CopyTo(0, m_Output, offset, input->Length());
+                TryAliasInput(i, offset);
+            }
+            offset += input->Length();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ConcatenateOp::InputsContiguous() const
+    {
+        for (int a = m_Axis + 1; a <= BatchAxis; ++a)
+        {
+            if (m_Inputs[0]->Len(a) != 1)
+                return false;
+        }
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool ConcatenateOp::SharesOutputBuffer() const
+    {
+        for (auto input : m_Inputs)
+        {
+            if (input->IsAlias())
+                return true;
+        }
+        return false;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -40,4 +40,12 @@ namespace Neuro
         if (m_InputNodes[1]->CareAboutGradient())
             grad.Conv2DKernelsGradient(x, grad, m_Stride, m_Padding, m_DataFormat, m_InputsGrads[1]);
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t Conv2dOp::Flops() const
+    {
+        // multiply-add for each kernel element of every output element
+        const Shape& kernelsShape = m_InputNodes[1]->GetShape();
+        return 2ull * m_Output.Length() * kernelsShape.Width() * kernelsShape.Height() * kernelsShape.Depth();
+    }
 }
@@ -0,0 +1,166 @@
+#include <cmath>
+
+#include "ComputationalGraph/Operations/Conv2dBatchNormalizeOp.h"
+#include "ComputationalGraph/Operations/BatchNormalizeOp.h"
+
+namespace Neuro
+{
+    static vector<TensorLike*> ConvBatchNormInputNodes(TensorLike* x, TensorLike* kernels, TensorLike* bias, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar)
+    {
+        vector<TensorLike*> inputNodes = { x, kernels, gamma, beta, runningMean, runningVar };
+        if (bias)
+            inputNodes.push_back(bias);
+        return inputNodes;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    Conv2dBatchNormalizeOp::Conv2dBatchNormalizeOp(TensorLike* x, TensorLike* kernels, TensorLike* bias, uint32_t stride, uint32_t padding, TensorLike* gamma, TensorLike* beta, TensorLike* runningMean, TensorLike* runningVar, float momentum, float epsilon, const string& name)
+        : Operation(ConvBatchNormInputNodes(x, kernels, bias, gamma, beta, runningMean, runningVar), name.empty() ? "conv2d_batch_normalize" : name), m_Stride(stride), m_Padding(padding), m_Momentum(momentum), m_Epsilon(epsilon)
+    {
+        if (bias)
+            m_BiasIndex = 6;
+        UpdateOutputShape();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Conv2dBatchNormalizeOp::UpdateOutputShape()
+    {
+        const auto& shape = m_InputNodes[0]->GetShape();
+        const auto& kernelsShape = m_InputNodes[1]->GetShape();
+        m_Output.Resize(Shape::From(Tensor::GetConvOutputShape(shape, kernelsShape.Batch(), kernelsShape.Width(), kernelsShape.Height(), m_Stride, m_Padding, m_Padding, NCHW), shape.Batch()));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Conv2dBatchNormalizeOp::FoldWeights()
+    {
+        vector<uint64_t> versions;
+        for (size_t i = 1; i < m_Inputs.size(); ++i)
+            versions.push_back(m_Inputs[i]->Version());
+
+        if (versions == m_FoldedVersions)
+            return;
+
+        auto& kernels = *m_Inputs[1];
+        auto& gamma = *m_Inputs[2];
+        auto& beta = *m_Inputs[3];
+        auto& runningMean = *m_Inputs[4];
+        auto& runningVar = *m_Inputs[5];
+
+        kernels.CopyToHost();
+        gamma.CopyToHost();
+        beta.CopyToHost();
+        runningMean.CopyToHost();
+        runningVar.CopyToHost();
+
+        m_FoldedKernels.Resize(kernels.GetShape());
+        m_FoldedKernels.OverrideHost();
+        m_FoldedBias.Resize(gamma.GetShape());
+        m_FoldedBias.OverrideHost();
+
+        // each output channel's kernel is scaled by gamma/sqrt(var + eps) and the same scale is applied to shifted bias
+        const uint32_t kernelLen = kernels.Width() * kernels.Height() * kernels.Depth();
+        for (uint32_t o = 0; o < kernels.Batch(); ++o)
+        {
+            float scale = gamma.Values()[o] / ::sqrt(runningVar.Values()[o] + m_Epsilon);
+            const float* kernel = kernels.Values() + o * kernelLen;
+            float* foldedKernel = m_FoldedKernels.Values() + o * kernelLen;
+            for (uint32_t i = 0; i < kernelLen; ++i)
+                foldedKernel[i] = kernel[i] * scale;
+
+            float bias = 0;
+            if (m_BiasIndex >= 0)
+            {
+                m_Inputs[m_BiasIndex]->CopyToHost();
+                bias = m_Inputs[m_BiasIndex]->Values()[o];
+            }
+            m_FoldedBias.Values()[o] = (bias - runningMean.Values()[o]) * scale + beta.Values()[o];
+        }
+
+        m_FoldedVersions = versions;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Conv2dBatchNormalizeOp::ComputeInternal()
+    {
+        auto& x = *m_Inputs[0];
+        auto& kernels = *m_Inputs[1];
+        auto& gamma = *m_Inputs[2];
+        auto& beta = *m_Inputs[3];
+
+        m_Output.ResizeBatch(x.Batch());
+
+        if (!m_Training)
+        {
+            FoldWeights();
+            x.Conv2DBiasActivation(m_FoldedKernels, m_Stride, m_Padding, m_FoldedBias, _Identity, 0, m_Output);
+            return;
+        }
+
+        auto& runningMean = m_InputNodes[4]->Output();
+        auto& runningVar = m_InputNodes[5]->Output();
+
+        m_ConvOutput.Resize(m_Output.GetShape());
+        m_ConvOutput.TryDeviceAllocate();
+        x.Conv2D(kernels, m_Stride, m_Padding, NCHW, m_ConvOutput);
+        if (m_BiasIndex >= 0)
+            m_ConvOutput.Add(*m_Inputs[m_BiasIndex], m_ConvOutput);
+
+        m_SaveMean.Resize(gamma.GetShape());
+        m_SaveInvVar.Resize(gamma.GetShape());
+
+        // same as in BatchNormalizeOp, running statistics are updated separately from normalization
+        m_BatchMean.Resize(runningMean.GetShape());
+        m_BatchVar.Resize(runningVar.GetShape());
+        runningMean.CopyTo(m_BatchMean);
+        runningVar.CopyTo(m_BatchVar);
+        m_ConvOutput.BatchNormTrain(gamma, beta, 1.f, m_Epsilon, &m_BatchMean, &m_BatchVar, m_SaveMean, m_SaveInvVar, m_Output);
+        m_RunningStatsPending = true;
+        if (!m_DeferSharedUpdates)
+            ApplySharedUpdates();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Conv2dBatchNormalizeOp::ApplySharedUpdates()
+    {
+        if (!m_RunningStatsPending)
+            return;
+
+        BatchNormalizeOp::UpdateRunningStats(m_BatchMean, m_BatchVar, m_Momentum, m_InputNodes[4]->Output(), m_InputNodes[5]->Output());
+        m_RunningStatsPending = false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Conv2dBatchNormalizeOp::ComputeGradientInternal(const Tensor& grad)
+    {
+        auto& x = *m_Inputs[0];
+        auto& kernels = *m_Inputs[1];
+        auto& gamma = *m_Inputs[2];
+
+        m_ConvOutputGrad.Resize(m_ConvOutput.GetShape());
+        m_ConvOutputGrad.TryDeviceAllocate(); // this is actually workspace
+        grad.BatchNormGradient(m_ConvOutput, gamma, m_Epsilon, grad, m_SaveMean, m_SaveInvVar, m_InputsGrads[2], m_InputsGrads[3], true, m_ConvOutputGrad);
+
+        if (m_BiasIndex >= 0 && m_InputNodes[m_BiasIndex]->CareAboutGradient())
+            grad.Conv2DBiasGradient(m_ConvOutputGrad, m_InputsGrads[m_BiasIndex]);
+        if (m_InputNodes[1]->CareAboutGradient())
+            grad.Conv2DKernelsGradient(x, m_ConvOutputGrad, m_Stride, m_Padding, NCHW, m_InputsGrads[1]);
+        if (m_InputNodes[0]->CareAboutGradient())
+            grad.Conv2DInputsGradient(m_ConvOutputGrad, kernels, m_Stride, m_Padding, NCHW, m_InputsGrads[0]);
+
+        m_ConvOutputGrad.ReleaseData();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool Conv2dBatchNormalizeOp::ForceAllocInputGradNode(size_t index) const
+    {
+        // batch normalization computes gamma and beta gradients together with gradient of its input
+        return index == 2 || index == 3;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t Conv2dBatchNormalizeOp::Flops() const
+    {
+        const Shape& kernelsShape = m_InputNodes[1]->GetShape();
+        return 2ull * m_Output.Length() * kernelsShape.Width() * kernelsShape.Height() * kernelsShape.Depth() + 2ull * m_Output.Length();
+    }
+}
@@ -64,4 +64,11 @@ namespace Neuro
         if (m_Activation != _Identity)
             m_ActivationInputGrad.ReleaseData();
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t Conv2dBiasActivationOp::Flops() const
+    {
+        const Shape& kernelsShape = m_InputNodes[1]->GetShape();
+        return 2ull * m_Output.Length() * kernelsShape.Width() * kernelsShape.Height() * kernelsShape.Depth() + 2ull * m_Output.Length();
+    }
 }
@@ -39,4 +39,12 @@ namespace Neuro
         if (m_InputNodes[1]->CareAboutGradient())
             grad.Conv2DTransposedKernelsGradient(x, grad, m_Stride, m_Padding, m_DataFormat, m_InputsGrads[1]);
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t Conv2dTransposeOp::Flops() const
+    {
+        // every input element is scattered over kernel area of all output channels
+        const Shape& kernelsShape = m_InputNodes[1]->GetShape();
+        return 2ull * m_InputNodes[0]->GetShape().Length * kernelsShape.Width() * kernelsShape.Height() * kernelsShape.Depth();
+    }
 }
@@ -13,7 +13,7 @@ namespace Neuro
     void ExpOp::ComputeInternal()
     {
         m_Output.ResizeBatch(m_Inputs[0]->Batch());
-        m_Inputs[0]->Map([](float x) {return ::exp(x); }, m_Output);
+        m_Inputs[0]->Exp(m_Output);
     }
 
     //////////////////////////////////////////////////////////////////////////
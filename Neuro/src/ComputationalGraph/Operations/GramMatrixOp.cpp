@@ -0,0 +1,39 @@
+#include "ComputationalGraph/Operations/GramMatrixOp.h"
+
+namespace Neuro
+{
+    //////////////////////////////////////////////////////////////////////////
+    GramMatrixOp::GramMatrixOp(TensorLike* x, float scale, const string& name)
+        : Operation({ x }, name.empty() ? "gram_matrix" : name), m_Scale(scale)
+    {
+        UpdateOutputShape();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GramMatrixOp::UpdateOutputShape()
+    {
+        const Shape& shape = m_InputNodes[0]->GetShape();
+        m_Output.Resize(Shape(shape.Depth(), shape.Depth(), 1, shape.Batch()));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GramMatrixOp::ComputeInternal()
+    {
+        m_Output.ResizeBatch(m_Inputs[0]->Batch());
+        m_Inputs[0]->GramMatrix(m_Scale, m_Output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GramMatrixOp::ComputeGradientInternal(const Tensor& grad)
+    {
+        if (m_InputNodes[0]->CareAboutGradient())
+            m_Inputs[0]->GramMatrixGradient(grad, m_Scale, m_InputsGrads[0]);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t GramMatrixOp::Flops() const
+    {
+        // only half of symmetric output is computed
+        return m_Output.Length() * (uint64_t)m_InputNodes[0]->GetShape().Dim0Dim1;
+    }
+}
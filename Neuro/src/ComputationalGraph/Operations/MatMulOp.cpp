@@ -208,4 +208,25 @@ namespace Neuro
         else
             grad.MatMul(a, m_InputsGrads[0]);
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t MatMulOp::Flops() const
+    {
+        return 2ull * m_Output.Length() * m_InputNodes[0]->GetShape().Width();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t MatMulTransOp::Flops() const
+    {
+        const Shape& aShape = m_InputNodes[0]->GetShape();
+        return 2ull * m_Output.Length() * (m_TransposeA ? aShape.Height() : aShape.Width());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t MatMulSyrkOp::Flops() const
+    {
+        // only half of symmetric output is computed
+        const Shape& aShape = m_InputNodes[0]->GetShape();
+        return m_Output.Length() * (uint64_t)(m_Transpose ? aShape.Height() : aShape.Width());
+    }
 }
\ No newline at end of file
@@ -24,19 +24,30 @@ namespace Neuro
     {
         m_Output.ResizeBatch(m_Inputs[0]->Batch());
 
+        // merge kernels support output aliasing one of the inputs
+        auto inputs = m_Inputs;
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            if (TryTakeOverInput(i))
+            {
+                inputs[i] = &m_Output;
+                break;
+            }
+        }
+
         switch (m_Mode)
         {
         case AvgMerge:
-            Tensor::MergeAvg(m_Inputs, m_Output);
+            Tensor::MergeAvg(inputs, m_Output);
             break;
         case MaxMerge:
-            Tensor::MergeMax(m_Inputs, m_Output);
+            Tensor::MergeMax(inputs, m_Output);
             break;
         case MinMerge:
-            Tensor::MergeMin(m_Inputs, m_Output);
+            Tensor::MergeMin(inputs, m_Output);
             break;
         case SumMerge:
-            Tensor::MergeSum(m_Inputs, m_Output);
+            Tensor::MergeSum(inputs, m_Output);
             break;
         }
     }
@@ -50,4 +50,18 @@ namespace Neuro
         m_Output.ResizeBatch(x.Batch());
         x.ReflectPad2D(m_Left, m_Right, m_Top, m_Bottom, m_Output);
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    LinearRampPad2dOp::LinearRampPad2dOp(TensorLike* x, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, float endValue, const string& name)
+        : Pad2dOp(x, left, right, top, bottom, name.empty() ? "linear_ramp_pad2d" : name), m_EndValue(endValue)
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void LinearRampPad2dOp::ComputeInternal()
+    {
+        auto& x = *m_Inputs[0];
+        m_Output.ResizeBatch(x.Batch());
+        x.LinearRampPad2D(m_Left, m_Right, m_Top, m_Bottom, m_EndValue, m_Output);
+    }
 }
\ No newline at end of file
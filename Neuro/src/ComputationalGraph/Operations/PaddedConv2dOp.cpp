@@ -0,0 +1,119 @@
+#include "ComputationalGraph/Operations/PaddedConv2dOp.h"
+#include "Tensors/TensorOpCpu.h"
+
+namespace Neuro
+{
+    //////////////////////////////////////////////////////////////////////////
+    PaddedConv2dOp::PaddedConv2dOp(TensorLike* x, TensorLike* kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, TensorLike* bias, EActivation activation, float activationAlpha, const string& name)
+        : Operation(bias ? vector<TensorLike*>{ x, kernels, bias } : vector<TensorLike*>{ x, kernels }, name.empty() ? "padded_conv2d" : name), m_Stride(stride), m_Left(left), m_Right(right), m_Top(top), m_Bottom(bottom), m_Border(border), m_BorderValue(borderValue), m_UseBias(bias != nullptr), m_Activation(activation), m_ActivationAlpha(activationAlpha)
+    {
+        UpdateOutputShape();
+        m_ActivationInputGrad.Name(name + "/activation_input_grad");
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void PaddedConv2dOp::UpdateOutputShape()
+    {
+        const auto& shape = m_InputNodes[0]->GetShape();
+        const auto& kernelsShape = m_InputNodes[1]->GetShape();
+        Shape paddedShape(shape.Width() + m_Left + m_Right, shape.Height() + m_Top + m_Bottom, shape.Depth(), shape.Batch());
+        m_Output.Resize(Tensor::GetConvOutputShape(paddedShape, kernelsShape.Batch(), kernelsShape.Width(), kernelsShape.Height(), m_Stride, 0, 0, NCHW));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void PaddedConv2dOp::Pad(const Tensor& x, Tensor& output) const
+    {
+        output.Resize(Shape(x.Width() + m_Left + m_Right, x.Height() + m_Top + m_Bottom, x.Depth(), x.Batch()));
+        if (m_Border == ConstantBorder)
+            x.ConstantPad2D(m_Left, m_Right, m_Top, m_Bottom, m_BorderValue, output);
+        else if (m_Border == ReflectBorder)
+            x.ReflectPad2D(m_Left, m_Right, m_Top, m_Bottom, output);
+        else
+            x.LinearRampPad2D(m_Left, m_Right, m_Top, m_Bottom, m_BorderValue, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void PaddedConv2dOp::ComputeInternal()
+    {
+        auto& x = *m_Inputs[0];
+        auto& kernels = *m_Inputs[1];
+
+        m_Output.ResizeBatch(x.Batch());
+
+        if (Tensor::ActiveOp()->OpMode() == GPU)
+        {
+            Pad(x, m_Padded);
+            if (m_UseBias)
+                m_Padded.Conv2DBiasActivation(kernels, m_Stride, 0, *m_Inputs[2], m_Activation, m_ActivationAlpha, m_Output);
+            else
+            {
+                m_Padded.Conv2D(kernels, m_Stride, 0, NCHW, m_Output);
+                if (m_Activation != _Identity)
+                    m_Output.Activation(m_Activation, m_ActivationAlpha, m_Output);
+            }
+            return;
+        }
+
+        x.PaddedConv2D(kernels, m_Stride, m_Left, m_Right, m_Top, m_Bottom, m_Border, m_BorderValue, m_Output);
+        if (m_UseBias)
+            m_Output.Add(*m_Inputs[2], m_Output);
+        if (m_Activation != _Identity)
+            m_Output.Activation(m_Activation, m_ActivationAlpha, m_Output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void PaddedConv2dOp::ComputeGradientInternal(const Tensor& grad)
+    {
+        auto& x = *m_Inputs[0];
+        auto& kernels = *m_Inputs[1];
+
+        const Tensor* outputGrad = &grad;
+
+        if (m_Activation != _Identity)
+        {
+            m_ActivationInputGrad.Resize(grad.GetShape());
+            m_ActivationInputGrad.TryDeviceAllocate(); // this is actually workspace
+
+            grad.ActivationGradient(m_Activation, m_ActivationAlpha, m_Output, grad, m_ActivationInputGrad);
+            outputGrad = &m_ActivationInputGrad;
+        }
+
+        if (m_UseBias && m_InputNodes[2]->CareAboutGradient())
+            grad.Conv2DBiasGradient(*outputGrad, m_InputsGrads[2]);
+
+        if (Tensor::ActiveOp()->OpMode() == GPU)
+        {
+            // same as unfused pad followed by convolution, gradient of border taps is dropped by Pad2DGradient (CPU kernel
+            // drops them as well)
+            if (m_InputNodes[0]->CareAboutGradient())
+            {
+                m_Padded.Resize(Shape(x.Width() + m_Left + m_Right, x.Height() + m_Top + m_Bottom, x.Depth(), x.Batch()));
+                grad.Conv2DInputsGradient(*outputGrad, kernels, m_Stride, 0, NCHW, m_Padded);
+                m_Padded.Pad2DGradient(m_Padded, m_Left, m_Right, m_Top, m_Bottom, m_InputsGrads[0]);
+            }
+            if (m_InputNodes[1]->CareAboutGradient())
+            {
+                Pad(x, m_Padded);
+                grad.Conv2DKernelsGradient(m_Padded, *outputGrad, m_Stride, 0, NCHW, m_InputsGrads[1]);
+            }
+        }
+        else
+        {
+            if (m_InputNodes[0]->CareAboutGradient())
+                grad.PaddedConv2DInputsGradient(*outputGrad, kernels, m_Stride, m_Left, m_Right, m_Top, m_Bottom, m_Border, m_InputsGrads[0]);
+            if (m_InputNodes[1]->CareAboutGradient())
+                grad.PaddedConv2DKernelsGradient(x, *outputGrad, m_Stride, m_Left, m_Right, m_Top, m_Bottom, m_Border, m_BorderValue, m_InputsGrads[1]);
+        }
+
+        if (m_Activation != _Identity)
+            m_ActivationInputGrad.ReleaseData();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t PaddedConv2dOp::Flops() const
+    {
+        // multiply-add for each kernel element of every output element
+        const Shape& kernelsShape = m_InputNodes[1]->GetShape();
+        return 2ull * m_Output.Length() * kernelsShape.Width() * kernelsShape.Height() * kernelsShape.Depth() + (m_UseBias ? m_Output.Length() : 0) + (m_Activation != _Identity ? m_Output.Length() : 0);
+    }
+}
@@ -1,4 +1,5 @@
 #include "ComputationalGraph/Operations/Pool2dOp.h"
+#include "Tensors/TensorOpCpu.h"
 
 namespace Neuro
 {
@@ -21,13 +22,26 @@ namespace Neuro
     void Pool2dOp::ComputeInternal()
     {
         m_Output.ResizeBatch(m_Inputs[0]->Batch());
-        m_Inputs[0]->Pool2D(m_FilterSize, m_Stride, m_Mode, m_Padding, m_DataFormat, m_Output);
+
+        m_MaxIndicesSaved = m_Mode == MaxPool && Tensor::ActiveOp()->OpMode() != GPU && m_FilterSize * m_FilterSize <= 256;
+        if (m_MaxIndicesSaved)
+        {
+            m_MaxIndices.resize(m_Output.Length());
+            m_Inputs[0]->MaxPool2D(m_FilterSize, m_Stride, m_Padding, m_DataFormat, m_Output, m_MaxIndices.data());
+        }
+        else
+            m_Inputs[0]->Pool2D(m_FilterSize, m_Stride, m_Mode, m_Padding, m_DataFormat, m_Output);
     }
 
     //////////////////////////////////////////////////////////////////////////
     void Pool2dOp::ComputeGradientInternal(const Tensor& grad)
     {
-        if (m_InputNodes[0]->CareAboutGradient())
+        if (!m_InputNodes[0]->CareAboutGradient())
+            return;
+
+        if (m_MaxIndicesSaved)
+            grad.MaxPool2DGradient(m_MaxIndices.data(), m_FilterSize, m_Stride, m_Padding, m_DataFormat, m_InputsGrads[0]);
+        else
             m_Inputs[0]->Pool2DGradient(m_Output, *m_Inputs[0], grad, m_FilterSize, m_Stride, m_Mode, m_Padding, m_DataFormat, m_InputsGrads[0]);
     }
 }
\ No newline at end of file
@@ -40,7 +40,7 @@ namespace Neuro
         if (m_InputNodes.size() > 1 && m_InputNodes[1]->CareAboutGradient())
         {
             //in_grad2 = grad * x^(p) * log(x)
-            grad.Map([&](float g, float x) {return g * ::pow(x, power) * ::log(x); }, *m_Inputs[0], m_InputsGrads[1]);
+            grad.Zip([&](float g, float x) {return g * ::pow(x, power) * ::log(x); }, *m_Inputs[0], m_InputsGrads[1]);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "ComputationalGraph/Operations/UpSampleConv2dOp.h"
+#include "Tensors/TensorOpCpu.h"
+
+namespace Neuro
+{
+    //////////////////////////////////////////////////////////////////////////
+    UpSampleConv2dOp::UpSampleConv2dOp(TensorLike* x, TensorLike* kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, TensorLike* bias, EActivation activation, float activationAlpha, const string& name)
+        : Operation(bias ? vector<TensorLike*>{ x, kernels, bias } : vector<TensorLike*>{ x, kernels }, name.empty() ? "upsample_conv2d" : name), m_ScaleFactor(scaleFactor), m_Stride(stride), m_Padding(padding), m_UseBias(bias != nullptr), m_Activation(activation), m_ActivationAlpha(activationAlpha)
+    {
+        UpdateOutputShape();
+        m_ActivationInputGrad.Name(name + "/activation_input_grad");
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void UpSampleConv2dOp::UpdateOutputShape()
+    {
+        const auto& shape = m_InputNodes[0]->GetShape();
+        const auto& kernelsShape = m_InputNodes[1]->GetShape();
+        Shape upSampledShape(shape.Width() * m_ScaleFactor, shape.Height() * m_ScaleFactor, shape.Depth(), shape.Batch());
+        m_Output.Resize(Tensor::GetConvOutputShape(upSampledShape, kernelsShape.Batch(), kernelsShape.Width(), kernelsShape.Height(), m_Stride, m_Padding, m_Padding, NCHW));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void UpSampleConv2dOp::ComputeInternal()
+    {
+        auto& x = *m_Inputs[0];
+        auto& kernels = *m_Inputs[1];
+
+        m_Output.ResizeBatch(x.Batch());
+
+        if (Tensor::ActiveOp()->OpMode() == GPU)
+        {
+            m_UpSampled.Resize(Shape(x.Width() * m_ScaleFactor, x.Height() * m_ScaleFactor, x.Depth(), x.Batch()));
+            x.UpSample2D(m_ScaleFactor, m_UpSampled);
+            if (m_UseBias)
+                m_UpSampled.Conv2DBiasActivation(kernels, m_Stride, m_Padding, *m_Inputs[2], m_Activation, m_ActivationAlpha, m_Output);
+            else
+            {
+                m_UpSampled.Conv2D(kernels, m_Stride, m_Padding, NCHW, m_Output);
+                if (m_Activation != _Identity)
+                    m_Output.Activation(m_Activation, m_ActivationAlpha, m_Output);
+            }
+            return;
+        }
+
+        x.UpSampleConv2D(kernels, m_ScaleFactor, m_Stride, m_Padding, m_Output);
+        if (m_UseBias)
+            m_Output.Add(*m_Inputs[2], m_Output);
+        if (m_Activation != _Identity)
+            m_Output.Activation(m_Activation, m_ActivationAlpha, m_Output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void UpSampleConv2dOp::ComputeGradientInternal(const Tensor& grad)
+    {
+        auto& x = *m_Inputs[0];
+        auto& kernels = *m_Inputs[1];
+
+        const Tensor* outputGrad = &grad;
+
+        if (m_Activation != _Identity)
+        {
+            m_ActivationInputGrad.Resize(grad.GetShape());
+            m_ActivationInputGrad.TryDeviceAllocate(); // this is actually workspace
+
+            grad.ActivationGradient(m_Activation, m_ActivationAlpha, m_Output, grad, m_ActivationInputGrad);
+            outputGrad = &m_ActivationInputGrad;
+        }
+
+        if (m_UseBias && m_InputNodes[2]->CareAboutGradient())
+            grad.Conv2DBiasGradient(*outputGrad, m_InputsGrads[2]);
+
+        if (Tensor::ActiveOp()->OpMode() == GPU)
+        {
+            // single upsampled-size buffer holds either convolution input gradient or recomputed upsampled input
+            m_UpSampled.Resize(Shape(x.Width() * m_ScaleFactor, x.Height() * m_ScaleFactor, x.Depth(), x.Batch()));
+            if (m_InputNodes[0]->CareAboutGradient())
+            {
+                grad.Conv2DInputsGradient(*outputGrad, kernels, m_Stride, m_Padding, NCHW, m_UpSampled);
+                m_UpSampled.UpSample2DGradient(m_UpSampled, m_ScaleFactor, m_InputsGrads[0]);
+            }
+            if (m_InputNodes[1]->CareAboutGradient())
+            {
+                x.UpSample2D(m_ScaleFactor, m_UpSampled);
+                grad.Conv2DKernelsGradient(m_UpSampled, *outputGrad, m_Stride, m_Padding, NCHW, m_InputsGrads[1]);
+            }
+        }
+        else
+        {
+            if (m_InputNodes[0]->CareAboutGradient())
+                grad.UpSampleConv2DInputsGradient(*outputGrad, kernels, m_ScaleFactor, m_Stride, m_Padding, m_InputsGrads[0]);
+            if (m_InputNodes[1]->CareAboutGradient())
+                grad.UpSampleConv2DKernelsGradient(x, *outputGrad, m_ScaleFactor, m_Stride, m_Padding, m_InputsGrads[1]);
+        }
+
+        if (m_Activation != _Identity)
+            m_ActivationInputGrad.ReleaseData();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t UpSampleConv2dOp::Flops() const
+    {
+        // multiply-add for each kernel element of every output element
+        const Shape& kernelsShape = m_InputNodes[1]->GetShape();
+        return 2ull * m_Output.Length() * kernelsShape.Width() * kernelsShape.Height() * kernelsShape.Depth() + (m_UseBias ? m_Output.Length() : 0) + (m_Activation != _Identity ? m_Output.Length() : 0);
+    }
+}
@@ -1,14 +1,18 @@
+#include <algorithm>
 #include <map>
 
 #include "ComputationalGraph/Predicter.h"
 #include "ComputationalGraph/Session.h"
 #include "ComputationalGraph/Graph.h"
+#include "ComputationalGraph/Operation.h"
+#include "ComputationalGraph/Placeholder.h"
 #include "Tensors/Tensor.h"
 
 namespace Neuro
 {
     //////////////////////////////////////////////////////////////////////////
-    Predicter::Predicter(const vector<Placeholder*>& inputPlaceholders, const vector<TensorLike*>& outputOps)
+    Predicter::Predicter(const vector<Placeholder*>& inputPlaceholders, const vector<TensorLike*>& outputOps, bool isolated)
+        : m_Isolated(isolated)
     {
         m_InputPlaceholders = inputPlaceholders;
         m_OutputOps = outputOps;
@@ -17,6 +21,20 @@ namespace Neuro
 
         NEURO_ASSERT(!isTraining, "Fetching training operation in predictor.");
 
+        if (m_Isolated)
+        {
+            // shared nodes are initialized once here, afterwards they are only read by operations
+            Graph::Default()->InitVariables();
+            m_Order.erase(remove_if(m_Order.begin(), m_Order.end(), [&](TensorLike* node)
+            {
+                return !node->IsOp() && find(m_InputPlaceholders.begin(), m_InputPlaceholders.end(), node) == m_InputPlaceholders.end();
+            }), m_Order.end());
+
+            // device reference counting of shared inputs is not thread-safe
+            for (auto node : m_Order)
+                NEURO_ASSERT(!node->IsOp() || static_cast<Operation*>(node)->OpMode() != GPU, "Isolated predicter supports only CPU modes, '" << node->Name() << "' runs on GPU.");
+        }
+
         for (size_t i = 0; i < m_InputPlaceholders.size(); ++i)
             m_Feeds[m_InputPlaceholders[i]] = nullptr;
     }
@@ -28,12 +46,16 @@ namespace Neuro
         for (size_t i = 0; i < m_InputPlaceholders.size(); ++i)
             m_Feeds[m_InputPlaceholders[i]] = inputs[i];
 
+        if (m_Isolated)
+            return Session::Default()->RunIsolated(m_Order, m_OutputOps, m_Feeds);
         return Session::Default()->RunInOrder(m_Order, m_OutputOps, m_Feeds, false);
     }
 
     //////////////////////////////////////////////////////////////////////////
     tensor_ptr_vec_t Predicter::Eval(const map<Placeholder*, const Tensor*>& feeds)
     {
+        if (m_Isolated)
+            return Session::Default()->RunIsolated(m_Order, m_OutputOps, feeds);
         return Session::Default()->RunInOrder(m_Order, m_OutputOps, feeds, false);
     }
 }
\ No newline at end of file
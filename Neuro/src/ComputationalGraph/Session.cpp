@@ -1,4 +1,6 @@
-﻿#include "ComputationalGraph/Session.h"
+﻿#include <cstring>
+
+#include "ComputationalGraph/Session.h"
 #include "ComputationalGraph/Graph.h"
 #include "ComputationalGraph/Operation.h"
 #include "ComputationalGraph/Placeholder.h"
@@ -6,6 +8,7 @@
 #include "Tensors/Tensor.h"
 #include "Tools.h"
 #include "Debug.h"
+#include "Profiler.h"
 
 //#define ENABLE_SESSION_LOGS
 
@@ -21,6 +24,14 @@ namespace Neuro
 {
     Session* Session::s_Default = nullptr;
 
+    //////////////////////////////////////////////////////////////////////////
+    static bool SameValues(const Tensor& a, const Tensor& b)
+    {
+        if (&a == &b || a.GetShape() != b.GetShape() || !a.IsOnHost() || !b.IsOnHost())
+            return false;
+        return memcmp(a.Values(), b.Values(), a.Length() * sizeof(float)) == 0;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     Session::Session(Graph* graph)
     {
@@ -70,14 +81,10 @@ namespace Neuro
     {
         m_Graph->InitVariables();
         m_Graph->IncrementStep();
+        Feed(feeds, training);
 
-        for (auto feed : feeds)
-        {
-            SESSION_DEBUG_INFO("##Session: Feeding '%s'...\n", feed.first->Name().c_str());
-            feed.first->m_Output.ResizeBatch(feed.second->Batch());
-            NEURO_ASSERT(feed.second->GetShape() == feed.first->m_Output.GetShape(), "Mismatched feed shape. Expected: " << feed.first->m_Output.GetShape().ToString() << " received: " << feed.second->GetShape().ToString());
-            feed.second->CopyTo(feed.first->m_Output);
-        }
+        // when checkpointing is enabled activations are released as soon as they are consumed and recomputed during backward pass
+        auto releaseSchedule = training ? m_Graph->BuildReleaseSchedule(order, fetches) : vector<vector<TensorLike*>>(order.size());
 
         for (size_t n = 0; n < order.size(); ++n)
         {
@@ -89,39 +96,178 @@ namespace Neuro
                 node->Prefetch();
             }*/
 
-            auto node = order[n];
+            ComputeNode(order[n], fetches, training);
 
-            NVTXProfile p(node->Name().c_str(), 0xFFD67FFF);
+            for (auto releasedNode : releaseSchedule[n])
+                m_Graph->ReleaseOutput(releasedNode);
+        }
 
-            bool isFetched = find(fetches.begin(), fetches.end(), node) != fetches.end();
-            node->SetFetched(isFetched);
-            node->Output().ResetRef(isFetched ? 1 : 0); // lock fetches outputs so they don't get completely released 
-            
-            if (node->IsOp())
+        Debug::Step();
+
+        return Fetch(fetches);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    vector<Tensor*> Session::RunInOrder(const ReplicatedOrder& order, const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds, bool training)
+    {
+        NEURO_ASSERT(!training || m_Graph->Checkpointing() == NoCheckpointing, "Checkpointing is not supported for replicated graphs.");
+
+        m_Graph->InitVariables();
+        m_Graph->IncrementStep();
+        Feed(feeds, training);
+
+        for (auto node : order.prologue)
+            ComputeNode(node, fetches, training);
+
+        // operations nested in replica threads run single-threaded (nested parallelism is disabled), so each replica
+        // effectively occupies one core
+        const int replicasNum = (int)order.replicas.size();
+        for (int r = 0; r < replicasNum; ++r)
+        {
+            for (auto node : order.replicas[r])
             {
-                SESSION_DEBUG_INFO("##Session: Computing '%s'...\n", node->Name().c_str());
-                Operation* op = static_cast<Operation*>(node);
-                op->Compute(training);
+                if (node->IsOp())
+                    static_cast<Operation*>(node)->DeferSharedUpdates(true);
+            }
+        }
 
-                if (Debug::ShouldLogOutput(node->Name()))
-                {
-                    for (size_t i = 0; i < op->Inputs().size(); ++i)
-                    {
-                        //op->Inputs()[i]->Validate();
-                        op->Inputs()[i]->DebugDumpValues(node->Name() + "_input" + to_string(i) + "_step" + to_string(Debug::GetStep()) + ".log");
-                    }
-                }
+        #pragma omp parallel for num_threads(replicasNum) schedule(static, 1)
+        for (int r = 0; r < replicasNum; ++r)
+        {
+            for (auto node : order.replicas[r])
+                ComputeNode(node, fetches, training);
+        }
+
+        // shared state (like running statistics) is updated once all replicas are done, always in the same order so results
+        // are deterministic
+        for (int r = 0; r < replicasNum; ++r)
+        {
+            for (auto node : order.replicas[r])
+            {
+                if (!node->IsOp())
+                    continue;
+                auto op = static_cast<Operation*>(node);
+                op->ApplySharedUpdates();
+                op->DeferSharedUpdates(false);
             }
+        }
+
+        for (auto node : order.epilogue)
+            ComputeNode(node, fetches, training);
+
+        Debug::Step();
+
+        return Fetch(fetches);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    vector<Tensor*> Session::RunIsolated(const vector<TensorLike*>& order, const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds)
+    {
+        Feed(feeds, false);
+
+        for (auto node : order)
+            ComputeNode(node, fetches, false);
+
+        return Fetch(fetches);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    shared_future<vector<Tensor>> Session::RunAsync(const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds)
+    {
+        auto& staging = m_Staging[m_StagingIdx];
+        m_StagingIdx ^= 1;
+
+        // step before previous one has to finish before its staging buffers can be reused
+        if (staging.step.valid())
+            staging.step.wait();
+
+        map<Placeholder*, const Tensor*> stagedFeeds;
+        for (auto feed : feeds)
+        {
+            auto& staged = staging.feeds[feed.first];
+            if (staged.GetShape() != feed.second->GetShape())
+                staged.Resize(feed.second->GetShape());
+            feed.second->CopyTo(staged);
+            stagedFeeds[feed.first] = &staged;
+        }
+
+        auto previousStep = m_LastAsyncStep;
+        staging.step = m_LastAsyncStep = async(launch::async, [=]()
+        {
+            if (previousStep.valid())
+                previousStep.wait();
+
+            // fetched outputs will be overwritten by the next step, which may start before caller accesses them
+            vector<Tensor> results;
+            for (auto fetched : Run(fetches, stagedFeeds))
+                results.push_back(*fetched);
+            return results;
+        }).share();
+
+        return m_LastAsyncStep;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Session::Sync()
+    {
+        if (m_LastAsyncStep.valid())
+            m_LastAsyncStep.wait();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Session::Feed(const map<Placeholder*, const Tensor*>& feeds, bool training)
+    {
+        // training batches practically never repeat and operations propagating gradient are recomputed anyway, comparing
+        // feeds would only add a full pass over inputs to every step
+        const bool skipSameValues = m_Graph->MemoizationEnabled() && !training;
+
+        for (auto feed : feeds)
+        {
+            SESSION_DEBUG_INFO("##Session: Feeding '%s'...\n", feed.first->Name().c_str());
+            feed.first->m_Output.ResizeBatch(feed.second->Batch());
+            NEURO_ASSERT(feed.second->GetShape() == feed.first->m_Output.GetShape(), "Mismatched feed shape. Expected: " << feed.first->m_Output.GetShape().ToString() << " received: " << feed.second->GetShape().ToString());
+            // skipping copy of the same values keeps placeholder's version intact so operations depending on it can reuse their outputs
+            if (skipSameValues && SameValues(*feed.second, feed.first->m_Output))
+                continue;
+            feed.second->CopyTo(feed.first->m_Output);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Session::ComputeNode(TensorLike* node, const vector<TensorLike*>& fetches, bool training)
+    {
+        NVTXProfile p(node->Name().c_str(), 0xFFD67FFF);
+
+        bool isFetched = find(fetches.begin(), fetches.end(), node) != fetches.end();
+        node->SetFetched(isFetched);
+        node->Output().ResetRef(isFetched ? 1 : 0); // lock fetches outputs so they don't get completely released 
+            
+        if (node->IsOp())
+        {
+            SESSION_DEBUG_INFO("##Session: Computing '%s'...\n", node->Name().c_str());
+            Operation* op = static_cast<Operation*>(node);
+            op->Compute(training);
 
             if (Debug::ShouldLogOutput(node->Name()))
             {
-                //node->Output().Validate();
-                node->Output().DebugDumpValues(node->Name() + "_output0_step" + to_string(Debug::GetStep()) + ".log");
+                for (size_t i = 0; i < op->Inputs().size(); ++i)
+                {
+                    //op->Inputs()[i]->Validate();
+                    op->Inputs()[i]->DebugDumpValues(node->Name() + "_input" + to_string(i) + "_step" + to_string(Debug::GetStep()) + ".log");
+                }
             }
         }
 
-        Debug::Step();
+        if (Debug::ShouldLogOutput(node->Name()))
+        {
+            //node->Output().Validate();
+            node->Output().DebugDumpValues(node->Name() + "_output0_step" + to_string(Debug::GetStep()) + ".log");
+        }
+    }
 
+    //////////////////////////////////////////////////////////////////////////
+    vector<Tensor*> Session::Fetch(const vector<TensorLike*>& fetches) const
+    {
         vector<Tensor*> result(fetches.size());
         for (size_t i = 0; i < fetches.size(); ++i)
             result[i] = fetches[i]->OutputPtr();
@@ -131,7 +277,40 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void Session::Clear()
     {
+        Sync();
+        for (auto& staging : m_Staging)
+            staging = StagedFeeds();
         m_OrderCache.clear();
         m_Graph->Clear();
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Session::EnableProfiling(bool enable)
+    {
+        Profiler::Enable(enable);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool Session::IsProfilingEnabled() const
+    {
+        return Profiler::IsEnabled();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Session::ClearProfile()
+    {
+        Profiler::Clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Session::ExportProfileTrace(const string& filename) const
+    {
+        Profiler::ExportChromeTrace(filename);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    string Session::ProfileSummary() const
+    {
+        return Profiler::Summary();
+    }
 }
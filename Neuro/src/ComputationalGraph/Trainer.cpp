@@ -1,4 +1,6 @@
 #include <map>
+#include <numeric>
+#include <unordered_set>
 
 #include "ComputationalGraph/Trainer.h"
 #include "ComputationalGraph/Session.h"
@@ -9,7 +11,16 @@ namespace Neuro
 {
     //////////////////////////////////////////////////////////////////////////
     Trainer::Trainer(const vector<Placeholder*>& inputPlaceholders, const vector<Placeholder*>& targetPlaceholders, const vector<TensorLike*>& fetchOps)
+        : Trainer(vector<vector<Placeholder*>>{ inputPlaceholders }, vector<vector<Placeholder*>>{ targetPlaceholders }, {}, fetchOps)
     {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    Trainer::Trainer(const vector<vector<Placeholder*>>& inputPlaceholders, const vector<vector<Placeholder*>>& targetPlaceholders, const vector<vector<TensorLike*>>& replicasFetches, const vector<TensorLike*>& fetchOps)
+    {
+        NEURO_ASSERT(inputPlaceholders.size() == targetPlaceholders.size(), "Mismatched number of replicas' inputs and targets.");
+        NEURO_ASSERT(inputPlaceholders.size() == 1 || inputPlaceholders.size() == replicasFetches.size(), "Each replica has to have its fetches.");
+
         m_InputPlaceholders = inputPlaceholders;
         m_TargetPlaceholders = targetPlaceholders;
         m_FetchOps = fetchOps;
@@ -18,23 +29,71 @@ namespace Neuro
 
         NEURO_ASSERT(isTraining, "There is no training operation fetched in trainer.");
 
-        for (size_t i = 0; i < m_InputPlaceholders.size(); ++i)
-            m_Feeds[m_InputPlaceholders[i]] = nullptr;
-        for (size_t i = 0; i < m_TargetPlaceholders.size(); ++i)
-            m_Feeds[m_TargetPlaceholders[i]] = nullptr;
+        if (m_InputPlaceholders.size() > 1)
+        {
+            vector<unordered_set<TensorLike*>> replicasNodes;
+            for (auto& fetches : replicasFetches)
+            {
+                vector<TensorLike*> replicaOrder;
+                Graph::Default()->BuildForwardOrder(fetches, replicaOrder);
+                replicasNodes.push_back(unordered_set<TensorLike*>(replicaOrder.begin(), replicaOrder.end()));
+            }
+
+            m_ReplicatedOrder = Graph::Default()->SplitOrder(m_Order, replicasNodes, false);
+            m_InputShards.resize(m_InputPlaceholders.size());
+            m_TargetShards.resize(m_TargetPlaceholders.size());
+        }
+
+        for (auto& placeholders : m_InputPlaceholders)
+        for (auto placeholder : placeholders)
+            m_Feeds[placeholder] = nullptr;
+        for (auto& placeholders : m_TargetPlaceholders)
+        for (auto placeholder : placeholders)
+            m_Feeds[placeholder] = nullptr;
     }
 
     //////////////////////////////////////////////////////////////////////////
     tensor_ptr_vec_t Trainer::Train(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs)
     {
-        NEURO_ASSERT(inputs.size() == m_InputPlaceholders.size(), "Mismatched number of inputs, expected " << m_InputPlaceholders.size() << " received " << inputs.size() << ".");
-        for (size_t i = 0; i < m_InputPlaceholders.size(); ++i)
-            m_Feeds[m_InputPlaceholders[i]] = inputs[i];
+        NEURO_ASSERT(inputs.size() == m_InputPlaceholders[0].size(), "Mismatched number of inputs, expected " << m_InputPlaceholders[0].size() << " received " << inputs.size() << ".");
+        NEURO_ASSERT(outputs.size() == m_TargetPlaceholders[0].size(), "Mismatched number of outputs, expected " << m_TargetPlaceholders[0].size() << " received " << outputs.size() << ".");
+
+        if (m_InputPlaceholders.size() == 1)
+        {
+            for (size_t i = 0; i < inputs.size(); ++i)
+                m_Feeds[m_InputPlaceholders[0][i]] = inputs[i];
+            for (size_t i = 0; i < outputs.size(); ++i)
+                m_Feeds[m_TargetPlaceholders[0][i]] = outputs[i];
+
+            return Session::Default()->RunInOrder(m_Order, m_FetchOps, m_Feeds, true);
+        }
+
+        NEURO_ASSERT(inputs[0]->Batch() >= m_InputPlaceholders.size(), "Batch size " << inputs[0]->Batch() << " is smaller than number of replicas " << m_InputPlaceholders.size() << ".");
+
+        FeedReplicas(m_InputPlaceholders, inputs, m_InputShards);
+        FeedReplicas(m_TargetPlaceholders, outputs, m_TargetShards);
+
+        return Session::Default()->RunInOrder(m_ReplicatedOrder, m_FetchOps, m_Feeds, true);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Trainer::FeedReplicas(const vector<vector<Placeholder*>>& placeholders, const const_tensor_ptr_vec_t& tensors, vector<vector<Tensor>>& shards)
+    {
+        const uint32_t replicasNum = (uint32_t)placeholders.size();
+        const uint32_t batch = tensors[0]->Batch();
 
-        NEURO_ASSERT(outputs.size() == m_TargetPlaceholders.size(), "Mismatched number of outputs, expected " << m_TargetPlaceholders.size() << " received " << outputs.size() << ".");
-        for (size_t i = 0; i < m_TargetPlaceholders.size(); ++i)
-            m_Feeds[m_TargetPlaceholders[i]] = outputs[i];
+        for (uint32_t r = 0; r < replicasNum; ++r)
+        {
+            vector<uint32_t> indices((r + 1) * batch / replicasNum - r * batch / replicasNum);
+            iota(indices.begin(), indices.end(), r * batch / replicasNum);
 
-        return Session::Default()->RunInOrder(m_Order, m_FetchOps, m_Feeds, true);
+            shards[r].resize(tensors.size());
+            for (size_t i = 0; i < tensors.size(); ++i)
+            {
+                shards[r][i].Resize(Shape::From(tensors[i]->GetShape(), (uint32_t)indices.size()));
+                tensors[i]->GetBatches(indices, shards[r][i]);
+                m_Feeds[placeholders[r][i]] = &shards[r][i];
+            }
+        }
     }
-}
\ No newline at end of file
+}
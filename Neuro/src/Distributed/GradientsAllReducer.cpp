@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "Distributed/GradientsAllReducer.h"
+#include "Distributed/Communicator.h"
+#include "ComputationalGraph/Variable.h"
+#include "Tensors/Tensor.h"
+#include "Tools.h"
+
+namespace Neuro
+{
+    //////////////////////////////////////////////////////////////////////////
+    GradientsAllReducer::GradientsAllReducer(Communicator* communicator, size_t bucketSizeInBytes)
+        : m_Communicator(communicator), m_BucketSize(bucketSizeInBytes / sizeof(float))
+    {
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    GradientsAllReducer::~GradientsAllReducer()
+    {
+        if (m_Pending.valid())
+            m_Pending.wait();
+        DeleteContainer(m_Buckets);
+        delete m_Current;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GradientsAllReducer::GradientReady(Variable* var)
+    {
+        if (m_Communicator->WorldSize() == 1)
+            return;
+
+        if (!m_Current)
+            m_Current = new Bucket();
+
+        const float weight = m_LocalWeight < 0 ? 1.f / m_Communicator->WorldSize() : m_LocalWeight;
+
+        auto& grad = var->OutputGrad();
+        grad.CopyToHost();
+        m_Current->vars.push_back(var);
+        const float* gradData = grad.Values();
+        for (uint32_t i = 0; i < grad.Length(); ++i)
+            m_Current->data.push_back(gradData[i] * weight);
+
+        if (m_Current->data.size() >= m_BucketSize)
+            Flush();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GradientsAllReducer::Flush()
+    {
+        if (!m_Current)
+            return;
+
+        Bucket* bucket = m_Current;
+        m_Current = nullptr;
+        m_Buckets.push_back(bucket);
+
+        // buckets are chained so they are reduced in the same order in all processes
+        auto previous = m_Pending;
+        auto communicator = m_Communicator;
+        m_Pending = async(launch::async, [previous, communicator, bucket]()
+        {
+            if (previous.valid())
+                previous.wait();
+            communicator->AllReduceSum(bucket->data.data(), bucket->data.size());
+        }).share();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void GradientsAllReducer::Finish()
+    {
+        if (m_Communicator->WorldSize() == 1)
+            return;
+
+        Flush();
+        if (m_Pending.valid())
+            m_Pending.wait();
+        m_Pending = shared_future<void>();
+
+        // gradients were weighted before reduction so sums are final
+        for (auto bucket : m_Buckets)
+        {
+            const float* data = bucket->data.data();
+            for (auto var : bucket->vars)
+            {
+                auto& grad = var->OutputGrad();
+                grad.OverrideHost();
+                copy(data, data + grad.Length(), grad.Values());
+                data += grad.Length();
+            }
+        }
+
+        DeleteContainer(m_Buckets);
+    }
+}
@@ -0,0 +1,365 @@
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "Distributed/TcpRingCommunicator.h"
+#include "Types.h"
+
+namespace Neuro
+{
+    namespace
+    {
+        const size_t MAX_CHUNK_SIZE = 1 << 20;
+
+        void InitSockets()
+        {
+            // static initialization is thread-safe, communicators can be created from multiple threads
+            static bool initialized = []()
+            {
+                WSADATA data;
+                return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+            NEURO_ASSERT(initialized, "Failed to initialize sockets.");
+        }
+
+        void SplitAddress(const string& address, string& host, string& port)
+        {
+            size_t separator = address.rfind(':');
+            NEURO_ASSERT(separator != string::npos, "Invalid address '" << address << "', expected host:port.");
+            host = address.substr(0, separator);
+            port = address.substr(separator + 1);
+        }
+
+        // socket and process failures are runtime conditions (ports in use, peers not started) so unlike asserts these checks
+        // are kept in release builds
+        void Fail(const string& message, int error)
+        {
+            throw runtime_error(message + " Error " + to_string(error) + ".");
+        }
+
+        void ConfigureSocket(SOCKET s)
+        {
+            // gradients are sent in large chunks and every send is followed by receive, there is no point delaying small packets
+            BOOL noDelay = TRUE;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+        }
+
+        string GetEnv(const char* name, const string& defaultValue = "")
+        {
+            char* value = nullptr;
+            size_t length = 0;
+            if (_dupenv_s(&value, &length, name) || !value)
+                return defaultValue;
+            string result(value);
+            free(value);
+            return result;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TcpRingCommunicator::TcpRingCommunicator(uint32_t rank, const vector<string>& addresses, uint32_t connectTimeoutMs)
+        : Communicator(rank, (uint32_t)addresses.size()), m_NextSocket(INVALID_SOCKET), m_PrevSocket(INVALID_SOCKET)
+    {
+        NEURO_ASSERT(rank < addresses.size(), "Rank " << rank << " is out of world size " << addresses.size() << ".");
+
+        if (m_WorldSize == 1)
+            return;
+
+        InitSockets();
+
+        string host, port;
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+
+        // listening socket has to exist before connecting to next process, connection from previous process will be waiting
+        // in the backlog so every process can connect first and accept afterwards
+        SplitAddress(addresses[rank], host, port);
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* listenAddr = nullptr;
+        int result = getaddrinfo(nullptr, port.c_str(), &hints, &listenAddr);
+        if (result != 0)
+            Fail("Failed to resolve listening port " + port + ".", result);
+        SOCKET listenSocket = socket(listenAddr->ai_family, listenAddr->ai_socktype, listenAddr->ai_protocol);
+        if (listenSocket == INVALID_SOCKET)
+        {
+            freeaddrinfo(listenAddr);
+            Fail("Failed to create listening socket.", WSAGetLastError());
+        }
+        BOOL reuse = TRUE;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+        result = ::bind(listenSocket, listenAddr->ai_addr, (int)listenAddr->ai_addrlen);
+        freeaddrinfo(listenAddr);
+        if (result != 0)
+        {
+            int error = WSAGetLastError();
+            closesocket(listenSocket);
+            Fail("Failed to bind port " + port + ".", error);
+        }
+        if (listen(listenSocket, 1) != 0)
+        {
+            int error = WSAGetLastError();
+            closesocket(listenSocket);
+            Fail("Failed to listen on port " + port + ".", error);
+        }
+
+        SplitAddress(addresses[(rank + 1) % m_WorldSize], host, port);
+        hints.ai_flags = 0;
+        addrinfo* nextAddr = nullptr;
+        result = getaddrinfo(host.c_str(), port.c_str(), &hints, &nextAddr);
+        if (result != 0)
+        {
+            closesocket(listenSocket);
+            Fail("Failed to resolve " + host + ":" + port + ".", result);
+        }
+
+        // next process might not be listening yet
+        auto start = chrono::steady_clock::now();
+        SOCKET nextSocket = INVALID_SOCKET;
+        while (true)
+        {
+            nextSocket = socket(nextAddr->ai_family, nextAddr->ai_socktype, nextAddr->ai_protocol);
+            if (connect(nextSocket, nextAddr->ai_addr, (int)nextAddr->ai_addrlen) == 0)
+                break;
+            int error = WSAGetLastError();
+            closesocket(nextSocket);
+            if (chrono::steady_clock::now() - start >= chrono::milliseconds(connectTimeoutMs))
+            {
+                freeaddrinfo(nextAddr);
+                closesocket(listenSocket);
+                Fail("Timed out connecting to " + host + ":" + port + ".", error);
+            }
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        freeaddrinfo(nextAddr);
+        ConfigureSocket(nextSocket);
+        m_NextSocket = nextSocket;
+
+        // destructor is not run when constructor throws, sockets have to be released here
+        SOCKET prevSocket = accept(listenSocket, nullptr, nullptr);
+        closesocket(listenSocket);
+        if (prevSocket == INVALID_SOCKET)
+        {
+            int error = WSAGetLastError();
+            closesocket(m_NextSocket);
+            Fail("Failed to accept connection from previous process.", error);
+        }
+        ConfigureSocket(prevSocket);
+        m_PrevSocket = prevSocket;
+
+        // make sure ring is wired as expected
+        uint32_t prevRank = 0;
+        try
+        {
+            SendAll(&m_Rank, sizeof(m_Rank));
+            ReceiveAll(&prevRank, sizeof(prevRank));
+        }
+        catch (...)
+        {
+            closesocket(m_NextSocket);
+            closesocket(m_PrevSocket);
+            throw;
+        }
+        NEURO_ASSERT(prevRank == (m_Rank + m_WorldSize - 1) % m_WorldSize, "Unexpected previous process rank " << prevRank << ".");
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TcpRingCommunicator::~TcpRingCommunicator()
+    {
+        if (m_NextSocket != INVALID_SOCKET)
+            closesocket(m_NextSocket);
+        if (m_PrevSocket != INVALID_SOCKET)
+            closesocket(m_PrevSocket);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TcpRingCommunicator* TcpRingCommunicator::FromEnvironment()
+    {
+        string worldSizeStr = GetEnv("NEURO_WORLD_SIZE");
+        if (worldSizeStr.empty())
+            return nullptr;
+
+        uint32_t worldSize = (uint32_t)stoul(worldSizeStr);
+        uint32_t rank = (uint32_t)stoul(GetEnv("NEURO_RANK", "0"));
+
+        vector<string> addresses;
+        string addressesStr = GetEnv("NEURO_ADDRESSES");
+        if (!addressesStr.empty())
+        {
+            stringstream ss(addressesStr);
+            string address;
+            while (getline(ss, address, ','))
+                addresses.push_back(address);
+            NEURO_ASSERT(addresses.size() == worldSize, "Number of addresses doesn't match world size " << worldSize << ".");
+        }
+        else
+        {
+            string masterAddr = GetEnv("NEURO_MASTER_ADDR", "127.0.0.1");
+            int masterPort = stoi(GetEnv("NEURO_MASTER_PORT", "29500"));
+            for (uint32_t r = 0; r < worldSize; ++r)
+                addresses.push_back(masterAddr + ":" + to_string(masterPort + r));
+        }
+
+        return new TcpRingCommunicator(rank, addresses);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    vector<int> TcpRingCommunicator::LaunchLocal(const string& commandLine, uint32_t worldSize, uint16_t basePort)
+    {
+        vector<PROCESS_INFORMATION> processes;
+
+        for (uint32_t rank = 0; rank < worldSize; ++rank)
+        {
+            // child processes inherit environment of the launcher
+            SetEnvironmentVariableA("NEURO_RANK", to_string(rank).c_str());
+            SetEnvironmentVariableA("NEURO_WORLD_SIZE", to_string(worldSize).c_str());
+            SetEnvironmentVariableA("NEURO_MASTER_ADDR", "127.0.0.1");
+            SetEnvironmentVariableA("NEURO_MASTER_PORT", to_string(basePort).c_str());
+
+            STARTUPINFOA startupInfo = { sizeof(startupInfo) };
+            PROCESS_INFORMATION processInfo = {};
+            vector<char> cmd(commandLine.begin(), commandLine.end());
+            cmd.push_back(0);
+            if (!CreateProcessA(nullptr, cmd.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo))
+            {
+                // processes started so far will wait for missing ranks until connection timeout and exit on their own
+                Fail("Failed to start '" + commandLine + "'.", (int)GetLastError());
+            }
+            processes.push_back(processInfo);
+        }
+
+        SetEnvironmentVariableA("NEURO_RANK", nullptr);
+        SetEnvironmentVariableA("NEURO_WORLD_SIZE", nullptr);
+        SetEnvironmentVariableA("NEURO_MASTER_ADDR", nullptr);
+        SetEnvironmentVariableA("NEURO_MASTER_PORT", nullptr);
+
+        vector<int> exitCodes;
+        for (auto& process : processes)
+        {
+            WaitForSingleObject(process.hProcess, INFINITE);
+            DWORD exitCode = 0;
+            GetExitCodeProcess(process.hProcess, &exitCode);
+            exitCodes.push_back((int)exitCode);
+            CloseHandle(process.hProcess);
+            CloseHandle(process.hThread);
+        }
+        return exitCodes;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TcpRingCommunicator::SendAll(const void* data, size_t size)
+    {
+        const char* ptr = (const char*)data;
+        while (size > 0)
+        {
+            int sent = send((SOCKET)m_NextSocket, ptr, (int)min(size, MAX_CHUNK_SIZE), 0);
+            if (sent <= 0)
+                Fail("Sending to next process failed.", WSAGetLastError());
+            ptr += sent;
+            size -= sent;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TcpRingCommunicator::ReceiveAll(void* data, size_t size)
+    {
+        char* ptr = (char*)data;
+        while (size > 0)
+        {
+            int received = recv((SOCKET)m_PrevSocket, ptr, (int)min(size, MAX_CHUNK_SIZE), 0);
+            if (received <= 0)
+                Fail("Receiving from previous process failed.", WSAGetLastError());
+            ptr += received;
+            size -= received;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TcpRingCommunicator::SendReceive(const float* sendData, size_t sendCount, float* recvData, size_t recvCount)
+    {
+        // exception escaping thread function would terminate the process, it is rethrown on calling thread instead
+        exception_ptr sendError;
+        thread sender([&]()
+        {
+            try { SendAll(sendData, sendCount * sizeof(float)); }
+            catch (...) { sendError = current_exception(); }
+        });
+        try
+        {
+            ReceiveAll(recvData, recvCount * sizeof(float));
+        }
+        catch (...)
+        {
+            sender.join();
+            throw;
+        }
+        sender.join();
+        if (sendError)
+            rethrow_exception(sendError);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TcpRingCommunicator::AllReduceSum(float* data, size_t count)
+    {
+        if (m_WorldSize == 1 || count == 0)
+            return;
+
+        const uint32_t n = m_WorldSize;
+        auto segmentStart = [&](uint32_t segment) { return segment * count / n; };
+        auto segmentLength = [&](uint32_t segment) { return segmentStart(segment + 1) - segmentStart(segment); };
+
+        m_RecvBuffer.resize(segmentLength(n - 1) + 1);
+
+        // reduce-scatter: after n - 1 steps each process holds complete sum of segment (rank + 1) % n
+        for (uint32_t step = 0; step < n - 1; ++step)
+        {
+            uint32_t sendSegment = (m_Rank + n - step) % n;
+            uint32_t recvSegment = (m_Rank + n - step - 1) % n;
+
+            SendReceive(data + segmentStart(sendSegment), segmentLength(sendSegment), m_RecvBuffer.data(), segmentLength(recvSegment));
+
+            float* dest = data + segmentStart(recvSegment);
+            for (size_t i = 0; i < segmentLength(recvSegment); ++i)
+                dest[i] += m_RecvBuffer[i];
+        }
+
+        // all-gather: complete segments travel around the ring
+        for (uint32_t step = 0; step < n - 1; ++step)
+        {
+            uint32_t sendSegment = (m_Rank + 1 + n - step) % n;
+            uint32_t recvSegment = (m_Rank + n - step) % n;
+
+            SendReceive(data + segmentStart(sendSegment), segmentLength(sendSegment), data + segmentStart(recvSegment), segmentLength(recvSegment));
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TcpRingCommunicator::Broadcast(float* data, size_t count, uint32_t root)
+    {
+        if (m_WorldSize == 1 || count == 0)
+            return;
+
+        // data is passed along the ring starting from root
+        if (m_Rank != root)
+            ReceiveAll(data, count * sizeof(float));
+        if ((m_Rank + 1) % m_WorldSize != root)
+            SendAll(data, count * sizeof(float));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TcpRingCommunicator::Barrier()
+    {
+        float token = 0;
+        AllReduceSum(&token, 1);
+    }
+}
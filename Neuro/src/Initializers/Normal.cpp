@@ -60,6 +60,7 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
 	void Normal::Init(Tensor& t)
 	{
-        t.FillWithFunc([&]() { return NextSingle(m_Mean, m_Variance, m_Scale); });
+        t.OverrideHost();
+        GlobalPhilox().FillNormal(t.Values(), t.Length(), m_Mean, m_Variance, m_Scale);
 	}
 }
@@ -29,6 +29,7 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
 	void Uniform::Init(Tensor& t)
 	{
-        t.FillWithFunc([&]() { return NextSingle(m_Min, m_Max); });
+        t.OverrideHost();
+        GlobalPhilox().FillUniform(t.Values(), t.Length(), m_Min, m_Max);
 	}
 }
@@ -5,6 +5,7 @@
 #include "Initializers/Uniform.h"
 #include "Tensors/Tensor.h"
 #include "Tensors/Shape.h"
+#include "Tools.h"
 
 namespace Neuro
 {
@@ -19,6 +20,7 @@ namespace Neuro
     void VarianceScaling::Init(Tensor& t)
     {
         auto fans = ComputeFans(t.GetShape());
+        t.OverrideHost();
 
         float fanIn = fans.first, fanOut = fans.second;
         float scale = m_Scale;
@@ -33,12 +35,12 @@ namespace Neuro
         if (m_Distribution == NormalDistribution)
         {
             float stddev = ::sqrt(scale) / 0.87962566103423978f;
-            t.FillWithFunc([&]() { return Normal::NextTruncatedSingle(0.f, stddev); });
+            GlobalPhilox().FillNormal(t.Values(), t.Length(), 0.f, stddev, 1.f, true);
         }
         else
         {
             float limit = ::sqrt(3.f * scale);
-            t.FillWithFunc([&]() { return Uniform::NextSingle(-limit, limit); });
+            GlobalPhilox().FillUniform(t.Values(), t.Length(), -limit, limit);
         }
     }
 
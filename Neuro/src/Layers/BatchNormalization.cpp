@@ -103,7 +103,31 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     vector<TensorLike*> BatchNormalization::InternalCall(const vector<TensorLike*>& inputs)
     {
-        TensorLike* output = batch_norm(inputs[0], m_Gamma, m_Beta, m_RunningMean, m_RunningVar, m_Momentum, m_Epsilon);
+        TensorLike* output = nullptr;
+
+        // normalization of convolution output (optionally with added bias) is merged with that convolution so during inference
+        // it can be folded into convolution weights, original convolution is left without consumers and won't be scheduled
+        Conv2dOp* conv = nullptr;
+        TensorLike* bias = nullptr;
+        if (auto add = dynamic_cast<AddOp*>(inputs[0]))
+        {
+            if (add->InputNodes().size() == 2 && add->InputNodes()[1]->IsVar())
+            {
+                conv = dynamic_cast<Conv2dOp*>(add->InputNodes()[0]);
+                bias = add->InputNodes()[1];
+            }
+        }
+        else
+            conv = dynamic_cast<Conv2dOp*>(inputs[0]);
+
+        bool foldable = conv && conv->DataFormat() == NCHW && conv->GetShape().Depth() > 1 && inputs[0]->Consumers().empty() && conv->Consumers().size() == (bias ? 1 : 0);
+        if (foldable && bias)
+            foldable = bias->GetShape() == m_Gamma->GetShape();
+
+        if (foldable)
+            output = conv2d_batch_norm(conv->InputNodes()[0], conv->InputNodes()[1], bias, conv->Stride(), conv->Padding(), m_Gamma, m_Beta, m_RunningMean, m_RunningVar, m_Momentum, m_Epsilon);
+        else
+            output = batch_norm(inputs[0], m_Gamma, m_Beta, m_RunningMean, m_RunningVar, m_Momentum, m_Epsilon);
         if (m_Activation)
             output = m_Activation->Build(output);
 
@@ -77,13 +77,34 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     vector<TensorLike*> Conv2D::InternalCall(const vector<TensorLike*>& inputs)
     {
-        if (m_UseBias && m_DataFormat == NCHW && m_Activation && m_Activation->Type() == _ReLU)
+        TensorLike* output = nullptr;
+
+        // convolution of nearest-neighbour upsampled input is computed from low resolution input directly, upsample op is left
+        // without consumers so it won't be scheduled unless something else depends on it
+        auto upSample = dynamic_cast<UpSample2dOp*>(inputs[0]);
+        // similarly explicit padding preceding valid convolution is resolved inside convolution kernel
+        auto pad = dynamic_cast<Pad2dOp*>(inputs[0]);
+        // fused convolutions fold bias and ReLU into their output the same way conv2d_bias_activation does
+        bool fuseActivation = m_Activation && m_Activation->Type() == _ReLU;
+        bool fused = false;
+        if (upSample && m_DataFormat == NCHW)
+        {
+            output = upsample_conv2d(upSample->InputNodes()[0], m_Kernels, upSample->ScaleFactor(), m_Stride, m_Padding, m_UseBias ? m_Bias : nullptr, fuseActivation ? _ReLU : _Identity, fuseActivation ? m_Activation->Alpha() : 0);
+            fused = true;
+        }
+        else if (pad && m_Padding == 0 && m_DataFormat == NCHW)
+        {
+            output = padded_conv2d(pad->InputNodes()[0], m_Kernels, m_Stride, pad->Left(), pad->Right(), pad->Top(), pad->Bottom(), pad->Border(), pad->BorderValue(), m_UseBias ? m_Bias : nullptr, fuseActivation ? _ReLU : _Identity, fuseActivation ? m_Activation->Alpha() : 0);
+            fused = true;
+        }
+        else if (m_UseBias && m_DataFormat == NCHW && m_Activation && m_Activation->Type() == _ReLU)
             return { conv2d_bias_activation(inputs[0], m_Kernels, m_Stride, m_Padding, m_Bias, m_Activation ? m_Activation->Type() : _Identity, m_Activation ? m_Activation->Alpha() : 0) };
-        
-        TensorLike* output = conv2d(inputs[0], m_Kernels, m_Stride, m_Padding, m_DataFormat);
-        if (m_UseBias)
+        else
+            output = conv2d(inputs[0], m_Kernels, m_Stride, m_Padding, m_DataFormat);
+
+        if (m_UseBias && !fused)
             output = add(output, m_Bias);
-        if (m_Activation)
+        if (m_Activation && !(fused && fuseActivation))
             output = m_Activation->Build(output);
         return { output };
     }
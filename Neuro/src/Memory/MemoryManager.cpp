@@ -6,6 +6,7 @@
 
 #include "Types.h"
 #include "Tools.h"
+#include "Profiler.h"
 #include "Memory/MemoryManager.h"
 #include "Tensors/Cuda/CudaErrorCheck.h"
 
@@ -66,6 +67,9 @@ namespace Neuro
     {
         NVTXProfile p(__FUNCTION__, 0xFFFF0000);
 
+        if (Profiler::IsEnabled())
+            Profiler::RecordAllocation(size);
+
         {
             unique_lock<mutex> deallocationsLocker(m_ScheduledFreeMtx);
 #ifdef ENABLE_MEMORY_LOGS
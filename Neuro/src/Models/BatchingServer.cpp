@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "Models/BatchingServer.h"
+#include "Models/ModelBase.h"
+#include "Tools.h"
+
+namespace Neuro
+{
+    //////////////////////////////////////////////////////////////////////////
+    BatchingServer::BatchingServer(ModelBase* model, uint32_t maxBatchSize, uint32_t maxDelayUs)
+        : m_Model(model), m_MaxBatchSize(maxBatchSize), m_MaxDelayUs(maxDelayUs)
+    {
+        NEURO_ASSERT(maxBatchSize > 0, "Max batch size must be positive.");
+        m_InputShapes = model->InputShapesAt(-1);
+        m_Worker = thread(&BatchingServer::WorkerLoop, this);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    BatchingServer::~BatchingServer()
+    {
+        {
+            lock_guard<mutex> lock(m_QueueMtx);
+            m_Stop = true;
+        }
+        m_QueueCond.notify_one();
+        m_Worker.join();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    future<vector<Tensor>> BatchingServer::Enqueue(const const_tensor_ptr_vec_t& inputs)
+    {
+        Request request;
+        auto result = request.result.get_future();
+
+        // invalid request would otherwise break the whole batch it ends up in
+        stringstream error;
+        if (inputs.size() != m_InputShapes.size())
+            error << "Expected " << m_InputShapes.size() << " inputs, received " << inputs.size() << ".";
+        for (size_t i = 0; i < inputs.size() && error.tellp() == 0; ++i)
+        {
+            if (inputs[i]->Batch() != 1)
+                error << "Batching server expects single-sample requests, received batch " << inputs[i]->Batch() << " for input " << i << ".";
+            else if (!inputs[i]->GetShape().EqualsIgnoreBatch(m_InputShapes[i]))
+                error << "Mismatched shape of input " << i << ", expected " << m_InputShapes[i].ToString() << " received " << inputs[i]->GetShape().ToString() << ".";
+        }
+        if (error.tellp() != 0)
+        {
+            request.result.set_exception(make_exception_ptr(invalid_argument(error.str())));
+            return result;
+        }
+
+        for (auto input : inputs)
+            request.inputs.push_back(*input);
+
+        {
+            lock_guard<mutex> lock(m_QueueMtx);
+            NEURO_ASSERT(!m_Stop, "Enqueuing request to stopped batching server.");
+            request.enqueueTime = chrono::steady_clock::now();
+            m_Queue.push_back(move(request));
+        }
+        m_QueueCond.notify_one();
+
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    future<vector<Tensor>> BatchingServer::Enqueue(const Tensor& input)
+    {
+        return Enqueue(const_tensor_ptr_vec_t{ &input });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void BatchingServer::WorkerLoop()
+    {
+        while (true)
+        {
+            vector<Request> batch;
+
+            {
+                unique_lock<mutex> lock(m_QueueMtx);
+                m_QueueCond.wait(lock, [&]() { return m_Stop || !m_Queue.empty(); });
+
+                // all pending requests are served before stopping
+                if (m_Queue.empty())
+                    return;
+
+                // deadline is driven by the oldest request so no request waits for batch longer than max delay
+                auto deadline = m_Queue.front().enqueueTime + chrono::microseconds(m_MaxDelayUs);
+                m_QueueCond.wait_until(lock, deadline, [&]() { return m_Stop || m_Queue.size() >= m_MaxBatchSize; });
+
+                size_t batchSize = min<size_t>(m_Queue.size(), m_MaxBatchSize);
+                batch.assign(make_move_iterator(m_Queue.begin()), make_move_iterator(m_Queue.begin() + batchSize));
+                m_Queue.erase(m_Queue.begin(), m_Queue.begin() + batchSize);
+            }
+
+            RunBatch(batch);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void BatchingServer::RunBatch(vector<Request>& batch)
+    {
+        NVTXProfile p("Batching server batch", 0xFFC0C0C0);
+
+        auto startTime = chrono::steady_clock::now();
+        const uint32_t batchSize = (uint32_t)batch.size();
+
+        vector<vector<Tensor>> results(batchSize);
+        try
+        {
+            // batch tensors are allocated for max batch size once and then only resized to actual batch size
+            if (m_BatchInputs.empty())
+            {
+                for (auto& shape : m_InputShapes)
+                    m_BatchInputs.push_back(Tensor(Shape::From(shape, m_MaxBatchSize)));
+            }
+
+            const_tensor_ptr_vec_t inputs;
+            for (size_t i = 0; i < m_BatchInputs.size(); ++i)
+            {
+                m_BatchInputs[i].ResizeBatch(batchSize);
+                for (uint32_t b = 0; b < batchSize; ++b)
+                    batch[b].inputs[i].CopyBatchTo(0, b, m_BatchInputs[i]);
+                inputs.push_back(&m_BatchInputs[i]);
+            }
+
+            auto outputs = m_Model->Predict(inputs);
+
+            for (uint32_t b = 0; b < batchSize; ++b)
+            {
+                for (auto output : outputs)
+                    results[b].push_back(output->GetBatch(b));
+            }
+        }
+        catch (...)
+        {
+            // worker has to keep serving following requests, clients waiting for this batch receive the exception
+            for (auto& request : batch)
+                request.result.set_exception(current_exception());
+            return;
+        }
+
+        double computeUs = (double)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startTime).count();
+
+        // stats are updated before results are delivered so clients can observe them once their futures are ready
+        {
+            lock_guard<mutex> lock(m_StatsMtx);
+            m_Requests += batchSize;
+            ++m_Batches;
+            m_TotalComputeUs += computeUs;
+            for (auto& request : batch)
+            {
+                double queueUs = (double)chrono::duration_cast<chrono::microseconds>(startTime - request.enqueueTime).count();
+                m_TotalQueueUs += queueUs;
+                m_MaxQueueUs = max(m_MaxQueueUs, queueUs);
+            }
+        }
+
+        for (uint32_t b = 0; b < batchSize; ++b)
+            batch[b].result.set_value(move(results[b]));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    BatchingServer::Stats BatchingServer::GetStats() const
+    {
+        lock_guard<mutex> lock(m_StatsMtx);
+        Stats stats;
+        stats.requests = m_Requests;
+        stats.batches = m_Batches;
+        if (m_Batches)
+        {
+            stats.avgBatchSize = (double)m_Requests / m_Batches;
+            stats.avgQueueUs = m_TotalQueueUs / m_Requests;
+            stats.maxQueueUs = m_MaxQueueUs;
+            stats.avgComputeUs = m_TotalComputeUs / m_Batches;
+        }
+        return stats;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void BatchingServer::ResetStats()
+    {
+        lock_guard<mutex> lock(m_StatsMtx);
+        m_Requests = m_Batches = 0;
+        m_TotalQueueUs = m_MaxQueueUs = m_TotalComputeUs = 0;
+    }
+}
@@ -4,11 +4,14 @@
 #include <cctype>
 #include <iomanip>
 #include <memory>
+#include <stdexcept>
 #include <experimental/filesystem>
 #include <H5Cpp.h>
 
 #include "Models/ModelBase.h"
 #include "Optimizers/OptimizerBase.h"
+#include "Distributed/Communicator.h"
+#include "Tensors/TensorOpCpu.h"
 #include "Loss.h"
 #include "Tools.h"
 #include "Debug.h"
@@ -17,6 +20,7 @@
 #include "ComputationalGraph/Ops.h"
 #include "ComputationalGraph/Placeholder.h"
 #include "ComputationalGraph/Variable.h"
+#include "ComputationalGraph/Graph.h"
 #include "ComputationalGraph/NameScope.h"
 #include "ComputationalGraph/Trainer.h"
 #include "ComputationalGraph/Predicter.h"
@@ -263,6 +267,22 @@ namespace Neuro
         return Predict(inputs);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    Predicter* ModelBase::CreatePredicter()
+    {
+        NameScope scope(Name());
+        NameScope contextScope("predicter_" + to_string(++m_PredictersNum));
+
+        vector<Placeholder*> inputs;
+        for (auto input : m_Inputs)
+            inputs.push_back(new Placeholder(Shape(input->GetShape()), input->Name()));
+
+        // calling the model again creates new graph nodes sharing model's variables
+        auto outputs = Call(vector<TensorLike*>(inputs.begin(), inputs.end()));
+
+        return new Predicter(inputs, outputs, true);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     tensor_ptr_vec_t ModelBase::Eval(const vector<TensorLike*>& fetches, const map<Placeholder*, const Tensor*>& feeds)
     {
@@ -313,6 +333,14 @@ namespace Neuro
 
         NEURO_ASSERT(lossDict.size() == m_OutputLayers.size(), "Each output layer must have a corresponding loss function provided.");
 
+        NEURO_ASSERT(m_Replicas > 0, "Number of replicas must be positive.");
+        NEURO_ASSERT(m_Replicas == 1 || Tensor::DefaultOp()->OpMode() != GPU, "Data parallel training is supported only in CPU modes.");
+
+        // losses are assigned to outputs by index because replicas' outputs carry metadata of the whole model
+        vector<LossBase*> lossFuncs;
+        for (auto output : m_Outputs)
+            lossFuncs.push_back(lossDict[output->m_Metadata->layer->Name()]);
+
         vector<Placeholder*> targets;
         vector<TensorLike*> fetches;
 
@@ -322,38 +350,54 @@ namespace Neuro
 
         {
             NameScope scope("loss");
+            BuildLoss(m_Outputs, lossFuncs, lossWeights, metrics, targets, losses, totalLoss, totalAcc);
+        }
 
-            for (size_t i = 0; i < m_Outputs.size(); ++i)
-            {
-                auto output = m_Outputs[i];
-                auto layer = output->m_Metadata->layer;
-
-                targets.push_back(new Placeholder(Shape(output->GetShape()), "target_" + to_string(i)));
-                auto loss = lossDict[layer->Name()]->Build(targets.back(), output);
+        fetches.insert(fetches.end(), losses.begin(), losses.end());
 
-                if (!lossWeights.empty())
-                    loss = multiply(loss, lossWeights[i], "weighted_loss_" + to_string(i));
+        vector<vector<Placeholder*>> replicasInputs(1), replicasTargets{ targets };
+        vector<vector<TensorLike*>> replicasFetches{ { totalLoss } };
+        for_each(m_Inputs.begin(), m_Inputs.end(), [&](TensorLike* input) { replicasInputs[0].push_back(static_cast<Placeholder*>(input)); });
+        if (totalAcc)
+            replicasFetches[0].push_back(totalAcc);
 
-                losses.push_back(loss);
-                fetches.push_back(loss);
+        if (m_Replicas > 1)
+        {
+            vector<TensorLike*> replicasLosses{ totalLoss }, replicasAccs{ totalAcc };
 
-                if (!totalLoss)
-                    totalLoss = mean(loss, GlobalAxis, "mean_loss_" + to_string(i));                    
-                else
-                    totalLoss = merge_sum({ totalLoss, mean(loss) }, "total_loss");
+            for (uint32_t r = 1; r < m_Replicas; ++r)
+            {
+                NameScope scope("replica_" + to_string(r));
 
-                if (metrics & Accuracy)
+                replicasInputs.push_back({});
+                vector<TensorLike*> inputs;
+                for (auto input : m_Inputs)
                 {
-                    auto acc = output->GetShape().Length == 1 ? 
-                        binary_accuracy(targets.back(), output, "accuracy_" + to_string(i)) :
-                        accuracy(targets.back(), output, "accuracy_" + to_string(i));
-
-                    if (!totalAcc)
-                        totalAcc = acc;
-                    else
-                        totalAcc = merge_avg({ totalAcc, acc }, "total_accuracy");
+                    replicasInputs.back().push_back(new Placeholder(Shape(input->GetShape()), input->Name()));
+                    inputs.push_back(replicasInputs.back().back());
                 }
+
+                // calling the model again creates new graph nodes sharing model's variables
+                auto outputs = Call(inputs);
+
+                NameScope lossScope("loss");
+                replicasTargets.push_back({});
+                vector<TensorLike*> replicaLosses;
+                TensorLike* replicaLoss = nullptr;
+                TensorLike* replicaAcc = nullptr;
+                BuildLoss(outputs, lossFuncs, lossWeights, metrics, replicasTargets.back(), replicaLosses, replicaLoss, replicaAcc);
+
+                replicasLosses.push_back(replicaLoss);
+                replicasAccs.push_back(replicaAcc);
+                replicasFetches.push_back({ replicaLoss });
+                if (replicaAcc)
+                    replicasFetches.back().push_back(replicaAcc);
             }
+
+            // replicas are weighted equally, when batch size is not divisible by number of replicas their shards differ by one sample
+            totalLoss = merge_avg(replicasLosses, "replicas_loss");
+            if (totalAcc)
+                totalAcc = merge_avg(replicasAccs, "replicas_accuracy");
         }
 
         fetches.push_back(totalLoss);
@@ -368,12 +412,72 @@ namespace Neuro
         vector<Variable*> params;
         Parameters(params);
 
-        fetches.push_back(optimizer->Minimize({ totalLoss }, params));
+        auto minimize = optimizer->Minimize({ totalLoss }, params);
+        m_Minimization = dynamic_cast<MinimizationOperationBase*>(minimize);
+        fetches.push_back(minimize);
 
-        vector<Placeholder*> inputs;
-        for_each(m_Inputs.begin(), m_Inputs.end(), [&](TensorLike* input) { inputs.push_back(static_cast<Placeholder*>(input)); });
+        if (m_Communicator)
+            Distributed(m_Communicator, m_BucketSize);
 
-        m_Trainer = new Trainer(inputs, targets, fetches);
+        if (m_Replicas > 1)
+        {
+            NEURO_ASSERT(m_Minimization, "Optimizer " << optimizer->ClassName() << " doesn't support data parallel training.");
+            vector<TensorLike*> replicasLosses;
+            for (auto& replicaFetches : replicasFetches)
+                replicasLosses.push_back(replicaFetches[0]);
+            m_Minimization->Replicas(replicasLosses);
+            m_Trainer = new Trainer(replicasInputs, replicasTargets, replicasFetches, fetches);
+        }
+        else
+            m_Trainer = new Trainer(replicasInputs[0], targets, fetches);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ModelBase::Distributed(Communicator* communicator, size_t bucketSizeInBytes)
+    {
+        m_Communicator = communicator;
+        m_BucketSize = bucketSizeInBytes;
+
+        if (!m_Optimizer)
+            return; // will be set up in Optimize
+
+        NEURO_ASSERT(!communicator || m_Minimization, "Optimizer " << m_Optimizer->ClassName() << " doesn't support distributed training.");
+        if (m_Minimization)
+            m_Minimization->Distribute(communicator, bucketSizeInBytes);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ModelBase::BuildLoss(const vector<TensorLike*>& outputs, const vector<LossBase*>& lossFuncs, const vector<float>& lossWeights, int metrics, vector<Placeholder*>& targets, vector<TensorLike*>& losses, TensorLike*& totalLoss, TensorLike*& totalAcc)
+    {
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            auto output = outputs[i];
+
+            targets.push_back(new Placeholder(Shape(output->GetShape()), "target_" + to_string(i)));
+            auto loss = lossFuncs[i]->Build(targets.back(), output);
+
+            if (!lossWeights.empty())
+                loss = multiply(loss, lossWeights[i], "weighted_loss_" + to_string(i));
+
+            losses.push_back(loss);
+
+            if (!totalLoss)
+                totalLoss = mean(loss, GlobalAxis, "mean_loss_" + to_string(i));                    
+            else
+                totalLoss = merge_sum({ totalLoss, mean(loss) }, "total_loss");
+
+            if (metrics & Accuracy)
+            {
+                auto acc = output->GetShape().Length == 1 ? 
+                    binary_accuracy(targets.back(), output, "accuracy_" + to_string(i)) :
+                    accuracy(targets.back(), output, "accuracy_" + to_string(i));
+
+                if (!totalAcc)
+                    totalAcc = acc;
+                else
+                    totalAcc = merge_avg({ totalAcc, acc }, "total_accuracy");
+            }
+        }
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -672,14 +776,32 @@ namespace Neuro
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void ModelBase::Fit(const Tensor& input, const Tensor& output, int batchSize, uint32_t epochs, const Tensor* validInput, const Tensor* validOutput, uint32_t verbose, bool shuffle)
+    void ModelBase::SetDataType(EDataType type)
+    {
+        vector<TensorLike*> nodes;
+        Graph::Default()->BuildForwardOrder(m_Outputs, nodes);
+
+        for (auto node : nodes)
+        {
+            // trainable variables serve as master weights for optimizers so they have to stay in full precision
+            if (node->IsVar() && static_cast<Variable*>(node)->Trainable())
+                continue;
+            if (node->IsConst())
+                continue;
+
+            node->Output().SetDataType(type);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void ModelBase::Fit(const Tensor& input, const Tensor& output, int batchSize, uint32_t epochs, const Tensor* validInput, const Tensor* validOutput, uint32_t verbose, bool shuffle, uint32_t accumulationSteps)
     {
         const_tensor_ptr_vec_t validInputs = { validInput }, validOutputs = { validOutput };
-        Fit({ &input }, { &output }, batchSize, epochs, validInput ? &validInputs : nullptr, validOutput ? &validOutputs : nullptr, verbose, shuffle);
+        Fit({ &input }, { &output }, batchSize, epochs, validInput ? &validInputs : nullptr, validOutput ? &validOutputs : nullptr, verbose, shuffle, accumulationSteps);
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void ModelBase::Fit(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, int batchSize, uint32_t epochs, const const_tensor_ptr_vec_t* validInputs, const const_tensor_ptr_vec_t* validOutputs, uint32_t verbose, bool shuffle)
+    void ModelBase::Fit(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, int batchSize, uint32_t epochs, const const_tensor_ptr_vec_t* validInputs, const const_tensor_ptr_vec_t* validOutputs, uint32_t verbose, bool shuffle, uint32_t accumulationSteps)
     {
         cout << unitbuf; // disable buffering so progress 'animations' can work
 
@@ -695,6 +817,25 @@ namespace Neuro
         for (auto outputTensor : outputs)
             assert(outputTensor->Batch() == trainSamplesCount && "Number of batches across all outputs must match number or batches in inputs.");
 
+        NEURO_ASSERT(accumulationSteps > 0, "Accumulation steps must be positive.");
+        NEURO_ASSERT(accumulationSteps == 1 || m_Minimization, "Optimizer " << m_Optimizer->ClassName() << " doesn't support gradient accumulation.");
+
+        const uint32_t worldSize = m_Communicator ? m_Communicator->WorldSize() : 1;
+        const uint32_t rank = m_Communicator ? m_Communicator->Rank() : 0;
+        if (worldSize > 1)
+        {
+            // all processes have to start from the same parameters
+            Graph::Default()->InitVariables();
+            vector<Variable*> params;
+            Parameters(params, false);
+            for (auto param : params)
+            {
+                auto& value = param->Output();
+                value.CopyToHost();
+                m_Communicator->Broadcast(value.Values(), value.Length());
+            }
+        }
+
         uint32_t trainBatchSize = batchSize < 0 ? trainSamplesCount : batchSize;
         uint32_t validationBatchSize = batchSize < 0 ? validationSamplesCount : min(validationSamplesCount, (uint32_t)batchSize);
 
@@ -721,7 +862,18 @@ namespace Neuro
 
         uint32_t trainBatchesNum = (uint32_t)ceil(trainSamplesCount / (float)trainBatchSize);
         uint32_t validationBatchesNum = validationBatchSize > 0 ? (uint32_t)ceil(validationSamplesCount / (float)validationBatchSize) : 0;
+
+        if (worldSize > 1)
+        {
+            // every process needs at least one sample of each batch, last partial batch that can't be split is merged into previous one
+            if (trainSamplesCount < worldSize)
+                throw runtime_error("Training set of " + to_string(trainSamplesCount) + " samples can't be split between " + to_string(worldSize) + " processes.");
+            if (trainBatchesNum > 1 && trainSamplesCount - (trainBatchesNum - 1) * trainBatchSize < worldSize)
+                --trainBatchesNum;
+        }
+
         vector<vector<uint32_t>> trainBatchesIndices(trainBatchesNum);
+        vector<uint32_t> trainBatchesSamples(trainBatchesNum);
 
         vector<const_tensor_ptr_vec_t> validInputsBatches, validOutputsBatches;
         if (validInputs)
@@ -745,16 +897,30 @@ namespace Neuro
             if (verbose > 0)
                 LogLine("Epoch " + to_string(e) + "/" + to_string(epochs));
 
-            // no point generating batches when we have single batch
-            if (trainSamplesCount > 1 && trainBatchSize < trainSamplesCount)
+            // no point generating batches when we have single batch (unless it has to be split into micro-batches)
+            const bool generateBatches = trainSamplesCount > 1 && (trainBatchSize < trainSamplesCount || accumulationSteps > 1 || worldSize > 1);
+            if (generateBatches)
             {
+                // in distributed training all processes have to shuffle the same way
+                Random distributedRng(m_Seed + e);
+                Random& shuffleRng = worldSize > 1 ? distributedRng : GlobalRng();
                 if (shuffle)
-                    random_shuffle(indices.begin(), indices.end(), [&](size_t max) { return GlobalRng().Next((int)max); });
+                    random_shuffle(indices.begin(), indices.end(), [&](size_t max) { return shuffleRng.Next((int)max); });
 
                 for (uint32_t b = 0; b < trainBatchesNum; ++b)
                 {
                     uint32_t samplesStartIndex = b * trainBatchSize;
-                    uint32_t samplesEndIndex = min((b + 1) * trainBatchSize, trainSamplesCount);
+                    uint32_t samplesEndIndex = b + 1 == trainBatchesNum ? trainSamplesCount : (b + 1) * trainBatchSize;
+                    uint32_t batchSamples = samplesEndIndex - samplesStartIndex;
+                    trainBatchesSamples[b] = batchSamples;
+
+                    if (worldSize > 1)
+                    {
+                        // every process takes its part of the batch
+                        samplesEndIndex = samplesStartIndex + (rank + 1) * batchSamples / worldSize;
+                        samplesStartIndex += rank * batchSamples / worldSize;
+                    }
+
                     trainBatchesIndices[b].resize(samplesEndIndex - samplesStartIndex);
                     copy(indices.begin() + samplesStartIndex, indices.begin() + samplesEndIndex, trainBatchesIndices[b].begin());
                 }
@@ -768,8 +934,17 @@ namespace Neuro
             {
                 uint32_t samplesInBatch = inputs[0]->Batch();
 
+                // shards can differ in size by a sample, gradients are averaged proportionally to number of samples in each
+                if (worldSize > 1)
+                    m_Minimization->DistributedWeight(trainBatchesIndices[b].size() / (float)trainBatchesSamples[b]);
+
                 float loss, acc = 0;
-                if (trainSamplesCount > 1 && trainBatchSize < trainSamplesCount)
+                if (generateBatches && accumulationSteps > 1)
+                {
+                    samplesInBatch = (uint32_t)trainBatchesIndices[b].size();
+                    TrainStepAccumulated(inputs, outputs, trainBatchesIndices[b], accumulationSteps, &loss, &acc);
+                }
+                else if (generateBatches)
                 {
                     auto inputsBatch = GenerateBatch(inputs, trainBatchesIndices[b]);
                     auto outputsBatch = GenerateBatch(outputs, trainBatchesIndices[b]);
@@ -1040,17 +1215,66 @@ namespace Neuro
     }
 
     //////////////////////////////////////////////////////////////////////////
-    tuple<float,float> ModelBase::TrainOnBatch(const Tensor& input, const Tensor& output)
+    void ModelBase::TrainStepAccumulated(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, const vector<uint32_t>& batchIndices, uint32_t accumulationSteps, float* trainError, float* trainAcc)
+    {
+        NEURO_ASSERT(m_Minimization, "Optimizer " << m_Optimizer->ClassName() << " doesn't support gradient accumulation.");
+        const uint32_t samplesInBatch = (uint32_t)batchIndices.size();
+
+        // loss and gradients of each micro-batch are weighted by its share of samples, so the sum matches full batch
+        uint32_t microBatchesNum = min(accumulationSteps, samplesInBatch);
+        m_Minimization->AccumulationSteps(microBatchesNum);
+
+        float loss = 0, acc = 0;
+        for (uint32_t m = 0; m < microBatchesNum; ++m)
+        {
+            uint32_t samplesStartIndex = m * samplesInBatch / microBatchesNum;
+            uint32_t samplesEndIndex = (m + 1) * samplesInBatch / microBatchesNum;
+            vector<uint32_t> microBatchIndices(batchIndices.begin() + samplesStartIndex, batchIndices.begin() + samplesEndIndex);
+            float weight = microBatchIndices.size() / (float)samplesInBatch;
+            m_Minimization->MicroBatchWeight(weight);
+
+            auto inputsBatch = GenerateBatch(inputs, microBatchIndices);
+            auto outputsBatch = GenerateBatch(outputs, microBatchIndices);
+
+            float microLoss, microAcc = 0;
+            TrainStep(inputsBatch, outputsBatch, &microLoss, (m_TrackedMetrics & Accuracy) ? &microAcc : nullptr);
+            loss += microLoss * weight;
+            acc += microAcc * weight;
+
+            DeleteContainer(inputsBatch);
+            DeleteContainer(outputsBatch);
+        }
+
+        // optimizer step was made after the last micro-batch, following regular steps mustn't accumulate
+        m_Minimization->AccumulationSteps(1);
+        m_Minimization->MicroBatchWeight(-1);
+
+        if (trainError)
+            *trainError = loss;
+        if (trainAcc)
+            *trainAcc = acc;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    tuple<float,float> ModelBase::TrainOnBatch(const Tensor& input, const Tensor& output, uint32_t accumulationSteps)
     {
-        return TrainOnBatch({ &input }, { &output });
+        return TrainOnBatch({ &input }, { &output }, accumulationSteps);
     }
 
     //////////////////////////////////////////////////////////////////////////
-    tuple<float, float> ModelBase::TrainOnBatch(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs)
+    tuple<float, float> ModelBase::TrainOnBatch(const const_tensor_ptr_vec_t& inputs, const const_tensor_ptr_vec_t& outputs, uint32_t accumulationSteps)
     {
         NVTXProfile p((string("Train on batch ") + Name()).c_str(), 0xFFC0C0C0);
+        NEURO_ASSERT(accumulationSteps > 0, "Accumulation steps must be positive.");
         float loss, acc;
-        TrainStep(inputs, outputs, &loss, &acc);
+        if (accumulationSteps > 1 && inputs[0]->Batch() > 1)
+        {
+            vector<uint32_t> batchIndices(inputs[0]->Batch());
+            iota(batchIndices.begin(), batchIndices.end(), 0);
+            TrainStepAccumulated(inputs, outputs, batchIndices, accumulationSteps, &loss, &acc);
+        }
+        else
+            TrainStep(inputs, outputs, &loss, &acc);
         return make_tuple(loss, acc);
     }
 
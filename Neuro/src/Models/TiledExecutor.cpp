@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Models/TiledExecutor.h"
+#include "Models/ModelBase.h"
+#include "Layers/LayerBase.h"
+#include "ComputationalGraph/TensorLike.h"
+#include "Tools.h"
+
+namespace Neuro
+{
+    namespace
+    {
+        struct Span
+        {
+            uint32_t origin; // tile start in input
+            uint32_t coreStart; // start of region which will be copied to output
+            uint32_t coreLength;
+        };
+
+        // Cores are laid out back to back, each tile is centered around its core and shifted back inside the image near borders
+        // (there is no need for halo at image borders as padding applied by the model is exactly what it would be for the full image)
+        vector<Span> SplitAxis(uint32_t length, uint32_t tileLength, uint32_t halo)
+        {
+            vector<Span> spans;
+            uint32_t step = tileLength - 2 * halo;
+            for (uint32_t coreStart = 0; coreStart < length; coreStart += step)
+            {
+                int origin = min(max((int)coreStart - (int)halo, 0), (int)(length - tileLength));
+                spans.push_back({ (uint32_t)origin, coreStart, min(step, length - coreStart) });
+            }
+            return spans;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    TiledExecutor::TiledExecutor(ModelBase* model, size_t memoryBudget, int haloOverride, bool approximate)
+        : m_Model(model), m_Approximate(approximate)
+    {
+        NEURO_ASSERT(model->InputLayers().size() == 1 && model->OutputLayers().size() == 1, "Tiled execution supports only models with single input and output.");
+        m_TileShape = model->InputShapesAt(-1)[0];
+        m_TileOutputShape = model->OutputShapesAt(-1)[0];
+
+        float halo = 0;
+        size_t activationsSize = m_TileShape.Width() * m_TileShape.Height() * m_TileShape.Depth();
+        map<const LayerBase*, float> outputJumps;
+        AnalyzeLayers(model->Layers(), 1, halo, activationsSize, outputJumps);
+
+        if (haloOverride >= 0)
+            halo = (float)haloOverride;
+
+        // halo has to be aligned so tile origins are aligned as well
+        m_Halo = (uint32_t)ceil(halo);
+        m_Halo = ((m_Halo + m_Alignment - 1) / m_Alignment) * m_Alignment;
+
+        NEURO_ASSERT(m_TileShape.Width() % m_Alignment == 0 && m_TileShape.Height() % m_Alignment == 0, "Model input " << m_TileShape.ToString() << " is not multiple of downsampling factor " << m_Alignment << ".");
+        NEURO_ASSERT(2 * m_Halo < m_TileShape.Width() && 2 * m_Halo < m_TileShape.Height(), "Receptive field halo " << m_Halo << " is too large for tile " << m_TileShape.ToString() << ", use model with larger input or halo override.");
+
+        m_TilesPerBatch = (uint32_t)max<size_t>(1, memoryBudget / (activationsSize * sizeof(float)));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TiledExecutor::AnalyzeLayers(const vector<LayerBase*>& layers, float inputJump, float& halo, size_t& activationsSize, map<const LayerBase*, float>& outputJumps)
+    {
+        for (auto layer : layers)
+        {
+            auto model = dynamic_cast<ModelBase*>(layer);
+
+            // jump is a product of strides and upsampling factors of upstream layers (widths can't be used as padding changes them
+            // as well), inputs of different resolutions are merged at the coarsest one. First node of nested model is its own
+            // graph so the last one (call made by enclosing model) is used instead.
+            float jump = 0;
+            for (auto input : layer->InputsAt(model ? -1 : 0))
+            {
+                auto producer = outputJumps.find(input->m_Metadata ? input->m_Metadata->layer : nullptr);
+                jump = max(jump, producer != outputJumps.end() ? producer->second : inputJump);
+            }
+            if (jump == 0)
+                jump = inputJump;
+
+            if (model)
+            {
+                AnalyzeLayers(model->Layers(), jump, halo, activationsSize, outputJumps);
+                outputJumps[model] = outputJumps[model->OutputLayers()[0]];
+                continue;
+            }
+
+            NEURO_ASSERT(layer->IsSpatiallyLocal() || (m_Approximate && layer->SupportsApproximateTiling()), "Layer '" << layer->Name() << "' (" << layer->ClassName() << ") doesn't support " << (layer->SupportsApproximateTiling() ? "exact " : "") << "tiled execution.");
+
+            // first node corresponds to the call made when model was created
+            const auto& inputShapes = layer->InputShapesAt(0);
+            const auto& outputShape = layer->OutputShapesAt(0)[0];
+            activationsSize += outputShape.Width() * outputShape.Height() * outputShape.Depth();
+
+            outputJumps[layer] = jump * layer->SpatialStride();
+            if (outputJumps[layer] > 1)
+                m_Alignment = max(m_Alignment, (uint32_t)outputJumps[layer]);
+
+            if (inputShapes.empty() || layer->SpatialKernelSize() <= 1)
+                continue;
+
+            // summing contributions of all layers (rather than following the longest path) is an upper bound for graphs with skip
+            // connections
+            halo += (layer->SpatialKernelSize() / 2) * jump;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    Tensor TiledExecutor::Predict(const Tensor& input)
+    {
+        NVTXProfile p("Tiled predict", 0xFFC0C0C0);
+
+        const uint32_t tileWidth = m_TileShape.Width(), tileHeight = m_TileShape.Height(), depth = m_TileShape.Depth();
+        const uint32_t outTileWidth = m_TileOutputShape.Width(), outTileHeight = m_TileOutputShape.Height(), outDepth = m_TileOutputShape.Depth();
+
+        NEURO_ASSERT(input.Depth() == depth, "Mismatched input depth, expected " << depth << " received " << input.Depth() << ".");
+        NEURO_ASSERT(input.Width() >= tileWidth && input.Height() >= tileHeight, "Input " << input.GetShape().ToString() << " is smaller than tile " << m_TileShape.ToString() << ".");
+        NEURO_ASSERT(input.Width() % m_Alignment == 0 && input.Height() % m_Alignment == 0, "Input " << input.GetShape().ToString() << " is not multiple of downsampling factor " << m_Alignment << ".");
+
+        const uint32_t width = input.Width(), height = input.Height();
+        const uint32_t outWidth = width * outTileWidth / tileWidth, outHeight = height * outTileHeight / tileHeight;
+
+        auto columns = SplitAxis(width, tileWidth, m_Halo);
+        auto rows = SplitAxis(height, tileHeight, m_Halo);
+
+        struct Job { uint32_t batch; const Span* column; const Span* row; };
+        vector<Job> jobs;
+        for (uint32_t b = 0; b < input.Batch(); ++b)
+        for (auto& row : rows)
+        for (auto& column : columns)
+            jobs.push_back({ b, &column, &row });
+
+        Tensor output(Shape(outWidth, outHeight, outDepth, input.Batch()));
+        output.OverrideHost();
+        float* outputData = output.Values();
+
+        input.CopyToHost();
+        const float* inputData = input.Values();
+
+        Tensor tiles(Shape::From(m_TileShape, m_TilesPerBatch));
+
+        for (size_t first = 0; first < jobs.size(); first += m_TilesPerBatch)
+        {
+            const int tilesNum = (int)min<size_t>(m_TilesPerBatch, jobs.size() - first);
+            tiles.ResizeBatch(tilesNum);
+            tiles.OverrideHost();
+            float* tilesData = tiles.Values();
+
+            #pragma omp parallel for
+            for (int i = 0; i < tilesNum; ++i)
+            {
+                auto& job = jobs[first + i];
+                for (uint32_t d = 0; d < depth; ++d)
+                for (uint32_t y = 0; y < tileHeight; ++y)
+                {
+                    const float* src = inputData + (((size_t)job.batch * depth + d) * height + job.row->origin + y) * width + job.column->origin;
+                    float* dest = tilesData + (((size_t)i * depth + d) * tileHeight + y) * tileWidth;
+                    memcpy(dest, src, tileWidth * sizeof(float));
+                }
+            }
+
+            auto& result = *m_Model->Predict(tiles)[0];
+            result.CopyToHost();
+            const float* resultData = result.Values();
+
+            // only cores are copied so every output pixel is written exactly once
+            #pragma omp parallel for
+            for (int i = 0; i < tilesNum; ++i)
+            {
+                auto& job = jobs[first + i];
+                const uint32_t coreX = job.column->coreStart * outTileWidth / tileWidth, coreY = job.row->coreStart * outTileHeight / tileHeight;
+                const uint32_t coreWidth = job.column->coreLength * outTileWidth / tileWidth, coreHeight = job.row->coreLength * outTileHeight / tileHeight;
+                const uint32_t offsetX = coreX - job.column->origin * outTileWidth / tileWidth, offsetY = coreY - job.row->origin * outTileHeight / tileHeight;
+
+                for (uint32_t d = 0; d < outDepth; ++d)
+                for (uint32_t y = 0; y < coreHeight; ++y)
+                {
+                    const float* src = resultData + (((size_t)i * outDepth + d) * outTileHeight + offsetY + y) * outTileWidth + offsetX;
+                    float* dest = outputData + (((size_t)job.batch * outDepth + d) * outHeight + coreY + y) * outWidth + coreX;
+                    memcpy(dest, src, coreWidth * sizeof(float));
+                }
+            }
+        }
+
+        return output;
+    }
+}
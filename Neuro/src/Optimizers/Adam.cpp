@@ -47,14 +47,14 @@ namespace Neuro
 
     //////////////////////////////////////////////////////////////////////////
     Adam::MinimizationOperation::MinimizationOperation(const vector<TensorLike*>& losses, const vector<Variable*>& vars, Variable* globalStep, TensorLike* lr, float beta1, float beta2, float epsilon)
-        : Operation(MergeVectors({ losses, vector<TensorLike*>{ lr } }), "adam_minimize"), m_Vars(vars), m_GlobalStep(globalStep), m_LearningRate(lr), m_Beta1(beta1), m_Beta2(beta2), m_Epsilon(epsilon)
+        : MinimizationOperationBase(losses, { lr }, vars, "adam_minimize"), m_GlobalStep(globalStep), m_LearningRate(lr), m_Beta1(beta1), m_Beta2(beta2), m_Epsilon(epsilon)
     {
-        m_Order = Graph::Default()->BuildBackwardOrder(losses, m_NodesAffectingLosses, vars);
     }
 
     //////////////////////////////////////////////////////////////////////////
     void Adam::MinimizationOperation::Reset()
     {
+        __super::Reset();
         m_MGradients.clear();
         m_VGradients.clear();
         m_Iteration = 0;
@@ -65,8 +65,10 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void Adam::MinimizationOperation::ComputeInternal()
     {
-        m_InputsManuallyConsumed = true;
-        auto vars = Graph::Default()->ComputeGradientsInOrder(m_Order, m_InputNodes, m_NodesAffectingLosses, m_Vars);
+        auto vars = ComputeGradients();
+        if (vars.empty())
+            return; // gradients are still being accumulated
+
         ++m_Iteration;
 
         if (m_MGradients.size() != vars.size())
@@ -1,5 +1,135 @@
-﻿
+﻿#include "Optimizers/OptimizerBase.h"
+#include "ComputationalGraph/Variable.h"
+#include "ComputationalGraph/Graph.h"
+#include "Distributed/GradientsAllReducer.h"
+#include "Tools.h"
+
 namespace Neuro
 {
-    
-}
+    //////////////////////////////////////////////////////////////////////////
+    MinimizationOperationBase::MinimizationOperationBase(const vector<TensorLike*>& losses, const vector<TensorLike*>& extraInputs, const vector<Variable*>& vars, const string& name)
+        : Operation(MergeVectors({ losses, extraInputs }), name), m_Vars(vars)
+    {
+        m_Order = Graph::Default()->BuildBackwardOrder(losses, m_NodesAffectingLosses, vars);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    MinimizationOperationBase::~MinimizationOperationBase()
+    {
+        delete m_AllReducer;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void MinimizationOperationBase::Reset()
+    {
+        m_AccumulatedSteps = 0;
+        m_AccumulatedGradients.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void MinimizationOperationBase::AccumulationSteps(uint32_t steps)
+    {
+        NEURO_ASSERT(steps > 0, "Number of accumulation steps must be positive.");
+        NEURO_ASSERT(m_AccumulatedSteps == 0, "Changing number of accumulation steps in the middle of accumulation.");
+        m_AccumulationSteps = steps;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void MinimizationOperationBase::Replicas(const vector<TensorLike*>& replicasLosses)
+    {
+        vector<unordered_set<TensorLike*>> replicasNodes;
+        for (auto loss : replicasLosses)
+        {
+            unordered_set<TensorLike*> nodesAffectingLoss;
+            auto order = Graph::Default()->BuildBackwardOrder({ loss }, nodesAffectingLoss, m_Vars);
+            replicasNodes.push_back(unordered_set<TensorLike*>(order.begin(), order.end()));
+        }
+
+        m_ReplicatedOrder = Graph::Default()->SplitOrder(m_Order, replicasNodes, true);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void MinimizationOperationBase::Distribute(Communicator* communicator, size_t bucketSizeInBytes)
+    {
+        delete m_AllReducer;
+        m_AllReducer = communicator ? new GradientsAllReducer(communicator, bucketSizeInBytes) : nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void MinimizationOperationBase::DistributedWeight(float weight)
+    {
+        if (m_AllReducer)
+            m_AllReducer->LocalWeight(weight);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    vector<Variable*> MinimizationOperationBase::ComputeGradients()
+    {
+        m_InputsManuallyConsumed = true; // loss outputs will be completely obliterated after gradients computation
+
+        // when accumulating only the final sum is reduced across processes
+        function<void(Variable*)> gradientReady;
+        if (m_AllReducer && m_AccumulationSteps == 1)
+            gradientReady = [&](Variable* var) { m_AllReducer->GradientReady(var); };
+
+        vector<Variable*> vars;
+        if (m_ReplicatedOrder.replicas.empty())
+            vars = Graph::Default()->ComputeGradientsInOrder(m_Order, m_InputNodes, m_NodesAffectingLosses, m_Vars, gradientReady);
+        else
+        {
+            auto graph = Graph::Default();
+            graph->ComputeGradientsInOrder(m_ReplicatedOrder.prologue, m_InputNodes, m_NodesAffectingLosses, m_Vars);
+
+            const int replicasNum = (int)m_ReplicatedOrder.replicas.size();
+            #pragma omp parallel for num_threads(replicasNum) schedule(static, 1)
+            for (int r = 0; r < replicasNum; ++r)
+                graph->ComputeGradientsInOrder(m_ReplicatedOrder.replicas[r], m_InputNodes, m_NodesAffectingLosses, m_Vars);
+
+            // shared variables are visited last, their gradients are sums of all replicas' contributions
+            vars = graph->ComputeGradientsInOrder(m_ReplicatedOrder.epilogue, m_InputNodes, m_NodesAffectingLosses, m_Vars, gradientReady);
+        }
+
+        if (m_AccumulationSteps == 1)
+        {
+            if (m_AllReducer)
+                m_AllReducer->Finish();
+            return vars;
+        }
+
+        float weight = m_MicroBatchWeight < 0 ? 1.f / m_AccumulationSteps : m_MicroBatchWeight;
+
+        if (m_AccumulatedSteps == 0)
+        {
+            m_AccumulatedGradients.resize(vars.size());
+            for (size_t i = 0; i < vars.size(); ++i)
+            {
+                m_AccumulatedGradients[i].Resize(vars[i]->OutputGrad().GetShape());
+                vars[i]->OutputGrad().Mul(weight, m_AccumulatedGradients[i]);
+            }
+        }
+        else
+        {
+            NEURO_ASSERT(m_AccumulatedGradients.size() == vars.size(), "Set of trained variables changed during accumulation.");
+            for (size_t i = 0; i < vars.size(); ++i)
+                m_AccumulatedGradients[i].Add(1.f, weight, vars[i]->OutputGrad(), m_AccumulatedGradients[i]);
+        }
+
+        if (++m_AccumulatedSteps < m_AccumulationSteps)
+            return {};
+
+        for (size_t i = 0; i < vars.size(); ++i)
+        {
+            m_AccumulatedGradients[i].CopyTo(vars[i]->OutputGrad());
+            m_AccumulatedGradients[i].ReleaseData();
+
+            if (m_AllReducer)
+                m_AllReducer->GradientReady(vars[i]);
+        }
+
+        if (m_AllReducer)
+            m_AllReducer->Finish();
+
+        m_AccumulatedSteps = 0;
+        return vars;
+    }
+}
\ No newline at end of file
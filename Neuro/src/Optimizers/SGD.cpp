@@ -36,16 +36,14 @@ namespace Neuro
 
     //////////////////////////////////////////////////////////////////////////
     SGD::MinimizationOperation::MinimizationOperation(const vector<TensorLike*>& losses, const vector<Variable*>& vars, float lr)
-        : Operation(losses, "sgd_minimize"), m_Vars(vars), m_LearningRate(lr)
+        : MinimizationOperationBase(losses, {}, vars, "sgd_minimize"), m_LearningRate(lr)
     {
-        m_Order = Graph::Default()->BuildBackwardOrder(losses, m_NodesAffectingLosses, vars);
     }
 
     //////////////////////////////////////////////////////////////////////////
     void SGD::MinimizationOperation::ComputeInternal()
     {
-        m_InputsManuallyConsumed = true; // loss outputs will be completely obliterated after gradients computation
-        auto vars = Graph::Default()->ComputeGradientsInOrder(m_Order, m_InputNodes, m_NodesAffectingLosses, m_Vars);
+        auto vars = ComputeGradients();
 
         for (auto v : vars)
             Tensor::ActiveOp()->SgdStep(v->Output(), v->OutputGrad(), /*batchSize, */m_LearningRate);
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <typeinfo>
+
+#include "Profiler.h"
+#include "ComputationalGraph/Operation.h"
+
+namespace Neuro
+{
+    atomic<bool> Profiler::s_Enabled(false);
+
+    namespace
+    {
+        struct ThreadBuffer
+        {
+            uint32_t threadId;
+            vector<ProfileEvent> events;
+        };
+
+        // buffers are owned by profiler so events recorded by threads which already finished are not lost
+        mutex g_BuffersMtx;
+        vector<unique_ptr<ThreadBuffer>> g_Buffers;
+        const auto g_Epoch = chrono::steady_clock::now();
+
+        thread_local ThreadBuffer* t_Buffer = nullptr;
+        thread_local size_t t_AllocatedBytes = 0;
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            if (!t_Buffer)
+            {
+                lock_guard<mutex> lock(g_BuffersMtx);
+                g_Buffers.push_back(make_unique<ThreadBuffer>());
+                t_Buffer = g_Buffers.back().get();
+                t_Buffer->threadId = (uint32_t)g_Buffers.size();
+                t_Buffer->events.reserve(4096);
+            }
+            return *t_Buffer;
+        }
+
+        string EscapeJson(const string& str)
+        {
+            string result;
+            result.reserve(str.size());
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    result += '\\';
+                if ((unsigned char)c >= 0x20)
+                    result += c;
+            }
+            return result;
+        }
+
+        string OpTypeName(const Operation* op)
+        {
+            // MSVC returns "class Neuro::Conv2dOp"
+            string name = typeid(*op).name();
+            size_t pos = name.rfind(':');
+            return pos == string::npos ? name : name.substr(pos + 1);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Profiler::Enable(bool enable)
+    {
+        s_Enabled = enable;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Profiler::Clear()
+    {
+        lock_guard<mutex> lock(g_BuffersMtx);
+        for (auto& buffer : g_Buffers)
+            buffer->events.clear();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    int64_t Profiler::NowUs()
+    {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - g_Epoch).count();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Profiler::Record(const string& name, const string& type, const char* category, int64_t startUs, size_t bytesAllocated, uint64_t flops)
+    {
+        auto& buffer = GetThreadBuffer();
+        buffer.events.push_back({ name, type, category, startUs, NowUs() - startUs, buffer.threadId, bytesAllocated, flops });
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Profiler::RecordAllocation(size_t size)
+    {
+        t_AllocatedBytes += size;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t Profiler::ThreadAllocatedBytes()
+    {
+        return t_AllocatedBytes;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    vector<ProfileEvent> Profiler::CollectEvents()
+    {
+        lock_guard<mutex> lock(g_BuffersMtx);
+        vector<ProfileEvent> events;
+        for (auto& buffer : g_Buffers)
+            events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+        sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b) { return a.startUs < b.startUs; });
+        return events;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Profiler::ExportChromeTrace(const string& filename)
+    {
+        auto events = CollectEvents();
+
+        ofstream stream(filename);
+        stream << "{\"traceEvents\":[" << endl;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            auto& e = events[i];
+            stream << "{\"name\":\"" << EscapeJson(e.name) << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.threadId
+                   << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs
+                   << ",\"args\":{\"type\":\"" << e.type << "\",\"bytes\":" << e.bytesAllocated << ",\"flops\":" << e.flops << "}}"
+                   << (i + 1 < events.size() ? "," : "") << endl;
+        }
+        stream << "],\"displayTimeUnit\":\"ms\"}" << endl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    string Profiler::Summary()
+    {
+        struct Stats
+        {
+            size_t count = 0;
+            int64_t totalUs = 0;
+            size_t bytes = 0;
+            uint64_t flops = 0;
+        };
+
+        // only operation events are aggregated
+        map<pair<string, string>, Stats> stats;
+        int64_t totalUs = 0;
+        for (auto& e : CollectEvents())
+        {
+            string category = e.category;
+            if (category != "forward" && category != "backward")
+                continue;
+
+            auto& s = stats[make_pair(e.type, category)];
+            ++s.count;
+            s.totalUs += e.durationUs;
+            s.bytes += e.bytesAllocated;
+            s.flops += e.flops;
+            totalUs += e.durationUs;
+        }
+
+        vector<pair<pair<string, string>, Stats>> rows(stats.begin(), stats.end());
+        sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.second.totalUs > b.second.totalUs; });
+
+        stringstream ss;
+        ss << left << setw(30) << "Operation" << setw(10) << "Pass" << right << setw(8) << "Calls" << setw(14) << "Total [ms]" << setw(8) << "%"
+           << setw(12) << "Avg [us]" << setw(14) << "Alloc [MB]" << setw(10) << "GFLOP/s" << endl;
+        ss << string(106, '_') << endl;
+        ss << fixed;
+        for (auto& row : rows)
+        {
+            auto& s = row.second;
+            ss << left << setw(30) << row.first.first << setw(10) << row.first.second << right << setw(8) << s.count
+               << setprecision(2) << setw(14) << s.totalUs * 0.001 << setprecision(1) << setw(8) << (totalUs ? s.totalUs * 100.0 / totalUs : 0.0)
+               << setw(12) << (double)s.totalUs / s.count << setprecision(2) << setw(14) << s.bytes / (1024.0 * 1024.0)
+               << setw(10) << (s.totalUs ? s.flops * 1e-3 / s.totalUs : 0.0) << endl;
+        }
+        ss << string(106, '_') << endl;
+        ss << "Total: " << setprecision(2) << totalUs * 0.001 << "ms" << endl;
+        return ss.str();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    OpProfile::OpProfile(const Operation* op, bool backward)
+    {
+        if (!Profiler::IsEnabled())
+            return;
+
+        m_Op = op;
+        m_Backward = backward;
+        m_StartBytes = Profiler::ThreadAllocatedBytes();
+        m_StartUs = Profiler::NowUs();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    OpProfile::~OpProfile()
+    {
+        if (!m_Op)
+            return;
+
+        // backward pass usually requires twice as much work as forward (gradient wrt. inputs and wrt. parameters)
+        uint64_t flops = m_Op->Flops() * (m_Backward ? 2 : 1);
+        Profiler::Record(m_Op->Name(), OpTypeName(m_Op), m_Backward ? "backward" : "forward", m_StartUs, Profiler::ThreadAllocatedBytes() - m_StartBytes, flops);
+    }
+}
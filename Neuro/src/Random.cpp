@@ -1,5 +1,7 @@
-#include "Random.h"
+#define _USE_MATH_DEFINES
+#include <cmath>
 #include <ctime>
+#include "Random.h"
 
 namespace Neuro
 {
@@ -48,5 +50,136 @@ namespace Neuro
 		uniform_real_distribution<float> range(min, max);
 		return range(m_Engine);
 	}
-}
 
+    namespace
+    {
+        const uint32_t PHILOX_M0 = 0xD2511F53;
+        const uint32_t PHILOX_M1 = 0xCD9E8D57;
+        const uint32_t PHILOX_W0 = 0x9E3779B9;
+        const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+        // converts 4 random numbers into 4 normally distributed values using Box-Muller transform
+        inline void BoxMuller(const uint32_t r[4], float out[4])
+        {
+            for (int i = 0; i < 4; i += 2)
+            {
+                float u1 = ((r[i] >> 8) + 1) * (1.f / 16777216.f); // (0, 1] so log is finite
+                float u2 = Philox::ToUniform(r[i + 1]);
+                float radius = ::sqrt(-2.f * ::log(u1));
+                out[i] = radius * ::cos(2.f * (float)M_PI * u2);
+                out[i + 1] = radius * ::sin(2.f * (float)M_PI * u2);
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    Philox::Philox(uint64_t seed)
+    {
+        Seed(seed);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Philox::Seed(uint64_t seed)
+    {
+        m_Key = seed == 0 ? (uint64_t)time(nullptr) : seed;
+        m_NextBlock = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    uint64_t Philox::Reserve(size_t count)
+    {
+        return m_NextBlock.fetch_add((count + 3) / 4);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Philox::Generate(uint64_t key, uint64_t block, uint64_t stream, uint32_t out[4])
+    {
+        uint32_t c0 = (uint32_t)block, c1 = (uint32_t)(block >> 32), c2 = (uint32_t)stream, c3 = (uint32_t)(stream >> 32);
+        uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+
+        for (int round = 0; round < 10; ++round)
+        {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c0 = n0; c1 = (uint32_t)p1; c2 = n2; c3 = (uint32_t)p0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Philox::FillUniform(float* dest, size_t count, float min, float max)
+    {
+        uint64_t firstBlock = Reserve(count);
+        int blocks = (int)((count + 3) / 4);
+        float range = max - min;
+
+        #pragma omp parallel for if (blocks > 256)
+        for (int b = 0; b < blocks; ++b)
+        {
+            uint32_t r[4];
+            Generate(m_Key, firstBlock + b, 0, r);
+            size_t i = (size_t)b * 4;
+            size_t n = count - i < 4 ? count - i : 4;
+            for (size_t j = 0; j < n; ++j)
+                dest[i + j] = min + ToUniform(r[j]) * range;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Philox::FillNormal(float* dest, size_t count, float mean, float stdDeviation, float scale, bool truncated)
+    {
+        uint64_t firstBlock = Reserve(count);
+        int blocks = (int)((count + 3) / 4);
+        float variance = stdDeviation * stdDeviation;
+
+        #pragma omp parallel for if (blocks > 256)
+        for (int b = 0; b < blocks; ++b)
+        {
+            uint32_t r[4];
+            float z[4];
+            Generate(m_Key, firstBlock + b, 0, r);
+            BoxMuller(r, z);
+
+            size_t i = (size_t)b * 4;
+            size_t n = count - i < 4 ? count - i : 4;
+            for (size_t j = 0; j < n; ++j)
+            {
+                float v = variance * z[j] + mean;
+                // re-picking uses further streams of the same block so result doesn't depend on other values
+                for (uint64_t stream = 1; truncated && ::fabs(v - mean) > 2.f * stdDeviation; ++stream)
+                {
+                    uint32_t rr[4];
+                    float zz[4];
+                    Generate(m_Key, firstBlock + b, stream, rr);
+                    BoxMuller(rr, zz);
+                    v = variance * zz[j] + mean;
+                }
+                dest[i + j] = v * scale;
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Philox::FillDropoutMask(float* dest, size_t count, float prob)
+    {
+        uint64_t firstBlock = Reserve(count);
+        int blocks = (int)((count + 3) / 4);
+        float keepValue = 1.f / prob;
+
+        #pragma omp parallel for if (blocks > 256)
+        for (int b = 0; b < blocks; ++b)
+        {
+            uint32_t r[4];
+            Generate(m_Key, firstBlock + b, 0, r);
+            size_t i = (size_t)b * 4;
+            size_t n = count - i < 4 ? count - i : 4;
+            for (size_t j = 0; j < n; ++j)
+                dest[i + j] = ToUniform(r[j]) < prob ? 0.f : keepValue;
+        }
+    }
+}
@@ -0,0 +1,525 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "Tensors/FastMath.h"
+
+#if defined(_MSC_VER) || (defined(__AVX2__) && defined(__FMA__))
+#define NEURO_FASTMATH_AVX2
+#endif
+#if defined(_MSC_VER) || defined(__AVX512F__)
+#define NEURO_FASTMATH_AVX512
+#endif
+
+namespace Neuro
+{
+    using namespace std;
+
+    namespace
+    {
+        enum EIsa { Scalar, Avx2, Avx512 };
+
+        //////////////////////////////////////////////////////////////////////////
+        EIsa DetectIsa()
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return Scalar;
+
+            __cpuid(info, 1);
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx)
+                return Scalar;
+
+            // OS has to preserve ymm (and zmm/opmask) registers on context switch
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            const bool avx2 = (info[1] & (1 << 5)) != 0;
+            const bool avx512f = (info[1] & (1 << 16)) != 0;
+
+            if (avx512f && (xcr0 & 0xE6) == 0xE6)
+                return Avx512;
+            if (avx2 && fma && (xcr0 & 0x6) == 0x6)
+                return Avx2;
+            return Scalar;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+#if defined(NEURO_FASTMATH_AVX512)
+            if (__builtin_cpu_supports("avx512f"))
+                return Avx512;
+#endif
+#if defined(NEURO_FASTMATH_AVX2)
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                return Avx2;
+#endif
+            return Scalar;
+#else
+            return Scalar;
+#endif
+        }
+
+        const EIsa g_SupportedIsa = DetectIsa();
+        EIsa g_Isa = g_SupportedIsa;
+
+        //////////////////////////////////////////////////////////////////////////
+        struct ScalarLane
+        {
+            typedef float V;
+            typedef bool M;
+            static const size_t Width = 1;
+
+            static V Load(const float* p) { return *p; }
+            static void Store(float* p, V v) { *p = v; }
+            static V Set(float c) { return c; }
+            static V Add(V a, V b) { return a + b; }
+            static V Sub(V a, V b) { return a - b; }
+            static V Mul(V a, V b) { return a * b; }
+            static V Div(V a, V b) { return a / b; }
+            // fused like vfmadd so scalar fallback rounds the same way as SIMD lanes
+            static V Fma(V a, V b, V c) { return std::fma(a, b, c); }
+            // same semantics as minps/maxps, second operand is returned when any of them is NaN
+            static V Min(V a, V b) { return a < b ? a : b; }
+            static V Max(V a, V b) { return a > b ? a : b; }
+            static V Floor(V a) { return floor(a); }
+            static V Abs(V a) { return fabs(a); }
+            static V CopySign(V magnitude, V sign) { return copysign(magnitude, sign); }
+            static M Lt(V a, V b) { return a < b; }
+            static M Gt(V a, V b) { return a > b; }
+            static M Ge(V a, V b) { return a >= b; }
+            static M Eq(V a, V b) { return a == b; }
+            static M NotGe(V a, V b) { return !(a >= b); }
+            static V Select(M m, V a, V b) { return m ? a : b; }
+
+            // 2^n for integral n in [-126, 127]
+            static V Pow2(V n)
+            {
+                uint32_t bits = n == n ? (uint32_t)((int)n + 127) << 23 : 0;
+                float result;
+                memcpy(&result, &bits, sizeof(result));
+                return result;
+            }
+
+            // splits positive normal number into exponent and mantissa in [0.5, 1)
+            static V Exponent(V a)
+            {
+                uint32_t bits;
+                memcpy(&bits, &a, sizeof(bits));
+                return (float)((int)((bits >> 23) & 0xFF) - 126);
+            }
+
+            static V Mantissa(V a)
+            {
+                uint32_t bits;
+                memcpy(&bits, &a, sizeof(bits));
+                bits = (bits & 0x007FFFFF) | 0x3F000000;
+                float result;
+                memcpy(&result, &bits, sizeof(result));
+                return result;
+            }
+        };
+
+#if defined(NEURO_FASTMATH_AVX2)
+        //////////////////////////////////////////////////////////////////////////
+        struct Avx2Lane
+        {
+            typedef __m256 V;
+            typedef __m256 M;
+            static const size_t Width = 8;
+
+            static V Load(const float* p) { return _mm256_loadu_ps(p); }
+            static void Store(float* p, V v) { _mm256_storeu_ps(p, v); }
+            static V Set(float c) { return _mm256_set1_ps(c); }
+            static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+            static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+            static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+            static V Div(V a, V b) { return _mm256_div_ps(a, b); }
+            static V Fma(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+            static V Min(V a, V b) { return _mm256_min_ps(a, b); }
+            static V Max(V a, V b) { return _mm256_max_ps(a, b); }
+            static V Floor(V a) { return _mm256_floor_ps(a); }
+            static V Abs(V a) { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF))); }
+            static V CopySign(V magnitude, V sign) { return _mm256_or_ps(Abs(magnitude), _mm256_and_ps(sign, _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000)))); }
+            static M Lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static M Gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            static M Ge(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+            static M Eq(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+            static M NotGe(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_NGE_UQ); }
+            static V Select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+
+            static V Pow2(V n) { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23)); }
+
+            static V Exponent(V a)
+            {
+                __m256i e = _mm256_and_si256(_mm256_srli_epi32(_mm256_castps_si256(a), 23), _mm256_set1_epi32(0xFF));
+                return _mm256_cvtepi32_ps(_mm256_sub_epi32(e, _mm256_set1_epi32(126)));
+            }
+
+            static V Mantissa(V a)
+            {
+                __m256i m = _mm256_and_si256(_mm256_castps_si256(a), _mm256_set1_epi32(0x007FFFFF));
+                return _mm256_castsi256_ps(_mm256_or_si256(m, _mm256_set1_epi32(0x3F000000)));
+            }
+        };
+#endif
+
+#if defined(NEURO_FASTMATH_AVX512)
+        //////////////////////////////////////////////////////////////////////////
+        struct Avx512Lane
+        {
+            typedef __m512 V;
+            typedef __mmask16 M;
+            static const size_t Width = 16;
+
+            static V Load(const float* p) { return _mm512_loadu_ps(p); }
+            static void Store(float* p, V v) { _mm512_storeu_ps(p, v); }
+            static V Set(float c) { return _mm512_set1_ps(c); }
+            static V Add(V a, V b) { return _mm512_add_ps(a, b); }
+            static V Sub(V a, V b) { return _mm512_sub_ps(a, b); }
+            static V Mul(V a, V b) { return _mm512_mul_ps(a, b); }
+            static V Div(V a, V b) { return _mm512_div_ps(a, b); }
+            static V Fma(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+            static V Min(V a, V b) { return _mm512_min_ps(a, b); }
+            static V Max(V a, V b) { return _mm512_max_ps(a, b); }
+            static V Floor(V a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+            static V Abs(V a) { return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x7FFFFFFF))); }
+            static V CopySign(V magnitude, V sign) { return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_castps_si512(Abs(magnitude)), _mm512_and_epi32(_mm512_castps_si512(sign), _mm512_set1_epi32((int)0x80000000)))); }
+            static M Lt(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+            static M Gt(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+            static M Ge(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+            static M Eq(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+            static M NotGe(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_NGE_UQ); }
+            static V Select(M m, V a, V b) { return _mm512_mask_blend_ps(m, b, a); }
+
+            static V Pow2(V n) { return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23)); }
+
+            static V Exponent(V a)
+            {
+                __m512i e = _mm512_and_epi32(_mm512_srli_epi32(_mm512_castps_si512(a), 23), _mm512_set1_epi32(0xFF));
+                return _mm512_cvtepi32_ps(_mm512_sub_epi32(e, _mm512_set1_epi32(126)));
+            }
+
+            static V Mantissa(V a)
+            {
+                __m512i m = _mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x007FFFFF));
+                return _mm512_castsi512_ps(_mm512_or_epi32(m, _mm512_set1_epi32(0x3F000000)));
+            }
+        };
+#endif
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class L>
+        typename L::V Exp(typename L::V x)
+        {
+            typedef typename L::V V;
+
+            // below lower bound result underflows to zero, above upper bound it overflows to infinity
+            x = L::Max(L::Set(-104.f), L::Min(L::Set(89.f), x));
+
+            // x = n * ln2 + r, |r| <= ln2 / 2 (ln2 is split in two parts so n * ln2_hi is exact)
+            V n = L::Floor(L::Fma(x, L::Set(1.44269504088896341f), L::Set(0.5f)));
+            V r = L::Fma(n, L::Set(-0.693359375f), x);
+            r = L::Fma(n, L::Set(2.12194440e-4f), r);
+
+            V p = L::Set(1.9875691500e-4f);
+            p = L::Fma(p, r, L::Set(1.3981999507e-3f));
+            p = L::Fma(p, r, L::Set(8.3334519073e-3f));
+            p = L::Fma(p, r, L::Set(4.1665795894e-2f));
+            p = L::Fma(p, r, L::Set(1.6666665459e-1f));
+            p = L::Fma(p, r, L::Set(5.0000001201e-1f));
+            p = L::Fma(p, L::Mul(r, r), L::Add(r, L::Set(1.f)));
+
+            // n is in [-150, 128] so scaling is done in two steps keeping both factors representable,
+            // this also produces properly rounded subnormal results
+            V n1 = L::Floor(L::Mul(n, L::Set(0.5f)));
+            return L::Mul(L::Mul(p, L::Pow2(n1)), L::Pow2(L::Sub(n, n1)));
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class L>
+        typename L::V Log(typename L::V x)
+        {
+            typedef typename L::V V;
+            typedef typename L::M M;
+
+            // subnormals are moved to normal range first
+            M subnormal = L::Lt(x, L::Set(FLT_MIN));
+            V xs = L::Select(subnormal, L::Mul(x, L::Set(8388608.f)), x);
+            V e = L::Sub(L::Exponent(xs), L::Select(subnormal, L::Set(23.f), L::Set(0.f)));
+            V m = L::Mantissa(xs);
+
+            // x = 2^e * (1 + m), sqrt(0.5) <= 1 + m < sqrt(2)
+            M small = L::Lt(m, L::Set(0.707106781186547524f));
+            e = L::Sub(e, L::Select(small, L::Set(1.f), L::Set(0.f)));
+            m = L::Sub(L::Add(m, L::Select(small, m, L::Set(0.f))), L::Set(1.f));
+
+            V z = L::Mul(m, m);
+            V p = L::Set(7.0376836292e-2f);
+            p = L::Fma(p, m, L::Set(-1.1514610310e-1f));
+            p = L::Fma(p, m, L::Set(1.1676998740e-1f));
+            p = L::Fma(p, m, L::Set(-1.2420140846e-1f));
+            p = L::Fma(p, m, L::Set(1.4249322787e-1f));
+            p = L::Fma(p, m, L::Set(-1.6668057665e-1f));
+            p = L::Fma(p, m, L::Set(2.0000714765e-1f));
+            p = L::Fma(p, m, L::Set(-2.4999993993e-1f));
+            p = L::Fma(p, m, L::Set(3.3333331174e-1f));
+
+            V y = L::Mul(L::Mul(p, m), z);
+            y = L::Fma(e, L::Set(-2.12194440e-4f), y);
+            y = L::Fma(z, L::Set(-0.5f), y);
+            V result = L::Fma(e, L::Set(0.693359375f), L::Add(m, y));
+
+            result = L::Select(L::Eq(x, L::Set(numeric_limits<float>::infinity())), x, result);
+            result = L::Select(L::Eq(x, L::Set(0.f)), L::Set(-numeric_limits<float>::infinity()), result);
+            return L::Select(L::NotGe(x, L::Set(0.f)), L::Set(numeric_limits<float>::quiet_NaN()), result);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class L>
+        typename L::V Tanh(typename L::V x)
+        {
+            typedef typename L::V V;
+
+            V a = L::Abs(x);
+
+            // odd polynomial close to zero where exp based formula suffers from cancellation
+            V z = L::Mul(x, x);
+            V p = L::Set(-5.70498872745e-3f);
+            p = L::Fma(p, z, L::Set(2.06390887954e-2f));
+            p = L::Fma(p, z, L::Set(-5.37397155531e-2f));
+            p = L::Fma(p, z, L::Set(1.33314422036e-1f));
+            p = L::Fma(p, z, L::Set(-3.33332819422e-1f));
+            V small = L::Fma(L::Mul(p, z), x, x);
+
+            V large = L::Sub(L::Set(1.f), L::Div(L::Set(2.f), L::Add(Exp<L>(L::Add(a, a)), L::Set(1.f))));
+            return L::Select(L::Lt(a, L::Set(0.625f)), small, L::CopySign(large, x));
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        struct ExpKernel
+        {
+            template<class L> typename L::V Apply(typename L::V x) const { return Exp<L>(x); }
+        };
+
+        struct LogKernel
+        {
+            template<class L> typename L::V Apply(typename L::V x) const { return Log<L>(x); }
+        };
+
+        struct SigmoidKernel
+        {
+            template<class L> typename L::V Apply(typename L::V x) const { return L::Div(L::Set(1.f), L::Add(L::Set(1.f), Exp<L>(L::Sub(L::Set(0.f), x)))); }
+        };
+
+        struct TanhKernel
+        {
+            template<class L> typename L::V Apply(typename L::V x) const { return Tanh<L>(x); }
+        };
+
+        struct EluKernel
+        {
+            float alpha;
+            template<class L> typename L::V Apply(typename L::V x) const { return L::Select(L::Ge(x, L::Set(0.f)), x, L::Mul(L::Set(alpha), L::Sub(Exp<L>(x), L::Set(1.f)))); }
+        };
+
+        struct LeakyReLUKernel
+        {
+            float alpha;
+            template<class L> typename L::V Apply(typename L::V x) const { return L::Select(L::Ge(x, L::Set(0.f)), x, L::Mul(L::Set(alpha), x)); }
+        };
+
+        // gradient kernels take activation output and output gradient
+        struct SigmoidGradientKernel
+        {
+            template<class L> typename L::V Apply(typename L::V y, typename L::V g) const { return L::Mul(L::Mul(y, L::Sub(L::Set(1.f), y)), g); }
+        };
+
+        struct TanhGradientKernel
+        {
+            template<class L> typename L::V Apply(typename L::V y, typename L::V g) const { return L::Mul(L::Fma(L::Sub(L::Set(0.f), y), y, L::Set(1.f)), g); }
+        };
+
+        struct EluGradientKernel
+        {
+            float alpha;
+            template<class L> typename L::V Apply(typename L::V y, typename L::V g) const { return L::Select(L::Gt(y, L::Set(0.f)), g, L::Mul(L::Add(y, L::Set(alpha)), g)); }
+        };
+
+        struct LeakyReLUGradientKernel
+        {
+            float alpha;
+            template<class L> typename L::V Apply(typename L::V y, typename L::V g) const { return L::Select(L::Gt(y, L::Set(0.f)), g, L::Mul(L::Set(alpha), g)); }
+        };
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class L, class K>
+        void Transform(const K& kernel, const float* input, size_t count, float* output)
+        {
+            size_t i = 0;
+            for (; i + L::Width <= count; i += L::Width)
+                L::Store(output + i, kernel.template Apply<L>(L::Load(input + i)));
+            // tail goes through the same polynomial so results don't depend on position in array
+            for (; i < count; ++i)
+                output[i] = kernel.template Apply<ScalarLane>(input[i]);
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class L, class K>
+        void Transform(const K& kernel, const float* input1, const float* input2, size_t count, float* output)
+        {
+            size_t i = 0;
+            for (; i + L::Width <= count; i += L::Width)
+                L::Store(output + i, kernel.template Apply<L>(L::Load(input1 + i), L::Load(input2 + i)));
+            for (; i < count; ++i)
+                output[i] = kernel.template Apply<ScalarLane>(input1[i], input2[i]);
+        }
+
+        const size_t BlockSize = 16 * 1024;
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class K>
+        void Run(const K& kernel, const float* input, size_t count, float* output)
+        {
+            const EIsa isa = g_Isa;
+            (void)isa; // unused when no SIMD path is compiled in
+            const int blocksNum = (int)((count + BlockSize - 1) / BlockSize);
+
+            #pragma omp parallel for if (blocksNum > 1)
+            for (int b = 0; b < blocksNum; ++b)
+            {
+                const size_t first = b * BlockSize;
+                const size_t length = min(BlockSize, count - first);
+#if defined(NEURO_FASTMATH_AVX512)
+                if (isa == Avx512)
+                {
+                    Transform<Avx512Lane>(kernel, input + first, length, output + first);
+                    continue;
+                }
+#endif
+#if defined(NEURO_FASTMATH_AVX2)
+                if (isa == Avx2)
+                {
+                    Transform<Avx2Lane>(kernel, input + first, length, output + first);
+                    continue;
+                }
+#endif
+                Transform<ScalarLane>(kernel, input + first, length, output + first);
+            }
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        template<class K>
+        void Run(const K& kernel, const float* input1, const float* input2, size_t count, float* output)
+        {
+            const EIsa isa = g_Isa;
+            (void)isa; // unused when no SIMD path is compiled in
+            const int blocksNum = (int)((count + BlockSize - 1) / BlockSize);
+
+            #pragma omp parallel for if (blocksNum > 1)
+            for (int b = 0; b < blocksNum; ++b)
+            {
+                const size_t first = b * BlockSize;
+                const size_t length = min(BlockSize, count - first);
+#if defined(NEURO_FASTMATH_AVX512)
+                if (isa == Avx512)
+                {
+                    Transform<Avx512Lane>(kernel, input1 + first, input2 + first, length, output + first);
+                    continue;
+                }
+#endif
+#if defined(NEURO_FASTMATH_AVX2)
+                if (isa == Avx2)
+                {
+                    Transform<Avx2Lane>(kernel, input1 + first, input2 + first, length, output + first);
+                    continue;
+                }
+#endif
+                Transform<ScalarLane>(kernel, input1 + first, input2 + first, length, output + first);
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastExp(const float* input, size_t count, float* output)
+    {
+        Run(ExpKernel(), input, count, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastLog(const float* input, size_t count, float* output)
+    {
+        Run(LogKernel(), input, count, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastSigmoid(const float* input, size_t count, float* output)
+    {
+        Run(SigmoidKernel(), input, count, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastSigmoidGradient(const float* output, const float* outputGradient, size_t count, float* inputGradient)
+    {
+        Run(SigmoidGradientKernel(), output, outputGradient, count, inputGradient);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastTanh(const float* input, size_t count, float* output)
+    {
+        Run(TanhKernel(), input, count, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastTanhGradient(const float* output, const float* outputGradient, size_t count, float* inputGradient)
+    {
+        Run(TanhGradientKernel(), output, outputGradient, count, inputGradient);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastElu(const float* input, size_t count, float alpha, float* output)
+    {
+        Run(EluKernel{ alpha }, input, count, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastEluGradient(const float* output, const float* outputGradient, size_t count, float alpha, float* inputGradient)
+    {
+        Run(EluGradientKernel{ alpha }, output, outputGradient, count, inputGradient);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastLeakyReLU(const float* input, size_t count, float alpha, float* output)
+    {
+        Run(LeakyReLUKernel{ alpha }, input, count, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void FastLeakyReLUGradient(const float* output, const float* outputGradient, size_t count, float alpha, float* inputGradient)
+    {
+        Run(LeakyReLUGradientKernel{ alpha }, output, outputGradient, count, inputGradient);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void EnableFastMathSimd(bool enable)
+    {
+        g_Isa = enable ? g_SupportedIsa : Scalar;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    const char* FastMathIsa()
+    {
+        return g_Isa == Avx512 ? "avx512" : (g_Isa == Avx2 ? "avx2" : "scalar");
+    }
+}
@@ -0,0 +1,42 @@
+#include "Tensors/HalfFloat.h"
+
+namespace Neuro
+{
+    //////////////////////////////////////////////////////////////////////////
+    void PackFloats(const float* src, size_t count, EDataType type, uint16_t* dest)
+    {
+        NEURO_ASSERT(type != Float32, "Packing requires 16-bit data type.");
+
+        if (type == BFloat16)
+        {
+            #pragma omp parallel for
+            for (int i = 0; i < (int)count; ++i)
+                dest[i] = FloatToBf16(src[i]);
+        }
+        else
+        {
+            #pragma omp parallel for
+            for (int i = 0; i < (int)count; ++i)
+                dest[i] = FloatToFp16(src[i]);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void UnpackFloats(const uint16_t* src, size_t count, EDataType type, float* dest)
+    {
+        NEURO_ASSERT(type != Float32, "Unpacking requires 16-bit data type.");
+
+        if (type == BFloat16)
+        {
+            #pragma omp parallel for
+            for (int i = 0; i < (int)count; ++i)
+                dest[i] = Bf16ToFloat(src[i]);
+        }
+        else
+        {
+            #pragma omp parallel for
+            for (int i = 0; i < (int)count; ++i)
+                dest[i] = Fp16ToFloat(src[i]);
+        }
+    }
+}
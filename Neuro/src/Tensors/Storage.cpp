@@ -58,6 +58,8 @@ namespace Neuro
             FreeOnDevice(true, true);
             FreeOnHost();
             ChangeType(other.m_Type);
+            m_DataType = other.m_DataType;
+            other.Unpack();
             if (other.m_DataPtr)
             {
                 NEURO_ASSERT(other.m_DataLocation != None, "");
@@ -76,6 +78,7 @@ namespace Neuro
             m_OffloadRequested = false;
             m_FreeDeviceMemOnOffloadDone = false;
             m_FreePinnedMemOnOffloadDone = false;
+            m_Version += other.m_Version + 1; // newer than both
         }
         return *this;
     }
@@ -102,6 +105,13 @@ namespace Neuro
             other.m_DeviceDataPtr = nullptr;
             m_DataPtr = other.m_DataPtr;
             other.m_DataPtr = nullptr;
+            m_Borrowed = other.m_Borrowed;
+            other.m_Borrowed = false;
+            m_PackedDataPtr = other.m_PackedDataPtr;
+            other.m_PackedDataPtr = nullptr;
+            m_PackedDataValid = other.m_PackedDataValid;
+            m_DataType = other.m_DataType;
+            m_Version += other.m_Version + 1;
             m_OffloadEvent = other.m_OffloadEvent;
             other.m_OffloadEvent = nullptr;
             NEURO_ASSERT(!other.m_OffloadRequested, "Moving while offload in progress, this may not end well...");
@@ -127,6 +137,7 @@ namespace Neuro
     {
         FreeOnDevice(true, true);
         FreeOnHost();
+        FreePacked();
         if (m_OffloadEvent)
             CUDA_CHECK(cudaEventDestroy(m_OffloadEvent));
         if (m_PreloadEvent)
@@ -157,9 +168,24 @@ namespace Neuro
         m_Type = type;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Storage::ChangeDataType(EDataType type)
+    {
+        if (m_DataType == type)
+            return;
+
+        // existing packed data is in the old format
+        Unpack();
+        FreePacked();
+        m_DataType = type;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Storage::Resize(size_t size)
     {
+        if (size != m_Size)
+            ++m_Version;
+
         STORAGE_DEBUG_INFO("Resizing '%s' from %zu to %zu (alloc size %zu)", m_Name.c_str(), m_Size, size, m_AllocSize);
         if (size < m_AllocSize)
         {
@@ -173,11 +199,11 @@ namespace Neuro
         m_AllocSize = m_Size = size;
 
         bool wasAllocatedOnDevice = m_DeviceDataPtr != nullptr;
-        bool wasAllocatedOnHost = m_DataPtr != nullptr;
+        bool wasAllocatedOnHost = m_DataPtr != nullptr || m_PackedDataPtr != nullptr;
 
         if (m_DeviceDataPtr)
             FreeOnDevice(true, true);
-        if (m_DataPtr)
+        if (m_DataPtr || m_PackedDataPtr)
             FreeOnHost();
 
         if (wasAllocatedOnHost)
@@ -191,6 +217,7 @@ namespace Neuro
     {
         m_Name = name;
         HostMemoryManager::Default().UpdateAnnotation(m_DataPtr, name);
+        HostMemoryManager::Default().UpdateAnnotation(m_PackedDataPtr, name + "/packed");
         HostPinnedMemoryManager::Default().UpdateAnnotation(m_DataPtr, name);
         DeviceMemoryManager::Default().UpdateAnnotation(m_DeviceDataPtr, name);
     }
@@ -205,6 +232,33 @@ namespace Neuro
         m_DataRefCount = 0;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Storage::BorrowHost(float* data)
+    {
+        NEURO_ASSERT(!(m_Type & ST_Offloadable) && !m_DeviceDataPtr, "Only host storage can borrow memory.");
+        FreeOnHost();
+        STORAGE_DEBUG_INFO("Borrowing host memory '%s'\n", m_Name.c_str());
+        m_DataPtr = data;
+        m_Borrowed = true;
+        m_AllocSize = m_Size;
+        m_DataLocation = Host;
+        m_PackedDataValid = false;
+        ++m_Version;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Storage::StopBorrowing()
+    {
+        if (!m_Borrowed)
+            return;
+
+        const float* data = m_DataPtr;
+        m_DataPtr = nullptr;
+        m_Borrowed = false;
+        AllocateOnHost();
+        memcpy(m_DataPtr, data, SizeInBytes());
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Storage::AllocateOnHost() const
     {
@@ -212,6 +266,12 @@ namespace Neuro
             return;
 
         NEURO_ASSERT(!m_DeviceDataPtr, "");
+        if (IsPacked())
+        {
+            Unpack();
+            return;
+        }
+
         STORAGE_DEBUG_INFO("Allocating on host '%s' ", m_Name.c_str());
         if (m_DataPtr)
         {
@@ -244,6 +304,13 @@ namespace Neuro
         }
 
         NEURO_ASSERT(!m_DeviceDataPtr, "Data cannot be only on device.");
+
+        if (m_DataPtr || m_PackedDataPtr)
+            ++m_Version;
+
+        if (IsPacked())
+            m_DataLocation = None;
+        FreePacked();
         
         if (!m_DataPtr)
         {
@@ -251,7 +318,9 @@ namespace Neuro
             return;
         }
         STORAGE_DEBUG_INFO_NO_TS("<<< release incoming.\n");
-        if (m_Type & ST_Offloadable)
+        if (m_Borrowed)
+            m_Borrowed = false;
+        else if (m_Type & ST_Offloadable)
             HostPinnedMemoryManager::Default().Free(m_DataPtr);
         else
             HostMemoryManager::Default().Free(m_DataPtr);
@@ -266,6 +335,7 @@ namespace Neuro
         if (m_AllocSize == 0)
             return;
 
+        Unpack();
         if (!m_DataPtr)
             AllocateOnHost();
 
@@ -329,6 +399,10 @@ namespace Neuro
 
         m_FreeDeviceMemOnOffloadDone = false;
 
+        // values computed on device are lost unless they were offloaded
+        if (m_DataLocation == Device && !m_OffloadRequested)
+            ++m_Version;
+
         STORAGE_DEBUG_INFO_NO_TS("<<< release incoming.\n");
         CUDA_CHECK(DeviceMemoryManager::Default().Free((void*)m_DeviceDataPtr));
         m_DeviceDataPtr = nullptr;
@@ -530,6 +604,52 @@ namespace Neuro
             STORAGE_DEBUG_INFO("Preload '%s'[%d] <<< not supported.\n", m_Name.c_str(), m_Type);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Storage::Pack()
+    {
+        // device and pinned (offloadable) memory is handled by offloading mechanism
+        if (m_DataType == Float32 || !m_DataPtr || m_DataLocation != Host || m_DeviceDataPtr || (m_Type & ST_Offloadable) || m_Borrowed)
+            return;
+
+        if (!m_PackedDataValid)
+        {
+            if (!m_PackedDataPtr)
+                HostMemoryManager::Default().Allocate((void**)&m_PackedDataPtr, m_AllocSize * sizeof(uint16_t), m_Name + "/packed");
+
+            STORAGE_DEBUG_INFO("Packing '%s'[%d]\n", m_Name.c_str(), m_Type);
+            PackFloats(m_DataPtr, m_Size, m_DataType, m_PackedDataPtr);
+        }
+
+        HostMemoryManager::Default().Free(m_DataPtr);
+        m_DataPtr = nullptr;
+        m_PackedDataValid = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Storage::Unpack() const
+    {
+        if (!IsPacked())
+            return;
+
+        NVTXProfile p(__FUNCTION__, 0xFFB200FF);
+
+        STORAGE_DEBUG_INFO("Unpacking '%s'[%d]\n", m_Name.c_str(), m_Type);
+        HostMemoryManager::Default().Allocate((void**)&m_DataPtr, AllocSizeInBytes(), m_Name);
+        UnpackFloats(m_PackedDataPtr, m_Size, m_DataType, m_DataPtr);
+        m_PackedDataValid = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Storage::FreePacked() const
+    {
+        if (!m_PackedDataPtr)
+            return;
+
+        HostMemoryManager::Default().Free(m_PackedDataPtr);
+        m_PackedDataPtr = nullptr;
+        m_PackedDataValid = false;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Storage::CopyToDevice() const
     {
@@ -550,6 +670,7 @@ namespace Neuro
 
         NEURO_ASSERT(m_DataLocation == Host, "Attempting to copy from unallocated host memory to device.");
 
+        Unpack();
         if (!m_DeviceDataPtr)
             AllocateOnDevice();
 
@@ -573,6 +694,7 @@ namespace Neuro
 
         if (m_DataLocation == Host)
         {
+            Unpack();
             NEURO_ASSERT(m_DataPtr, "Data location is 'Host' but data pointer is null.");
             return;
         }
@@ -600,6 +722,7 @@ namespace Neuro
             }
         }
 
+        m_PackedDataValid = false;
         m_DataLocation = Host;
     }
 
@@ -608,6 +731,7 @@ namespace Neuro
     {
         if (m_DataLocation == Host)
         {
+            Unpack();
             NEURO_ASSERT(m_DataPtr, "Data location is 'Host' but data pointer is null.");
             return;
         }
@@ -619,13 +743,19 @@ namespace Neuro
 
         STORAGE_DEBUG_INFO("Sync to host '%s'\n", m_Name.c_str());
         CUDA_CHECK(cudaMemcpy((void*)m_DataPtr, (void*)m_DeviceDataPtr, SizeInBytes(), cudaMemcpyDeviceToHost));
+        m_PackedDataValid = false;
     }
 
     //////////////////////////////////////////////////////////////////////////
     void Storage::OverrideHost()
     {
+        m_PackedDataValid = false;
+        ++m_Version;
+
         if (m_DataLocation == Host)
         {
+            Unpack();
+            m_PackedDataValid = false;
             NEURO_ASSERT(m_DataPtr, "Data location is 'Host' but data pointer is null.");
             return;
         }
@@ -639,6 +769,9 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void Storage::OverrideDevice()
     {
+        m_PackedDataValid = false;
+        ++m_Version;
+
         if (m_DataLocation == Device)
         {
             NEURO_ASSERT(m_DeviceDataPtr, "Data location is 'Device' but device data pointer is null.");
@@ -726,16 +859,20 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     float* Storage::Data()
     {
+        Unpack();
         if (!m_DataPtr)
             AllocateOnHost();
 
         NEURO_ASSERT(m_DataLocation == Host, "Trying to access data that is currently located on device or unallocated.");
+        m_PackedDataValid = false;
+        ++m_Version;
         return m_DataPtr;
     }
 
     //////////////////////////////////////////////////////////////////////////
     const float* Storage::Data() const
     {
+        Unpack();
         NEURO_ASSERT(m_DataLocation == Host, "Trying to access data that is currently located on device or unallocated.");
         return m_DataPtr;
     }
@@ -746,6 +883,7 @@ namespace Neuro
         NEURO_ASSERT(m_DeviceDataPtr, "Attempting to write to unallocated device memory.");
         NEURO_ASSERT(m_DataLocation == Device, "Attempting to write to data not located on device.");
         NEURO_ASSERT(!m_OffloadRequested || m_OffloadDone, "Attempting to write to data being offloaded from device.");
+        ++m_Version;
         return m_DeviceDataPtr;
     }
 
@@ -775,6 +913,7 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void Storage::CopyWithinHost(void* destPtr) const
     {
+        Unpack();
         CopyWithinHost(destPtr, m_DataPtr, SizeInBytes());
     }
 
@@ -25,7 +25,7 @@ namespace Neuro
     TensorOpCpu* Tensor::g_OpGpu = nullptr;
 
     TensorOpCpu* Tensor::g_DefaultOp = nullptr;
-    TensorOpCpu* Tensor::g_ForcedOp = nullptr;
+    thread_local TensorOpCpu* Tensor::g_ForcedOp = nullptr;
 
     //////////////////////////////////////////////////////////////////////////
     Tensor::Tensor(const Shape& shape, const string& name, EStorageType storageType)
@@ -202,6 +202,18 @@ namespace Neuro
         m_Storage.ChangeType(type);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::SetDataType(EDataType type)
+    {
+        m_Storage.ChangeDataType(type);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::Pack()
+    {
+        m_Storage.Pack();
+    }
+
     //////////////////////////////////////////////////////////////////////////
     bool Tensor::Validate() const
     {
@@ -211,9 +223,9 @@ namespace Neuro
         //NEURO_ASSERT(m_Storage.AllocSizeInBytes(), "");
         //NEURO_ASSERT(m_Storage.IsHostAllocated(), "Not allocated on host.");
 
+        SyncToHost();
         const float* data = m_Storage.DataUnsafe();
 
-        SyncToHost();
         for (uint32_t i = 0; i < Length(); ++i)
         {
             float v = data[i];
@@ -482,6 +494,29 @@ namespace Neuro
         return output;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::GramMatrix(float scale, Tensor& output) const
+    {
+        NEURO_ASSERT(output.GetShape() == Shape(Depth(), Depth(), 1, Batch()), "Invalid gram matrix output shape " << output.GetShape().ToString() << ".");
+        Op()->GramMatrix(*this, scale, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    Tensor Tensor::GramMatrix(float scale) const
+    {
+        Tensor output(Shape(Depth(), Depth(), 1, Batch()));
+        GramMatrix(scale, output);
+        return output;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::GramMatrixGradient(const Tensor& outputGradient, float scale, Tensor& inputGradient) const
+    {
+        NEURO_ASSERT(outputGradient.GetShape() == Shape(Depth(), Depth(), 1, Batch()), "Invalid gram matrix output gradient shape " << outputGradient.GetShape().ToString() << ".");
+        NEURO_ASSERT(inputGradient.GetShape() == GetShape(), "");
+        Op()->GramMatrixGradient(*this, outputGradient, scale, inputGradient);
+    }
+
     //////////////////////////////////////////////////////////////////////////
 	void Tensor::MulElem(const Tensor& t, Tensor& result) const
 	{
@@ -792,6 +827,21 @@ namespace Neuro
         Op()->Log(*this, output);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    Tensor Tensor::Exp() const
+    {
+        Tensor result(m_Shape);
+        Exp(result);
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::Exp(Tensor& output) const
+    {
+        NEURO_ASSERT(m_Shape == output.GetShape(), "Output shape doesn't match input shape.");
+        Op()->Exp(*this, output);
+    }
+
     //////////////////////////////////////////////////////////////////////////
 	void Tensor::Map(const function<float(float)>& func, Tensor& result) const
 	{
@@ -822,6 +872,16 @@ namespace Neuro
 		return result;
 	}
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::ParallelBlocks(uint32_t count, uint32_t blockSize, const function<void(uint32_t, uint32_t)>& body)
+    {
+        const int blocksNum = (int)((count + blockSize - 1) / blockSize);
+
+        #pragma omp parallel for if (blocksNum > 1)
+        for (int b = 0; b < blocksNum; ++b)
+            body(b * blockSize, min(count, (b + 1) * blockSize));
+    }
+
     //////////////////////////////////////////////////////////////////////////
     template <int W, int H, int D, int N, bool ABS>
     Tensor SumTemplate(const Tensor& input, EAxis axis)
@@ -1177,78 +1237,194 @@ namespace Neuro
         NEURO_ASSERT(false, "Unsupported axis.");
 	}
 
+    // Output block is small enough to stay in L1 cache while all inputs are streamed through it
+    const uint32_t MERGE_BLOCK_SIZE = 4 * 1024;
+
+    //////////////////////////////////////////////////////////////////////////
+    // Single pass N-ary reduction, every input is read once and output written once. Output can be one of inputs.
+    template<class F>
+    void MergeTemplate(const const_tensor_ptr_vec_t& inputs, Tensor& output, F func, float scale)
+    {
+        for (auto input : inputs)
+        {
+            NEURO_ASSERT(input->Length() == output.Length(), "Mismatched input length, expected " << output.Length() << " received " << input->Length() << ".");
+            input->CopyToHost();
+        }
+        output.OverrideHost();
+
+        float* outputValues = output.Values();
+        vector<const float*> inputsValues;
+        for (auto input : inputs)
+            inputsValues.push_back(input->Values());
+        // aliased input has to be consumed first, before its block gets overwritten
+        auto aliased = find(inputsValues.begin(), inputsValues.end(), outputValues);
+        if (aliased != inputsValues.end())
+            iter_swap(inputsValues.begin(), aliased);
+
+        const int blocksNum = (int)((output.Length() + MERGE_BLOCK_SIZE - 1) / MERGE_BLOCK_SIZE);
+
+        #pragma omp parallel for if (blocksNum > 1)
+        for (int b = 0; b < blocksNum; ++b)
+        {
+            const uint32_t begin = b * MERGE_BLOCK_SIZE;
+            const uint32_t end = min(output.Length(), begin + MERGE_BLOCK_SIZE);
+
+            if (inputsValues.size() == 1)
+            {
+                for (uint32_t j = begin; j < end; ++j)
+                    outputValues[j] = inputsValues[0][j];
+            }
+            else
+            {
+                const float* values0 = inputsValues[0];
+                const float* values1 = inputsValues[1];
+                for (uint32_t j = begin; j < end; ++j)
+                    outputValues[j] = func(values0[j], values1[j]);
+            }
+
+            for (size_t i = 2; i < inputsValues.size(); ++i)
+            {
+                const float* values = inputsValues[i];
+                for (uint32_t j = begin; j < end; ++j)
+                    outputValues[j] = func(outputValues[j], values[j]);
+            }
+
+            if (scale != 1.f)
+            {
+                for (uint32_t j = begin; j < end; ++j)
+                    outputValues[j] *= scale;
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Gradient block is read once and scattered to all results
+    void ScatterMergeGradient(const Tensor& outputGradient, tensor_ptr_vec_t& results, float scale)
+    {
+        outputGradient.CopyToHost();
+        vector<float*> resultsValues;
+        for (auto result : results)
+        {
+            result->OverrideHost();
+            resultsValues.push_back(result->Values());
+        }
+
+        const float* outputGradValues = outputGradient.Values();
+        const int blocksNum = (int)((outputGradient.Length() + MERGE_BLOCK_SIZE - 1) / MERGE_BLOCK_SIZE);
+
+        #pragma omp parallel for if (blocksNum > 1)
+        for (int b = 0; b < blocksNum; ++b)
+        {
+            const uint32_t begin = b * MERGE_BLOCK_SIZE;
+            const uint32_t end = min(outputGradient.Length(), begin + MERGE_BLOCK_SIZE);
+
+            for (auto resultValues : resultsValues)
+            {
+                for (uint32_t j = begin; j < end; ++j)
+                    resultValues[j] = outputGradValues[j] * scale;
+            }
+        }
+    }
+
 	//////////////////////////////////////////////////////////////////////////
 	void Tensor::MergeMin(const const_tensor_ptr_vec_t& inputs, Tensor& output)
 	{
-        output.OverrideHost();
-		inputs[0]->CopyTo(output);
-		for (uint32_t i = 1; i < inputs.size(); ++i)
-		for (uint32_t j = 0; j < output.Length(); ++j)
-			output.m_Storage.Data()[j] = output.m_Storage.Data()[j] > inputs[i]->m_Storage.Data()[j] ? inputs[i]->m_Storage.Data()[j] : output.m_Storage.Data()[j];
+        MergeTemplate(inputs, output, [](float a, float b) { return a > b ? b : a; }, 1.f);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	void Tensor::MergeMax(const const_tensor_ptr_vec_t& inputs, Tensor& output)
 	{
-        output.OverrideHost();
-        inputs[0]->CopyToHost();
-		inputs[0]->CopyTo(output);
-
-        for (uint32_t i = 1; i < inputs.size(); ++i)
-        {
-            inputs[i]->CopyToHost();
-            for (uint32_t j = 0; j < output.Length(); ++j)
-                output.m_Storage.Data()[j] = output.m_Storage.Data()[j] < inputs[i]->m_Storage.Data()[j] ? inputs[i]->m_Storage.Data()[j] : output.m_Storage.Data()[j];
-        }
+        MergeTemplate(inputs, output, [](float a, float b) { return a < b ? b : a; }, 1.f);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	void Tensor::MergeSum(const const_tensor_ptr_vec_t& inputs, Tensor& output)
 	{
-        //output.OverrideHost();
-		output.Zero();
-        for (uint32_t i = 0; i < inputs.size(); ++i)
+        if (output.Op()->OpMode() == GPU)
         {
-            inputs[i]->Add(1.f, 1.f, output, output);
-            /*inputs[i]->CopyToHost();
-            for (uint32_t j = 0; j < result.Length(); ++j)
-                result.m_Storage.Data()[j] += inputs[i]->m_Storage.Data()[j];*/
+            output.Zero();
+            for (uint32_t i = 0; i < inputs.size(); ++i)
+                inputs[i]->Add(1.f, 1.f, output, output);
+            return;
         }
+
+        MergeTemplate(inputs, output, [](float a, float b) { return a + b; }, 1.f);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	void Tensor::MergeAvg(const const_tensor_ptr_vec_t& inputs, Tensor& result)
 	{
-		MergeSum(inputs, result);
-		result.Div((float)inputs.size(), result);
+        if (result.Op()->OpMode() == GPU)
+        {
+            MergeSum(inputs, result);
+            result.Div((float)inputs.size(), result);
+            return;
+        }
+
+        MergeTemplate(inputs, result, [](float a, float b) { return a + b; }, 1.f / inputs.size());
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	void Tensor::MergeMinMaxGradient(const Tensor& output, const const_tensor_ptr_vec_t& inputs, const Tensor& outputGradient, tensor_ptr_vec_t& results)
 	{
-		for (uint32_t i = 0; i < inputs.size(); ++i)
-		{
+        output.CopyToHost();
+        outputGradient.CopyToHost();
+        vector<const float*> inputsValues;
+        vector<float*> resultsValues;
+        for (uint32_t i = 0; i < inputs.size(); ++i)
+        {
             inputs[i]->CopyToHost();
+            inputsValues.push_back(inputs[i]->Values());
             results[i]->OverrideHost();
-			results[i]->Zero();
-			for (uint32_t j = 0; j < output.Length(); ++j)
-				results[i]->m_Storage.Data()[j] = inputs[i]->m_Storage.Data()[j] == output.m_Storage.Data()[j] ? outputGradient.m_Storage.Data()[j] : 0;
-		}
+            resultsValues.push_back(results[i]->Values());
+        }
+
+        const float* outputValues = output.Values();
+        const float* outputGradValues = outputGradient.Values();
+        const int blocksNum = (int)((output.Length() + MERGE_BLOCK_SIZE - 1) / MERGE_BLOCK_SIZE);
+
+        #pragma omp parallel for if (blocksNum > 1)
+        for (int b = 0; b < blocksNum; ++b)
+        {
+            const uint32_t begin = b * MERGE_BLOCK_SIZE;
+            const uint32_t end = min(output.Length(), begin + MERGE_BLOCK_SIZE);
+
+            for (size_t i = 0; i < inputsValues.size(); ++i)
+            {
+                const float* inputValues = inputsValues[i];
+                float* resultValues = resultsValues[i];
+                for (uint32_t j = begin; j < end; ++j)
+                    resultValues[j] = inputValues[j] == outputValues[j] ? outputGradValues[j] : 0;
+            }
+        }
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	void Tensor::MergeSumGradient(const Tensor& output, const const_tensor_ptr_vec_t& inputs, const Tensor& outputGradient, tensor_ptr_vec_t& results)
 	{
-		for (uint32_t i = 0; i < inputs.size(); ++i)
-			outputGradient.CopyTo(*results[i]);
+        if (outputGradient.Op()->OpMode() == GPU)
+        {
+            for (uint32_t i = 0; i < inputs.size(); ++i)
+                outputGradient.CopyTo(*results[i]);
+            return;
+        }
+
+        ScatterMergeGradient(outputGradient, results, 1.f);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
     void Tensor::MergeAvgGradient(const Tensor& output, const const_tensor_ptr_vec_t& inputs, const Tensor& outputGradient, tensor_ptr_vec_t& results)
 	{
-		MergeSumGradient(output, inputs, outputGradient, results);
-		for (uint32_t i = 0; i < results.size(); ++i)
-			results[i]->Div((float)results.size(), *results[i]);
+        if (outputGradient.Op()->OpMode() == GPU)
+        {
+            MergeSumGradient(output, inputs, outputGradient, results);
+            for (uint32_t i = 0; i < results.size(); ++i)
+                results[i]->Div((float)results.size(), *results[i]);
+            return;
+        }
+
+        ScatterMergeGradient(outputGradient, results, 1.f / results.size());
 	}
 
     //////////////////////////////////////////////////////////////////////////
@@ -1545,6 +1721,26 @@ namespace Neuro
         Op()->Pad2DGradient(gradient, left, right, top, bottom, inputGradient);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::PaddedConv2D(const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& output) const
+    {
+        NEURO_ASSERT(GetConvOutputShape(Shape(Width() + left + right, Height() + top + bottom, Depth(), Batch()), kernels.Batch(), kernels.Width(), kernels.Height(), stride, 0, 0, NCHW) == output.GetShape(), "Output shape doesn't match input shape.");
+        NEURO_ASSERT(Depth() == kernels.Depth(), "");
+        Op()->PaddedConv2D(*this, kernels, stride, left, right, top, bottom, border, borderValue, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::PaddedConv2DInputsGradient(const Tensor& gradient, const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, Tensor& inputsGradient) const
+    {
+        Op()->PaddedConv2DInputGradient(gradient, kernels, stride, left, right, top, bottom, border, inputsGradient);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::PaddedConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& kernelsGradient) const
+    {
+        Op()->PaddedConv2DKernelsGradient(input, gradient, stride, left, right, top, bottom, border, borderValue, kernelsGradient);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     Tensor Tensor::ArgMax(EAxis axis) const
 	{
@@ -1850,6 +2046,21 @@ namespace Neuro
 		Op()->Pool2DGradient(output, input, outputGradient, filterSize, stride, type, padding, padding, dataFormat, result);
 	}
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::MaxPool2D(uint32_t filterSize, uint32_t stride, uint32_t padding, EDataFormat dataFormat, Tensor& output, uint8_t* maxIndices) const
+    {
+        NEURO_ASSERT(GetPooling2DOutputShape(GetShape(), filterSize, filterSize, stride, padding, padding, dataFormat) == output.GetShape(), "Output shape doesn't match input shape.");
+        NEURO_ASSERT(output.Batch() == Batch(), "");
+        Op()->MaxPool2D(*this, filterSize, stride, padding, padding, dataFormat, output, maxIndices);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::MaxPool2DGradient(const uint8_t* maxIndices, uint32_t filterSize, uint32_t stride, uint32_t padding, EDataFormat dataFormat, Tensor& result) const
+    {
+        NEURO_ASSERT(GetPooling2DOutputShape(result.GetShape(), filterSize, filterSize, stride, padding, padding, dataFormat) == GetShape(), "Gradient shape doesn't match input shape.");
+        Op()->MaxPool2DGradient(*this, maxIndices, filterSize, stride, padding, padding, dataFormat, result);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Tensor::UpSample2D(uint32_t scaleFactor, Tensor& output) const
     {
@@ -1872,6 +2083,26 @@ namespace Neuro
         Op()->UpSample2DGradient(outputGradient, scaleFactor, inputGradient);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::UpSampleConv2D(const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, Tensor& output) const
+    {
+        NEURO_ASSERT(GetConvOutputShape(Shape(Width() * scaleFactor, Height() * scaleFactor, Depth(), Batch()), kernels.Batch(), kernels.Width(), kernels.Height(), stride, padding, padding, NCHW) == output.GetShape(), "Output shape doesn't match input shape.");
+        NEURO_ASSERT(Depth() == kernels.Depth(), "");
+        Op()->UpSampleConv2D(*this, kernels, scaleFactor, stride, padding, padding, output);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::UpSampleConv2DInputsGradient(const Tensor& gradient, const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t padding, Tensor& inputsGradient) const
+    {
+        Op()->UpSampleConv2DInputGradient(gradient, kernels, scaleFactor, stride, padding, padding, inputsGradient);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::UpSampleConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t scaleFactor, uint32_t stride, uint32_t padding, Tensor& kernelsGradient) const
+    {
+        Op()->UpSampleConv2DKernelsGradient(input, gradient, scaleFactor, stride, padding, padding, kernelsGradient);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     EBatchNormMode GetBatchNormMode(const Shape& inputShape)
     {
@@ -2594,6 +2825,34 @@ namespace Neuro
         m_Storage.Release();
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::TakeData(Tensor& other)
+    {
+        NEURO_ASSERT(m_Shape.Length == other.m_Shape.Length, "Taking over data of tensor of different length.");
+        m_Storage = move(other.m_Storage);
+        m_Storage.Rename(m_Name);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::AliasHost(Tensor& owner, size_t offset)
+    {
+        NEURO_ASSERT(offset + Length() <= owner.Length(), "Aliased region exceeds owner's buffer.");
+        owner.CopyToHost(true);
+        m_Storage.BorrowHost(owner.m_Storage.Data() + offset);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool Tensor::IsAliasOf(const Tensor& owner, size_t offset) const
+    {
+        return m_Storage.IsBorrowed() && IsOnHost() && owner.IsOnHost() && m_Storage.DataUnsafe() == owner.m_Storage.DataUnsafe() + offset;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void Tensor::Unalias()
+    {
+        m_Storage.StopBorrowing();
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void Tensor::OverrideHost()
     {
@@ -3,6 +3,7 @@
 
 #include "Tools.h"
 #include "Tensors/TensorOpCpu.h"
+#include "Tensors/FastMath.h"
 #include "Tensors/Tensor.h"
 
 namespace Neuro
@@ -132,6 +133,73 @@ namespace Neuro
         MatMul(t, transpose, t, !transpose, output);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::GramMatrix(const Tensor& features, float scale, Tensor& output) const
+    {
+        features.CopyToHost();
+        output.OverrideHost();
+
+        const uint32_t rows = features.Depth();
+        const uint32_t cols = features.GetShape().Dim0Dim1;
+        const float* featuresValues = features.Values();
+        float* outputValues = output.Values();
+
+        for (uint32_t n = 0; n < features.Batch(); ++n)
+        {
+            const float* f = featuresValues + n * features.BatchLength();
+            float* g = outputValues + n * output.BatchLength();
+
+            // lower triangle is computed and mirrored to the upper one
+            #pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < (int)rows; ++i)
+            {
+                for (uint32_t j = 0; j <= (uint32_t)i; ++j)
+                {
+                    float sum = 0;
+                    for (uint32_t k = 0; k < cols; ++k)
+                        sum += f[i * cols + k] * f[j * cols + k];
+                    g[i * rows + j] = g[j * rows + i] = sum * scale;
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::GramMatrixGradient(const Tensor& features, const Tensor& outputGradient, float scale, Tensor& inputGradient) const
+    {
+        features.CopyToHost();
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+
+        const uint32_t rows = features.Depth();
+        const uint32_t cols = features.GetShape().Dim0Dim1;
+        const float* featuresValues = features.Values();
+        const float* outputGradValues = outputGradient.Values();
+        float* inputGradValues = inputGradient.Values();
+
+        for (uint32_t n = 0; n < features.Batch(); ++n)
+        {
+            const float* f = featuresValues + n * features.BatchLength();
+            const float* gg = outputGradValues + n * outputGradient.BatchLength();
+            float* fg = inputGradValues + n * inputGradient.BatchLength();
+
+            // G = F*F' so dF = (dG + dG')*F
+            #pragma omp parallel for
+            for (int i = 0; i < (int)rows; ++i)
+            {
+                float* fgRow = fg + i * cols;
+                fill(fgRow, fgRow + cols, 0.f);
+                for (uint32_t j = 0; j < rows; ++j)
+                {
+                    const float s = (gg[i * rows + j] + gg[j * rows + i]) * scale;
+                    const float* fRow = f + j * cols;
+                    for (uint32_t k = 0; k < cols; ++k)
+                        fgRow[k] += s * fRow[k];
+                }
+            }
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
 	void TensorOpCpu::Mul(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const
 	{
@@ -395,10 +463,20 @@ namespace Neuro
         outputGradient.CopyToHost();
         inputGradient.OverrideHost();
 
+        auto inputValues = input.Values();
+        auto outputGradValues = outputGradient.Values();
+        auto inputGradValues = inputGradient.Values();
+
         if (power == 2)
-            outputGradient.Map([&](float g, float x) {return g * 2.f * x; }, input, inputGradient);
+        {
+            for (uint32_t i = 0; i < input.Length(); ++i)
+                inputGradValues[i] = outputGradValues[i] * 2.f * inputValues[i];
+        }
         else
-            outputGradient.Map([&](float g, float x) {return g * power * ::pow(x, power - 1); }, input, inputGradient);
+        {
+            for (uint32_t i = 0; i < input.Length(); ++i)
+                inputGradValues[i] = outputGradValues[i] * power * ::pow(inputValues[i], power - 1);
+        }
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -448,11 +526,16 @@ namespace Neuro
         input.CopyToHost();
         output.OverrideHost();
 
-        auto inputValues = input.Values();
-        auto outputValues = output.Values();
+        FastLog(input.Values(), input.Length(), output.Values());
+    }
 
-        for (uint32_t i = 0; i < input.Length(); ++i)
-            outputValues[i] = ::log(inputValues[i]);
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::Exp(const Tensor& input, Tensor& output) const
+    {
+        input.CopyToHost();
+        output.OverrideHost();
+
+        FastExp(input.Values(), input.Length(), output.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -490,7 +573,7 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::ClipGradient(const Tensor& input, float min, float max, const Tensor& outputGradient, Tensor& inputGradient) const
     {
-        outputGradient.Map([&](float g, float x) {return (x >= min && x <= max) ? g : 0; }, input, inputGradient);
+        outputGradient.Zip([&](float g, float x) {return (x >= min && x <= max) ? g : 0; }, input, inputGradient);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -635,6 +718,234 @@ namespace Neuro
             inputsGradient(w, h, d, n) = gradient(w + left, h + top, d, n);
     }
 
+    namespace
+    {
+        // Maps every (kernel tap, output position) pair to a position in the virtually padded axis. Source is always a valid
+        // input index (for constant border it is clamped and ignored), weight is the ramp factor used by linear ramp border.
+        struct PaddedAxis
+        {
+            PaddedAxis(int inputLen, int outputLen, int kernelLen, int stride, int before, int after, EBorderMode border)
+                : outputLen(outputLen), begin(kernelLen), end(kernelLen), source(kernelLen * outputLen), weight(kernelLen * outputLen, 1.f)
+            {
+                for (int k = 0; k < kernelLen; ++k)
+                {
+                    begin[k] = end[k] = 0;
+                    for (int o = 0; o < outputLen; ++o)
+                    {
+                        int i = o * stride + k - before;
+                        int idx = k * outputLen + o;
+
+                        if (i >= 0 && i < inputLen)
+                        {
+                            if (begin[k] == end[k])
+                                begin[k] = o;
+                            end[k] = o + 1;
+                            source[idx] = i;
+                        }
+                        else if (border == ReflectBorder)
+                        {
+                            if (i < 0)
+                                i = -i;
+                            else
+                                i = abs(inputLen - i % inputLen - 2);
+                            source[idx] = i % inputLen;
+                        }
+                        else
+                        {
+                            source[idx] = i < 0 ? 0 : inputLen - 1;
+                            // same ramp as LinearRampPad2D, it reaches zero at the outermost padded position
+                            if (border == LinearRampBorder)
+                                weight[idx] = i < 0 ? (i + before) / (float)before : (after - (i - inputLen) - 1) / (float)after;
+                        }
+                    }
+                }
+            }
+
+            const int* Source(int k) const { return &source[k * outputLen]; }
+            const float* Weight(int k) const { return &weight[k * outputLen]; }
+            bool Inside(int k, int o) const { return o >= begin[k] && o < end[k]; }
+
+            int outputLen;
+            vector<int> begin; // range of output positions for which tap lies inside input
+            vector<int> end;
+            vector<int> source;
+            vector<float> weight;
+        };
+
+        // Value of padded tensor at border position, weight is product of both axes weights (same formulas as pad functions)
+        inline float BorderValue(float v, float weight, EBorderMode border, float value)
+        {
+            if (border == ConstantBorder)
+                return value;
+            if (border == LinearRampBorder)
+                return weight * (v - value);
+            return v;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::PaddedConv2D(const Tensor& input, const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& output) const
+    {
+        input.CopyToHost();
+        kernels.CopyToHost();
+        output.OverrideHost();
+
+        const int width = input.Width(), height = input.Height(), depth = input.Depth();
+        const int kernelW = kernels.Width(), kernelH = kernels.Height(), outWidth = output.Width(), outHeight = output.Height(), outDepth = output.Depth();
+        const PaddedAxis axisX(width, outWidth, kernelW, stride, left, right, border);
+        const PaddedAxis axisY(height, outHeight, kernelH, stride, top, bottom, border);
+
+        const float* inputValues = input.Values();
+        const float* kernelsValues = kernels.Values();
+        float* outputValues = output.Values();
+
+        #pragma omp parallel for
+        for (int t = 0; t < (int)output.Batch() * outDepth; ++t)
+        {
+            const int n = t / outDepth, outD = t % outDepth;
+            float* out = outputValues + (size_t)t * outWidth * outHeight;
+            fill(out, out + outWidth * outHeight, 0.f);
+
+            for (int kernelD = 0; kernelD < depth; ++kernelD)
+            {
+                const float* in = inputValues + ((size_t)n * depth + kernelD) * width * height;
+                const float* kernel = kernelsValues + ((size_t)outD * depth + kernelD) * kernelW * kernelH;
+
+                for (int kH = 0; kH < kernelH; ++kH)
+                for (int outH = 0; outH < outHeight; ++outH)
+                {
+                    const float* inRow = in + axisY.Source(kH)[outH] * width;
+                    const bool insideY = axisY.Inside(kH, outH);
+                    const float weightY = axisY.Weight(kH)[outH];
+                    float* outRow = out + outH * outWidth;
+
+                    for (int kW = 0; kW < kernelW; ++kW)
+                    {
+                        const float k = kernel[kH * kernelW + kW];
+                        const int* sourceX = axisX.Source(kW);
+                        const float* weightX = axisX.Weight(kW);
+                        const int begin = insideY ? axisX.begin[kW] : outWidth, end = insideY ? axisX.end[kW] : outWidth;
+
+                        for (int outW = 0; outW < begin; ++outW)
+                            outRow[outW] += k * BorderValue(inRow[sourceX[outW]], weightX[outW] * weightY, border, borderValue);
+                        for (int outW = begin; outW < end; ++outW)
+                            outRow[outW] += k * inRow[sourceX[outW]];
+                        for (int outW = end; outW < outWidth; ++outW)
+                            outRow[outW] += k * BorderValue(inRow[sourceX[outW]], weightX[outW] * weightY, border, borderValue);
+                    }
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::PaddedConv2DInputGradient(const Tensor& gradient, const Tensor& kernels, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, Tensor& inputGradient) const
+    {
+        gradient.CopyToHost();
+        kernels.CopyToHost();
+        inputGradient.OverrideHost();
+
+        const int width = inputGradient.Width(), height = inputGradient.Height(), depth = inputGradient.Depth();
+        const int kernelW = kernels.Width(), kernelH = kernels.Height(), outWidth = gradient.Width(), outHeight = gradient.Height(), outDepth = gradient.Depth();
+        const PaddedAxis axisX(width, outWidth, kernelW, stride, left, right, border);
+        const PaddedAxis axisY(height, outHeight, kernelH, stride, top, bottom, border);
+
+        const float* gradientValues = gradient.Values();
+        const float* kernelsValues = kernels.Values();
+        float* inputGradientValues = inputGradient.Values();
+
+        // same as Pad2DGradient following convolution gradient, border taps are dropped rather than propagated to their
+        // source pixels so fused and unfused graphs (and GPU fallback) train identically
+        #pragma omp parallel for
+        for (int t = 0; t < (int)inputGradient.Batch() * depth; ++t)
+        {
+            const int n = t / depth, kernelD = t % depth;
+            float* inGrad = inputGradientValues + (size_t)t * width * height;
+            fill(inGrad, inGrad + width * height, 0.f);
+
+            for (int outD = 0; outD < outDepth; ++outD)
+            {
+                const float* grad = gradientValues + ((size_t)n * outDepth + outD) * outWidth * outHeight;
+                const float* kernel = kernelsValues + ((size_t)outD * depth + kernelD) * kernelW * kernelH;
+
+                for (int kH = 0; kH < kernelH; ++kH)
+                for (int outH = 0; outH < outHeight; ++outH)
+                {
+                    if (!axisY.Inside(kH, outH))
+                        continue;
+
+                    float* inGradRow = inGrad + axisY.Source(kH)[outH] * width;
+                    const float* gradRow = grad + outH * outWidth;
+
+                    for (int kW = 0; kW < kernelW; ++kW)
+                    {
+                        const float k = kernel[kH * kernelW + kW];
+                        const int* sourceX = axisX.Source(kW);
+
+                        for (int outW = axisX.begin[kW]; outW < axisX.end[kW]; ++outW)
+                            inGradRow[sourceX[outW]] += k * gradRow[outW];
+                    }
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::PaddedConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t stride, uint32_t left, uint32_t right, uint32_t top, uint32_t bottom, EBorderMode border, float borderValue, Tensor& kernelsGradient) const
+    {
+        input.CopyToHost();
+        gradient.CopyToHost();
+        kernelsGradient.OverrideHost();
+
+        const int width = input.Width(), height = input.Height(), depth = input.Depth();
+        const int kernelW = kernelsGradient.Width(), kernelH = kernelsGradient.Height(), outWidth = gradient.Width(), outHeight = gradient.Height(), outDepth = gradient.Depth();
+        const PaddedAxis axisX(width, outWidth, kernelW, stride, left, right, border);
+        const PaddedAxis axisY(height, outHeight, kernelH, stride, top, bottom, border);
+
+        const float* inputValues = input.Values();
+        const float* gradientValues = gradient.Values();
+        float* kernelsGradientValues = kernelsGradient.Values();
+
+        #pragma omp parallel for
+        for (int t = 0; t < outDepth * depth; ++t)
+        {
+            const int outD = t / depth, kernelD = t % depth;
+            float* kernelGrad = kernelsGradientValues + (size_t)t * kernelW * kernelH;
+            fill(kernelGrad, kernelGrad + kernelW * kernelH, 0.f);
+
+            for (int n = 0; n < (int)input.Batch(); ++n)
+            {
+                const float* in = inputValues + ((size_t)n * depth + kernelD) * width * height;
+                const float* grad = gradientValues + ((size_t)n * outDepth + outD) * outWidth * outHeight;
+
+                for (int kH = 0; kH < kernelH; ++kH)
+                for (int outH = 0; outH < outHeight; ++outH)
+                {
+                    const float* inRow = in + axisY.Source(kH)[outH] * width;
+                    const bool insideY = axisY.Inside(kH, outH);
+                    const float weightY = axisY.Weight(kH)[outH];
+                    const float* gradRow = grad + outH * outWidth;
+
+                    for (int kW = 0; kW < kernelW; ++kW)
+                    {
+                        const int* sourceX = axisX.Source(kW);
+                        const float* weightX = axisX.Weight(kW);
+                        const int begin = insideY ? axisX.begin[kW] : outWidth, end = insideY ? axisX.end[kW] : outWidth;
+
+                        float sum = 0;
+                        for (int outW = 0; outW < begin; ++outW)
+                            sum += gradRow[outW] * BorderValue(inRow[sourceX[outW]], weightX[outW] * weightY, border, borderValue);
+                        for (int outW = begin; outW < end; ++outW)
+                            sum += gradRow[outW] * inRow[sourceX[outW]];
+                        for (int outW = end; outW < outWidth; ++outW)
+                            sum += gradRow[outW] * BorderValue(inRow[sourceX[outW]], weightX[outW] * weightY, border, borderValue);
+                        kernelGrad[kH * kernelW + kW] += sum;
+                    }
+                }
+            }
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::Roll2D(const Tensor& input, int xShift, int yShift, Tensor& output) const
     {
@@ -806,25 +1117,39 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::Sigmoid(const Tensor& input, Tensor& output) const
     {
-        input.Map([&](float x) { return 1 / (1 + (float)exp(-x)); }, output);
+        input.CopyToHost();
+        output.OverrideHost();
+
+        FastSigmoid(input.Values(), input.Length(), output.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::SigmoidGradient(const Tensor& output, const Tensor& outputGradient, Tensor& inputGradient) const
     {
-        output.Map([&](float x, float x2) { return x * (1 - x) * x2; }, outputGradient, inputGradient);
+        output.CopyToHost();
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+
+        FastSigmoidGradient(output.Values(), outputGradient.Values(), output.Length(), inputGradient.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::Tanh(const Tensor& input, Tensor& output) const
     {
-        input.Map([&](float x) { return 2 / (1 + (float)exp(-2 * x)) - 1; }, output);
+        input.CopyToHost();
+        output.OverrideHost();
+
+        FastTanh(input.Values(), input.Length(), output.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::TanhGradient(const Tensor& output, const Tensor& outputGradient, Tensor& inputGradient) const
     {
-        output.Map([&](float x, float x2) { return (1 - x * x) * x2; }, outputGradient, inputGradient);
+        output.CopyToHost();
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+
+        FastTanhGradient(output.Values(), outputGradient.Values(), output.Length(), inputGradient.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -836,31 +1161,45 @@ namespace Neuro
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::ReLUGradient(const Tensor& output, const Tensor& outputGradient, Tensor& inputGradient) const
     {
-        output.Map([&](float x, float x2) { return x > 0 ? x2 : 0; }, outputGradient, inputGradient);
+        output.Zip([&](float x, float x2) { return x > 0 ? x2 : 0; }, outputGradient, inputGradient);
     }
 
     //////////////////////////////////////////////////////////////////////////
 	void TensorOpCpu::Elu(const Tensor& input, float alpha, Tensor& output) const
 	{
-        input.Map([&](float x) { return x >= 0 ? x : alpha * ((float)exp(x) - 1); }, output);
+        input.CopyToHost();
+        output.OverrideHost();
+
+        FastElu(input.Values(), input.Length(), alpha, output.Values());
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 	void TensorOpCpu::EluGradient(const Tensor& output, const Tensor& outputGradient, float alpha, Tensor& inputGradient) const
 	{
-        output.Map([&](float x, float x2) { return (x > 0 ? 1 : (x + alpha)) * x2; }, outputGradient, inputGradient);
+        output.CopyToHost();
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+
+        FastEluGradient(output.Values(), outputGradient.Values(), output.Length(), alpha, inputGradient.Values());
 	}
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::LeakyReLU(const Tensor& input, float alpha, Tensor& output) const
     {
-        input.Map([&](float x) { return x >= 0 ? x : (alpha * x); }, output);
+        input.CopyToHost();
+        output.OverrideHost();
+
+        FastLeakyReLU(input.Values(), input.Length(), alpha, output.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::LeakyReLUGradient(const Tensor& output, const Tensor& outputGradient, float alpha, Tensor& inputGradient) const
     {
-        output.Map([&](float x, float x2) { return (x > 0 ? 1 : alpha) * x2; }, outputGradient, inputGradient);
+        output.CopyToHost();
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+
+        FastLeakyReLUGradient(output.Values(), outputGradient.Values(), output.Length(), alpha, inputGradient.Values());
     }
 
 	//////////////////////////////////////////////////////////////////////////
@@ -870,7 +1209,7 @@ namespace Neuro
         output.OverrideHost();
 
 		Tensor shifted = input.Sub(input.Max(EAxis::GlobalAxis)(0));
-        Tensor exps = shifted.Map([&](float x) { return (float)exp(x); });
+        Tensor exps = shifted.Exp();
 
         auto expsValues = exps.Values();
         auto outputValues = output.Values();
@@ -997,7 +1336,7 @@ namespace Neuro
         // mGrad = beta1 * mGrad + (1 - beta1) * gradient
         mGrad.Add(beta1, (1 - beta1) * gradScale, gradient, mGrad);
         // vGrad = beta2 * vGrad + (1 - beta2) * sqr(gradient)
-        vGrad.Map([&](float v, float g) { return v * beta2 + (1 - beta2) * gradScale2 * g * g ; }, gradient, vGrad);
+        vGrad.Zip([&](float v, float g) { return v * beta2 + (1 - beta2) * gradScale2 * g * g ; }, gradient, vGrad);
         // parameter = parameter - mGrad / (sqrt(vGrad) + epsilon) * lr
         parameter.Sub(mGrad.Div(vGrad.Map([&](float x) { return (float)::sqrt(x) + epsilon; })).Mul(lr), parameter);
     }
@@ -1336,6 +1675,376 @@ namespace Neuro
         }
 	}
 
+    namespace
+    {
+        // Finds maximum of fully in-bounds window, F is compile-time filter size (0 means runtime filter size)
+        template<int F>
+        inline void WindowMax(const float* src, int rowStride, int filterSize, float& value, uint8_t& index)
+        {
+            const int size = F ? F : filterSize;
+            value = src[0];
+            index = 0;
+            for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+            {
+                float v = src[y * rowStride + x];
+                if (v > value)
+                {
+                    value = v;
+                    index = (uint8_t)(y * size + x);
+                }
+            }
+        }
+
+        template<int F>
+        void MaxPool2DPlaneNCHW(const float* input, int width, int height, int filterSize, int stride, int paddingX, int paddingY, float* output, uint8_t* maxIndices, int outWidth, int outHeight)
+        {
+            const int size = F ? F : filterSize;
+            for (int outH = 0, h = -paddingY; outH < outHeight; ++outH, h += stride)
+            for (int outW = 0, w = -paddingX; outW < outWidth; ++outW, w += stride)
+            {
+                float value;
+                uint8_t index;
+                if (h >= 0 && w >= 0 && h + size <= height && w + size <= width)
+                    WindowMax<F>(input + h * width + w, width, filterSize, value, index);
+                else
+                {
+                    // padded elements are ignored, equivalent to padding with lowest value
+                    value = -numeric_limits<float>().max();
+                    index = 0;
+                    for (int y = max(0, -h); y < min(size, height - h); ++y)
+                    for (int x = max(0, -w); x < min(size, width - w); ++x)
+                    {
+                        float v = input[(h + y) * width + w + x];
+                        if (v > value)
+                        {
+                            value = v;
+                            index = (uint8_t)(y * size + x);
+                        }
+                    }
+                }
+                output[outH * outWidth + outW] = value;
+                maxIndices[outH * outWidth + outW] = index;
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::MaxPool2D(const Tensor& input, uint32_t filterSize, uint32_t stride, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& output, uint8_t* maxIndices) const
+    {
+        NEURO_ASSERT(filterSize * filterSize <= 256, "Max pooling window " << filterSize << "x" << filterSize << " is too large for 8-bit indices.");
+
+        input.CopyToHost();
+        output.OverrideHost();
+
+        const float* inputValues = input.Values();
+        float* outputValues = output.Values();
+
+        if (dataFormat == NCHW)
+        {
+            const int width = input.Width(), height = input.Height(), outWidth = output.Width(), outHeight = output.Height();
+            const int planesNum = (int)(input.Batch() * input.Depth());
+
+            #pragma omp parallel for
+            for (int p = 0; p < planesNum; ++p)
+            {
+                const float* in = inputValues + (size_t)p * width * height;
+                float* out = outputValues + (size_t)p * outWidth * outHeight;
+                uint8_t* indices = maxIndices + (size_t)p * outWidth * outHeight;
+
+                if (filterSize == 2)
+                    MaxPool2DPlaneNCHW<2>(in, width, height, filterSize, stride, paddingX, paddingY, out, indices, outWidth, outHeight);
+                else if (filterSize == 3)
+                    MaxPool2DPlaneNCHW<3>(in, width, height, filterSize, stride, paddingX, paddingY, out, indices, outWidth, outHeight);
+                else
+                    MaxPool2DPlaneNCHW<0>(in, width, height, filterSize, stride, paddingX, paddingY, out, indices, outWidth, outHeight);
+            }
+        }
+        else
+        {
+            // channels are innermost so every window element is compared for all channels at once in a vectorizable loop
+            const int depth = input.Len(0), width = input.Len(1), height = input.Len(2), outWidth = output.Len(1), outHeight = output.Len(2);
+            const int rowsNum = (int)input.Batch() * outHeight;
+
+            #pragma omp parallel for
+            for (int r = 0; r < rowsNum; ++r)
+            {
+                const int n = r / outHeight, outH = r % outHeight, h = outH * (int)stride - (int)paddingY;
+                const float* in = inputValues + (size_t)n * depth * width * height;
+
+                for (int outW = 0, w = -(int)paddingX; outW < outWidth; ++outW, w += (int)stride)
+                {
+                    float* out = outputValues + ((size_t)r * outWidth + outW) * depth;
+                    uint8_t* indices = maxIndices + ((size_t)r * outWidth + outW) * depth;
+
+                    for (int d = 0; d < depth; ++d)
+                    {
+                        out[d] = -numeric_limits<float>().max();
+                        indices[d] = 0;
+                    }
+
+                    for (int y = max(0, -h); y < min((int)filterSize, height - h); ++y)
+                    for (int x = max(0, -w); x < min((int)filterSize, width - w); ++x)
+                    {
+                        const float* src = in + ((size_t)(h + y) * width + w + x) * depth;
+                        const uint8_t index = (uint8_t)(y * filterSize + x);
+                        for (int d = 0; d < depth; ++d)
+                        {
+                            const bool greater = src[d] > out[d];
+                            out[d] = greater ? src[d] : out[d];
+                            indices[d] = greater ? index : indices[d];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::MaxPool2DGradient(const Tensor& outputGradient, const uint8_t* maxIndices, uint32_t filterSize, uint32_t stride, uint32_t paddingX, uint32_t paddingY, EDataFormat dataFormat, Tensor& inputGradient) const
+    {
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+        inputGradient.Zero();
+
+        const float* outputGradientValues = outputGradient.Values();
+        float* inputGradientValues = inputGradient.Values();
+
+        // window offset lookup avoids division per element
+        int offsetY[256], offsetX[256];
+        for (uint32_t i = 0; i < filterSize * filterSize; ++i)
+        {
+            offsetY[i] = i / filterSize - (int)paddingY;
+            offsetX[i] = i % filterSize - (int)paddingX;
+        }
+
+        if (dataFormat == NCHW)
+        {
+            const int width = inputGradient.Width(), height = inputGradient.Height(), outWidth = outputGradient.Width(), outHeight = outputGradient.Height();
+            const int planesNum = (int)(outputGradient.Batch() * outputGradient.Depth());
+
+            // planes are independent so scatter is race free even for overlapping windows
+            #pragma omp parallel for
+            for (int p = 0; p < planesNum; ++p)
+            {
+                const float* grad = outputGradientValues + (size_t)p * outWidth * outHeight;
+                const uint8_t* indices = maxIndices + (size_t)p * outWidth * outHeight;
+                float* inGrad = inputGradientValues + (size_t)p * width * height;
+
+                for (int outH = 0; outH < outHeight; ++outH)
+                for (int outW = 0; outW < outWidth; ++outW)
+                {
+                    const int i = outH * outWidth + outW;
+                    const int h = outH * (int)stride + offsetY[indices[i]], w = outW * (int)stride + offsetX[indices[i]];
+                    if (h >= 0 && w >= 0 && h < height && w < width)
+                        inGrad[h * width + w] += grad[i];
+                }
+            }
+        }
+        else
+        {
+            const int depth = inputGradient.Len(0), width = inputGradient.Len(1), height = inputGradient.Len(2), outWidth = outputGradient.Len(1), outHeight = outputGradient.Len(2);
+            const int DEPTH_BLOCK = 64;
+            const int depthBlocksNum = (depth + DEPTH_BLOCK - 1) / DEPTH_BLOCK;
+            const int tasksNum = (int)outputGradient.Batch() * depthBlocksNum;
+
+            // each task owns range of channels of single sample so scatter is race free even for overlapping windows
+            #pragma omp parallel for
+            for (int t = 0; t < tasksNum; ++t)
+            {
+                const int n = t / depthBlocksNum, firstD = (t % depthBlocksNum) * DEPTH_BLOCK, lastD = min(depth, firstD + DEPTH_BLOCK);
+                float* inGrad = inputGradientValues + (size_t)n * depth * width * height;
+
+                for (int outH = 0; outH < outHeight; ++outH)
+                for (int outW = 0; outW < outWidth; ++outW)
+                {
+                    const size_t offset = (((size_t)n * outHeight + outH) * outWidth + outW) * depth;
+                    for (int d = firstD; d < lastD; ++d)
+                    {
+                        const uint8_t index = maxIndices[offset + d];
+                        const int h = outH * (int)stride + offsetY[index], w = outW * (int)stride + offsetX[index];
+                        if (h >= 0 && w >= 0 && h < height && w < width)
+                            inGrad[((size_t)h * width + w) * depth + d] += outputGradientValues[offset + d];
+                    }
+                }
+            }
+        }
+    }
+
+    namespace
+    {
+        // Maps output positions of convolution over nearest-upsampled axis directly to source positions in low resolution input.
+        // For every kernel offset valid output positions form contiguous range [begin, end) so inner loops don't need bounds checks.
+        struct UpSampledAxis
+        {
+            UpSampledAxis(int inputLen, int outputLen, int kernelLen, int scaleFactor, int stride, int padding)
+                : outputLen(outputLen), begin(kernelLen), end(kernelLen), source(kernelLen * outputLen)
+            {
+                for (int k = 0; k < kernelLen; ++k)
+                {
+                    begin[k] = outputLen;
+                    end[k] = 0;
+                    for (int o = 0; o < outputLen; ++o)
+                    {
+                        int u = o * stride - padding + k; // position in upsampled axis
+                        if (u < 0 || u >= inputLen * scaleFactor)
+                            continue;
+                        begin[k] = min(begin[k], o);
+                        end[k] = o + 1;
+                        source[k * outputLen + o] = u / scaleFactor;
+                    }
+                }
+            }
+
+            const int* Source(int k) const { return &source[k * outputLen]; }
+
+            int outputLen;
+            vector<int> begin;
+            vector<int> end;
+            vector<int> source;
+        };
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::UpSampleConv2D(const Tensor& input, const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t paddingX, uint32_t paddingY, Tensor& output) const
+    {
+        input.CopyToHost();
+        kernels.CopyToHost();
+        output.OverrideHost();
+
+        const int width = input.Width(), height = input.Height(), depth = input.Depth();
+        const int kernelW = kernels.Width(), kernelH = kernels.Height(), outWidth = output.Width(), outHeight = output.Height(), outDepth = output.Depth();
+        const UpSampledAxis axisX(width, outWidth, kernelW, scaleFactor, stride, paddingX);
+        const UpSampledAxis axisY(height, outHeight, kernelH, scaleFactor, stride, paddingY);
+
+        const float* inputValues = input.Values();
+        const float* kernelsValues = kernels.Values();
+        float* outputValues = output.Values();
+
+        #pragma omp parallel for
+        for (int t = 0; t < (int)output.Batch() * outDepth; ++t)
+        {
+            const int n = t / outDepth, outD = t % outDepth;
+            float* out = outputValues + (size_t)t * outWidth * outHeight;
+            fill(out, out + outWidth * outHeight, 0.f);
+
+            for (int kernelD = 0; kernelD < depth; ++kernelD)
+            {
+                const float* in = inputValues + ((size_t)n * depth + kernelD) * width * height;
+                const float* kernel = kernelsValues + ((size_t)outD * depth + kernelD) * kernelW * kernelH;
+
+                for (int kH = 0; kH < kernelH; ++kH)
+                for (int outH = axisY.begin[kH]; outH < axisY.end[kH]; ++outH)
+                {
+                    const float* inRow = in + axisY.Source(kH)[outH] * width;
+                    float* outRow = out + outH * outWidth;
+
+                    for (int kW = 0; kW < kernelW; ++kW)
+                    {
+                        const float k = kernel[kH * kernelW + kW];
+                        const int* sourceX = axisX.Source(kW);
+                        for (int outW = axisX.begin[kW]; outW < axisX.end[kW]; ++outW)
+                            outRow[outW] += k * inRow[sourceX[outW]];
+                    }
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::UpSampleConv2DInputGradient(const Tensor& gradient, const Tensor& kernels, uint32_t scaleFactor, uint32_t stride, uint32_t paddingX, uint32_t paddingY, Tensor& inputGradient) const
+    {
+        gradient.CopyToHost();
+        kernels.CopyToHost();
+        inputGradient.OverrideHost();
+
+        const int width = inputGradient.Width(), height = inputGradient.Height(), depth = inputGradient.Depth();
+        const int kernelW = kernels.Width(), kernelH = kernels.Height(), outWidth = gradient.Width(), outHeight = gradient.Height(), outDepth = gradient.Depth();
+        const UpSampledAxis axisX(width, outWidth, kernelW, scaleFactor, stride, paddingX);
+        const UpSampledAxis axisY(height, outHeight, kernelH, scaleFactor, stride, paddingY);
+
+        const float* gradientValues = gradient.Values();
+        const float* kernelsValues = kernels.Values();
+        float* inputGradientValues = inputGradient.Values();
+
+        // every task owns single input plane so scattering gradients of all upsampled copies of a pixel is race free
+        #pragma omp parallel for
+        for (int t = 0; t < (int)inputGradient.Batch() * depth; ++t)
+        {
+            const int n = t / depth, kernelD = t % depth;
+            float* inGrad = inputGradientValues + (size_t)t * width * height;
+            fill(inGrad, inGrad + width * height, 0.f);
+
+            for (int outD = 0; outD < outDepth; ++outD)
+            {
+                const float* grad = gradientValues + ((size_t)n * outDepth + outD) * outWidth * outHeight;
+                const float* kernel = kernelsValues + ((size_t)outD * depth + kernelD) * kernelW * kernelH;
+
+                for (int kH = 0; kH < kernelH; ++kH)
+                for (int outH = axisY.begin[kH]; outH < axisY.end[kH]; ++outH)
+                {
+                    float* inGradRow = inGrad + axisY.Source(kH)[outH] * width;
+                    const float* gradRow = grad + outH * outWidth;
+
+                    for (int kW = 0; kW < kernelW; ++kW)
+                    {
+                        const float k = kernel[kH * kernelW + kW];
+                        const int* sourceX = axisX.Source(kW);
+                        for (int outW = axisX.begin[kW]; outW < axisX.end[kW]; ++outW)
+                            inGradRow[sourceX[outW]] += k * gradRow[outW];
+                    }
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpu::UpSampleConv2DKernelsGradient(const Tensor& input, const Tensor& gradient, uint32_t scaleFactor, uint32_t stride, uint32_t paddingX, uint32_t paddingY, Tensor& kernelsGradient) const
+    {
+        input.CopyToHost();
+        gradient.CopyToHost();
+        kernelsGradient.OverrideHost();
+
+        const int width = input.Width(), height = input.Height(), depth = input.Depth();
+        const int kernelW = kernelsGradient.Width(), kernelH = kernelsGradient.Height(), outWidth = gradient.Width(), outHeight = gradient.Height(), outDepth = gradient.Depth();
+        const UpSampledAxis axisX(width, outWidth, kernelW, scaleFactor, stride, paddingX);
+        const UpSampledAxis axisY(height, outHeight, kernelH, scaleFactor, stride, paddingY);
+
+        const float* inputValues = input.Values();
+        const float* gradientValues = gradient.Values();
+        float* kernelsGradientValues = kernelsGradient.Values();
+
+        #pragma omp parallel for
+        for (int t = 0; t < outDepth * depth; ++t)
+        {
+            const int outD = t / depth, kernelD = t % depth;
+            float* kernelGrad = kernelsGradientValues + (size_t)t * kernelW * kernelH;
+            fill(kernelGrad, kernelGrad + kernelW * kernelH, 0.f);
+
+            for (int n = 0; n < (int)input.Batch(); ++n)
+            {
+                const float* in = inputValues + ((size_t)n * depth + kernelD) * width * height;
+                const float* grad = gradientValues + ((size_t)n * outDepth + outD) * outWidth * outHeight;
+
+                for (int kH = 0; kH < kernelH; ++kH)
+                for (int outH = axisY.begin[kH]; outH < axisY.end[kH]; ++outH)
+                {
+                    const float* inRow = in + axisY.Source(kH)[outH] * width;
+                    const float* gradRow = grad + outH * outWidth;
+
+                    for (int kW = 0; kW < kernelW; ++kW)
+                    {
+                        const int* sourceX = axisX.Source(kW);
+                        float sum = 0;
+                        for (int outW = axisX.begin[kW]; outW < axisX.end[kW]; ++outW)
+                            sum += gradRow[outW] * inRow[sourceX[outW]];
+                        kernelGrad[kH * kernelW + kW] += sum;
+                    }
+                }
+            }
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::UpSample2D(const Tensor& input, uint32_t scaleFactor, Tensor& output) const
     {
@@ -1367,115 +2076,367 @@ namespace Neuro
             inputGradient(w / scaleFactor, h / scaleFactor, d, n) += outputGradient(w, h, d, n);
     }
 
+    namespace
+    {
+        struct MomentStats
+        {
+            float count = 0;
+            float mean = 0;
+            float m2 = 0; // sum of squared deviations from mean
+        };
+
+        // Chan's parallel variant of Welford's update combining statistics of two disjoint sets
+        inline void MergeStats(MomentStats& a, const MomentStats& b)
+        {
+            float count = a.count + b.count;
+            if (count == 0)
+                return;
+            float delta = b.mean - a.mean;
+            a.mean += delta * (b.count / count);
+            a.m2 += b.m2 + delta * delta * (a.count * b.count / count);
+            a.count = count;
+        }
+
+        // Single pass Welford statistics of contiguous values. Values are interleaved into independent lanes updated in lock
+        // step (sharing 1/count) so the update vectorizes, lanes are merged at the end.
+        MomentStats WelfordStats(const float* x, int len)
+        {
+            const int LANES = 8;
+            float mean[LANES] = {}, m2[LANES] = {};
+            const int steps = len / LANES;
+
+            for (int s = 0; s < steps; ++s)
+            {
+                const float invCount = 1.f / (s + 1);
+                const float* xs = x + s * LANES;
+                for (int i = 0; i < LANES; ++i)
+                {
+                    float delta = xs[i] - mean[i];
+                    mean[i] += delta * invCount;
+                    m2[i] += delta * (xs[i] - mean[i]);
+                }
+            }
+
+            MomentStats stats;
+            for (int i = 0; i < LANES && steps; ++i)
+                MergeStats(stats, { (float)steps, mean[i], m2[i] });
+            for (int i = steps * LANES; i < len; ++i)
+                MergeStats(stats, { 1.f, x[i], 0.f });
+            return stats;
+        }
+
+        // Statistics are computed per group: every WxHxD activation for PerActivation (over batch), every channel for Spatial
+        // (over batch and plane) and every plane for Instance. Returned variance is biased.
+        void NormStatistics(const float* x, EBatchNormMode mode, int batch, int depth, int planeLen, float* mean, float* variance)
+        {
+            if (mode == PerActivation)
+            {
+                const int len = depth * planeLen;
+                const int BLOCK = 256;
+
+                #pragma omp parallel for
+                for (int b = 0; b < (len + BLOCK - 1) / BLOCK; ++b)
+                {
+                    const int begin = b * BLOCK, end = min(len, begin + BLOCK);
+                    fill(mean + begin, mean + end, 0.f);
+                    fill(variance + begin, variance + end, 0.f);
+
+                    for (int n = 0; n < batch; ++n)
+                    {
+                        const float invCount = 1.f / (n + 1);
+                        const float* xn = x + (size_t)n * len;
+                        for (int j = begin; j < end; ++j)
+                        {
+                            float delta = xn[j] - mean[j];
+                            mean[j] += delta * invCount;
+                            variance[j] += delta * (xn[j] - mean[j]);
+                        }
+                    }
+
+                    for (int j = begin; j < end; ++j)
+                        variance[j] /= batch;
+                }
+            }
+            else if (mode == Spatial)
+            {
+                #pragma omp parallel for
+                for (int d = 0; d < depth; ++d)
+                {
+                    MomentStats stats;
+                    for (int n = 0; n < batch; ++n)
+                        MergeStats(stats, WelfordStats(x + ((size_t)n * depth + d) * planeLen, planeLen));
+                    mean[d] = stats.mean;
+                    variance[d] = stats.m2 / stats.count;
+                }
+            }
+            else
+            {
+                #pragma omp parallel for
+                for (int t = 0; t < batch * depth; ++t)
+                {
+                    MomentStats stats = WelfordStats(x + (size_t)t * planeLen, planeLen);
+                    mean[t] = stats.mean;
+                    variance[t] = stats.m2 / stats.count;
+                }
+            }
+        }
+
+        // Computes output = a * x + b (+ c * y when y is provided) where coefficients are per group (see NormStatistics)
+        void NormApply(const float* x, const float* y, EBatchNormMode mode, int batch, int depth, int planeLen, const float* a, const float* b, const float* c, float* output)
+        {
+            #pragma omp parallel for
+            for (int t = 0; t < batch * depth; ++t)
+            {
+                const int d = t % depth;
+                const size_t offset = (size_t)t * planeLen;
+                const float* xp = x + offset;
+                const float* yp = y ? y + offset : nullptr;
+                float* out = output + offset;
+
+                if (mode == PerActivation)
+                {
+                    const float* ap = a + d * planeLen, *bp = b + d * planeLen, *cp = c ? c + d * planeLen : nullptr;
+                    if (yp)
+                        for (int i = 0; i < planeLen; ++i)
+                            out[i] = ap[i] * xp[i] + bp[i] + cp[i] * yp[i];
+                    else
+                        for (int i = 0; i < planeLen; ++i)
+                            out[i] = ap[i] * xp[i] + bp[i];
+                }
+                else
+                {
+                    const int g = mode == Spatial ? d : t;
+                    const float ag = a[g], bg = b[g], cg = c ? c[g] : 0.f;
+                    if (yp)
+                        for (int i = 0; i < planeLen; ++i)
+                            out[i] = ag * xp[i] + bg + cg * yp[i];
+                    else
+                        for (int i = 0; i < planeLen; ++i)
+                            out[i] = ag * xp[i] + bg;
+                }
+            }
+        }
+
+        // Gamma and beta are per group except for Instance mode where they can be shared by all samples in batch
+        inline int NormParamIndex(EBatchNormMode mode, int group, int depth, const Tensor& gamma)
+        {
+            return (mode == Instance && gamma.Batch() == 1) ? group % depth : group;
+        }
+
+        //////////////////////////////////////////////////////////////////////////
+        void NormScaleShift(const Tensor& input, EBatchNormMode mode, const float* mean, const float* invStd, const Tensor& gamma, const Tensor& beta, Tensor& output)
+        {
+            const int groups = mode == PerActivation ? (int)(input.Width() * input.Height() * input.Depth()) : (mode == Spatial ? (int)input.Depth() : (int)(input.Depth() * input.Batch()));
+            const float* gammaValues = gamma.Values();
+            const float* betaValues = beta.Values();
+
+            // normalization, scale and shift are folded into single multiply-add per element
+            vector<float> scale(groups), shift(groups);
+            for (int g = 0; g < groups; ++g)
+            {
+                int p = NormParamIndex(mode, g, input.Depth(), gamma);
+                scale[g] = gammaValues[p] * invStd[g];
+                shift[g] = betaValues[p] - mean[g] * scale[g];
+            }
+
+            NormApply(input.Values(), nullptr, mode, input.Batch(), input.Depth(), input.Width() * input.Height(), scale.data(), shift.data(), nullptr, output.Values());
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::BatchNormalization(const Tensor& input, EBatchNormMode mode, const Tensor& gamma, const Tensor& beta, float epsilon, const Tensor* runningMean, const Tensor* runningVar, Tensor& output) const
     {
-        Tensor xNorm;
+        input.CopyToHost();
+        gamma.CopyToHost();
+        beta.CopyToHost();
+        output.OverrideHost();
+
+        vector<float> mean, invStd;
 
         if (runningMean && runningVar)
         {
-            Tensor xMu = input - *runningMean;
-            xNorm = xMu * (1.f / sqrt(*runningVar + epsilon));
+            runningMean->CopyToHost();
+            runningVar->CopyToHost();
+            mean.assign(runningMean->Values(), runningMean->Values() + runningMean->Length());
+            invStd.assign(runningVar->Values(), runningVar->Values() + runningVar->Length());
         }
         else
         {
             NEURO_ASSERT(mode == Instance, "Running mean and variance can be missing only for Instance normalization.");
-            Tensor xMu = input - mean(input, _01Axes);
-            Tensor xVar = mean(sqr(xMu), _01Axes);
-            xNorm = xMu * (1.f / sqrt(xVar + epsilon));
+            mean.resize(input.Depth() * input.Batch());
+            invStd.resize(mean.size());
+            NormStatistics(input.Values(), mode, input.Batch(), input.Depth(), input.Width() * input.Height(), mean.data(), invStd.data());
         }
 
-        xNorm.MulElem(gamma).Add(beta, output);
+        for (auto& v : invStd)
+            v = 1.f / ::sqrt(v + epsilon);
+
+        NormScaleShift(input, mode, mean.data(), invStd.data(), gamma, beta, output);
     }
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::BatchNormalizationTrain(const Tensor& input, EBatchNormMode mode, const Tensor& gamma, const Tensor& beta, float momentum, float epsilon, Tensor* runningMean, Tensor* runningVar, Tensor& saveMean, Tensor& saveInvVariance, Tensor& output) const
     {
-        EAxis axis;
         float m;
         
         if (mode == PerActivation)
-        {
-            axis = BatchAxis; // mean is of shape WxHxDx1
             m = (float)input.Batch();
-        }
         else if (mode == Spatial)
-        {
-            axis = _013Axes; // mean is of shape 1x1xDx1 // for NHWC format it must be _123Axes
             m = (float)(input.Width() * input.Height() * input.Batch());
-        }
         else if (mode == Instance)
-        {
-            axis = _01Axes; // output is (1x1xDxN)
             m = (float)(input.Width() * input.Height());
-        }
 
         if (m == 1)
         {
             // cannot normalize single values so just copy input to output
             input.CopyTo(output);
+            return;
         }
-        else
-        {
-            input.Mean(axis, saveMean);
-            Tensor xMu = input - saveMean;
-            Tensor var = mean(sqr(xMu), axis);
-            Tensor varSqrt = sqrt(var + epsilon);
-            varSqrt.Inversed(1.f, saveInvVariance);
-            Tensor xNorm = xMu * saveInvVariance;
-            xNorm.MulElem(gamma).Add(beta, output);
 
-            if (runningMean)
-                runningMean->Add(1 - momentum, momentum, saveMean, *runningMean);
+        input.CopyToHost();
+        gamma.CopyToHost();
+        beta.CopyToHost();
+        output.OverrideHost();
+        saveMean.OverrideHost();
+        saveInvVariance.OverrideHost();
 
-            if (runningVar)
-            {
-                Tensor tempVar = var * (m / (m - 1)); // according to the original BN paper
-                runningVar->Add(1 - momentum, momentum, tempVar, *runningVar);
-            }
+        float* mean = saveMean.Values();
+        float* invStd = saveInvVariance.Values();
+        // variance is temporarily stored in inverse standard deviation buffer
+        NormStatistics(input.Values(), mode, input.Batch(), input.Depth(), input.Width() * input.Height(), mean, invStd);
+
+        if (runningMean)
+        {
+            runningMean->CopyToHost(true);
+            float* runningMeanValues = runningMean->Values();
+            for (uint32_t i = 0; i < saveMean.Length(); ++i)
+                runningMeanValues[i] = (1 - momentum) * runningMeanValues[i] + momentum * mean[i];
         }
+
+        if (runningVar)
+        {
+            runningVar->CopyToHost(true);
+            float* runningVarValues = runningVar->Values();
+            for (uint32_t i = 0; i < saveInvVariance.Length(); ++i)
+                runningVarValues[i] = (1 - momentum) * runningVarValues[i] + momentum * invStd[i] * (m / (m - 1)); // according to the original BN paper
+        }
+
+        for (uint32_t i = 0; i < saveInvVariance.Length(); ++i)
+            invStd[i] = 1.f / ::sqrt(invStd[i] + epsilon);
+
+        NormScaleShift(input, mode, mean, invStd, gamma, beta, output);
     }
 
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpu::BatchNormalizationGradient(const Tensor& input, EBatchNormMode mode, const Tensor& gamma, float epsilon, const Tensor& outputGradient, const Tensor& savedMean, const Tensor& savedInvVariance, Tensor& gammaGradient, Tensor& betaGradient, bool trainable, Tensor& inputGradient) const
     {
-        EAxis axis;
         float m;
 
         if (mode == PerActivation)
-        {
-            axis = BatchAxis; // mean is of shape WxHxDx1
             m = (float)input.Batch();
-        }
         else if (mode == Spatial)
-        {
-            axis = _013Axes; // mean is of shape 1x1xDx1 // for NHWC format it must be _123Axes
             m = (float)(input.Width() * input.Height() * input.Batch());
-        }
         else if (mode == Instance)
-        {
-            axis = _01Axes; // output is (1x1xDxN)
             m = (float)(input.Width() * input.Height());
-        }
 
         if (m == 1)
         {
             outputGradient.CopyTo(inputGradient);
             gammaGradient.Zero();
             betaGradient.Zero();
+            return;
+        }
+
+        input.CopyToHost();
+        gamma.CopyToHost();
+        outputGradient.CopyToHost();
+        savedMean.CopyToHost();
+        savedInvVariance.CopyToHost();
+        inputGradient.OverrideHost();
+        gammaGradient.Resize(gamma.GetShape());
+        gammaGradient.OverrideHost();
+        betaGradient.Resize(gamma.GetShape());
+        betaGradient.OverrideHost();
+
+        const int batch = input.Batch(), depth = input.Depth(), planeLen = input.Width() * input.Height();
+        const int groups = savedMean.Length();
+        const float* x = input.Values();
+        const float* grad = outputGradient.Values();
+        const float* mean = savedMean.Values();
+        const float* invStd = savedInvVariance.Values();
+
+        // first pass: per group sums of output gradient and output gradient times normalized input
+        vector<float> sumGrad(groups, 0.f), sumGradXNorm(groups, 0.f);
+
+        if (mode == PerActivation)
+        {
+            const int len = depth * planeLen;
+            const int BLOCK = 256;
+
+            #pragma omp parallel for
+            for (int blk = 0; blk < (len + BLOCK - 1) / BLOCK; ++blk)
+            {
+                const int begin = blk * BLOCK, end = min(len, begin + BLOCK);
+                for (int n = 0; n < batch; ++n)
+                {
+                    const float* xn = x + (size_t)n * len, *gn = grad + (size_t)n * len;
+                    for (int j = begin; j < end; ++j)
+                    {
+                        sumGrad[j] += gn[j];
+                        sumGradXNorm[j] += gn[j] * (xn[j] - mean[j]);
+                    }
+                }
+
+                for (int j = begin; j < end; ++j)
+                    sumGradXNorm[j] *= invStd[j];
+            }
         }
         else
         {
-            Tensor xMu = input - savedMean;
-            Tensor xNorm = xMu * savedInvVariance;
-            Tensor dxNorm = outputGradient * gamma;
-            Tensor dVar = sum(dxNorm * xMu, axis) * -.5f * pow(savedInvVariance, 3);
-            Tensor dMu = sum(dxNorm * -savedInvVariance, axis) + dVar * mean(xMu * -2.f, axis);
+            // for Spatial mode single channel spans planes of all samples
+            const int planesPerGroup = mode == Spatial ? batch : 1;
+            #pragma omp parallel for
+            for (int g = 0; g < groups; ++g)
+            {
+                float sg = 0, sgx = 0;
+                for (int p = 0; p < planesPerGroup; ++p)
+                {
+                    const size_t offset = (size_t)(mode == Spatial ? p * depth + g : g) * planeLen;
+                    const float* xp = x + offset, *gp = grad + offset;
+                    const float mu = mean[g];
+                    for (int i = 0; i < planeLen; ++i)
+                    {
+                        sg += gp[i];
+                        sgx += gp[i] * (xp[i] - mu);
+                    }
+                }
+                sumGrad[g] = sg;
+                sumGradXNorm[g] = sgx * invStd[g];
+            }
+        }
 
-            inputGradient = (dxNorm * savedInvVariance) + (dVar * xMu * 2.f / m) + (dMu / m);
-            gammaGradient = sum(outputGradient * xNorm, axis);
-            betaGradient = sum(outputGradient, axis);
+        const float* gammaValues = gamma.Values();
+        float* gammaGradValues = gammaGradient.Values();
+        float* betaGradValues = betaGradient.Values();
+        fill(gammaGradValues, gammaGradValues + gammaGradient.Length(), 0.f);
+        fill(betaGradValues, betaGradValues + betaGradient.Length(), 0.f);
+
+        // second pass: input gradient expressed as per group multiply-adds of output gradient and input
+        vector<float> a(groups), b(groups), c(groups);
+        for (int g = 0; g < groups; ++g)
+        {
+            int p = NormParamIndex(mode, g, depth, gamma);
+            gammaGradValues[p] += sumGradXNorm[g];
+            betaGradValues[p] += sumGrad[g];
+
+            const float k = gammaValues[p] * invStd[g];
+            const float kx = -k * invStd[g] * sumGradXNorm[g] / m;
+            a[g] = kx;
+            b[g] = -k * sumGrad[g] / m - kx * mean[g];
+            c[g] = k;
         }
+
+        NormApply(x, grad, mode, batch, depth, planeLen, a.data(), b.data(), c.data(), inputGradient.Values());
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -1485,7 +2446,7 @@ namespace Neuro
         saveMask.OverrideHost();
         output.OverrideHost();
 
-        saveMask.FillWithFunc([&]() { return (GlobalRng().NextFloat() < prob ? 0.f : 1.f) / prob; });
+        GlobalPhilox().FillDropoutMask(saveMask.Values(), saveMask.Length(), prob);
         input.MulElem(saveMask, output);
     }
 
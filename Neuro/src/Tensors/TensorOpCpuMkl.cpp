@@ -148,7 +148,7 @@ namespace Neuro
                     output.Values() + d * output.GetShape().Dim0Dim1 + b * output.BatchLength(),
                     ldc);
 
-                uint32_t offset = d * t.GetShape().Dim0Dim1 + b * t.BatchLength();
+                uint32_t offset = d * output.GetShape().Dim0Dim1 + b * output.BatchLength();
 
                 #pragma omp parallel for
                 for (int h = 0; h < (int)output.Height(); ++h)
@@ -158,6 +158,83 @@ namespace Neuro
         }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpuMkl::GramMatrix(const Tensor& features, float scale, Tensor& output) const
+    {
+        features.CopyToHost();
+        output.OverrideHost();
+
+        int n = features.Depth();
+        int k = features.GetShape().Dim0Dim1;
+
+        const float* featuresValues = features.Values();
+        float* outVals = output.Values();
+
+        for (uint32_t b = 0; b < features.Batch(); ++b)
+        {
+            float* gram = outVals + b * output.BatchLength();
+
+            // feature map already is row-major depth x (width * height) matrix
+            cblas_ssyrk(
+                CblasRowMajor,
+                CblasLower,
+                CblasNoTrans,
+                n,
+                k,
+                scale,
+                featuresValues + b * features.BatchLength(),
+                k,
+                0.f,
+                gram,
+                n);
+
+            #pragma omp parallel for
+            for (int h = 0; h < n; ++h)
+            for (int w = h + 1; w < n; ++w)
+                gram[h * n + w] = gram[w * n + h];
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpCpuMkl::GramMatrixGradient(const Tensor& features, const Tensor& outputGradient, float scale, Tensor& inputGradient) const
+    {
+        features.CopyToHost();
+        outputGradient.CopyToHost();
+        inputGradient.OverrideHost();
+
+        int m = features.Depth();
+        int n = features.GetShape().Dim0Dim1;
+
+        const float* featuresValues = features.Values();
+        const float* outputGradValues = outputGradient.Values();
+        float* inputGradValues = inputGradient.Values();
+        vector<float> symGrad(m * m);
+
+        for (uint32_t b = 0; b < features.Batch(); ++b)
+        {
+            // G = F*F' so dF = (dG + dG')*F, only lower triangle of symmetric matrix is referenced
+            const float* gradVals = outputGradValues + b * outputGradient.BatchLength();
+            for (int h = 0; h < m; ++h)
+            for (int w = 0; w <= h; ++w)
+                symGrad[h * m + w] = gradVals[h * m + w] + gradVals[w * m + h];
+
+            cblas_ssymm(
+                CblasRowMajor,
+                CblasLeft,
+                CblasLower,
+                m,
+                n,
+                scale,
+                symGrad.data(),
+                m,
+                featuresValues + b * features.BatchLength(),
+                n,
+                0.f,
+                inputGradValues + b * inputGradient.BatchLength(),
+                n);
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void TensorOpCpuMkl::Transpose(const Tensor& input, Tensor& output) const
     {
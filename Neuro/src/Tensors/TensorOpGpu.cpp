@@ -248,6 +248,102 @@ namespace Neuro
         cudaStreamSynchronize(0);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpGpu::GramMatrix(const Tensor& features, float scale, Tensor& output) const
+    {
+        NVTXProfile nvtxProfile(__FUNCTION__, 0xFF004A7F);
+        features.CopyToDevice();
+        output.OverrideDevice();
+
+        int n = features.Depth();
+        int k = features.GetShape().Dim0Dim1;
+
+        float beta = 0;
+
+        dim3 blocks, threads;
+        GetKernelRunParamsForSequence(output.GetShape().Dim0Dim1, blocks, threads, 128);
+
+        for (uint32_t batch = 0; batch < features.Batch(); ++batch)
+        {
+            float* outputPtr = output.GetDevicePtr() + batch * output.BatchLength();
+
+            // row-major feature map is seen as column-major (width * height) x depth matrix F'
+            CUDA_CHECK(cublasSsyrk_v2(
+                s_CublasHandle,
+                CUBLAS_FILL_MODE_UPPER,
+                CUBLAS_OP_T,
+                n,
+                k,
+                &scale,
+                features.GetDevicePtr() + batch * features.BatchLength(),
+                k,
+                &beta,
+                outputPtr,
+                n));
+
+            CudaKernels::FillSymmetric(blocks, threads, output.GetShape().Dim0Dim1, outputPtr, output.Width());
+        }
+
+        cudaStreamSynchronize(0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void TensorOpGpu::GramMatrixGradient(const Tensor& features, const Tensor& outputGradient, float scale, Tensor& inputGradient) const
+    {
+        NVTXProfile nvtxProfile(__FUNCTION__, 0xFF004A7F);
+        features.CopyToDevice();
+        outputGradient.CopyToDevice();
+        inputGradient.OverrideDevice();
+
+        int m = features.Depth();
+        int n = features.GetShape().Dim0Dim1;
+
+        float one = 1, zero = 0;
+
+        Tensor symGrad(Shape(m, m));
+        symGrad.TryDeviceAllocate();
+        symGrad.OverrideDevice();
+
+        for (uint32_t batch = 0; batch < features.Batch(); ++batch)
+        {
+            const float* gradPtr = outputGradient.GetDevicePtr() + batch * outputGradient.BatchLength();
+
+            // G = F*F' so dF = (dG + dG')*F
+            CUDA_CHECK(cublasSgeam(
+                s_CublasHandle,
+                CUBLAS_OP_N,
+                CUBLAS_OP_T,
+                m,
+                m,
+                &one,
+                gradPtr,
+                m,
+                &one,
+                gradPtr,
+                m,
+                symGrad.GetDevicePtr(),
+                m));
+
+            // in column-major order it is dF' = F'*S
+            CUDA_CHECK(cublasSsymm_v2(
+                s_CublasHandle,
+                CUBLAS_SIDE_RIGHT,
+                CUBLAS_FILL_MODE_UPPER,
+                n,
+                m,
+                &scale,
+                symGrad.GetDevicePtr(),
+                m,
+                features.GetDevicePtr() + batch * features.BatchLength(),
+                n,
+                &zero,
+                inputGradient.GetDevicePtr() + batch * inputGradient.BatchLength(),
+                n));
+        }
+
+        cudaStreamSynchronize(0);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void TensorOpGpu::Mul(float alpha, const Tensor& t1, float beta, const Tensor& t2, Tensor& output) const
     {
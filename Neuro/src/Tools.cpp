@@ -12,6 +12,7 @@
 #include <nvToolsExt.h>
 
 #include "Tools.h"
+#include "Profiler.h"
 #include "Tensors/Tensor.h"
 #include "ComputationalGraph/Variable.h"
 
@@ -24,6 +25,7 @@ namespace fs = std::experimental::filesystem;
 namespace Neuro
 {
     Random g_Rng;
+    Philox g_Philox;
     
     //////////////////////////////////////////////////////////////////////////
     Random& GlobalRng()
@@ -31,10 +33,17 @@ namespace Neuro
         return g_Rng;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    Philox& GlobalPhilox()
+    {
+        return g_Philox;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void GlobalRngSeed(unsigned int seed)
     {
         g_Rng = Random(seed);
+        g_Philox.Seed(seed);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -884,7 +893,7 @@ namespace Neuro
         g = sqrt(sqr(iX) + sqr(iY));
         g.Mul(255.f / g.Max(GlobalAxis)(0), g);
 
-        theta = iY.Map([](float y, float x) { return atan2(y, x); }, iX);
+        theta = iY.Zip([](float y, float x) { return atan2(y, x); }, iX);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -1116,6 +1125,12 @@ namespace Neuro
 
         nvtxRangePushEx(&eventAttrib);
 #endif
+        if (Profiler::IsEnabled())
+        {
+            m_Message = message;
+            m_StartBytes = Profiler::ThreadAllocatedBytes();
+            m_StartUs = Profiler::NowUs();
+        }
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -1124,6 +1139,8 @@ namespace Neuro
 #ifdef CUDA_PROFILING_ENABLED
         nvtxRangePop();
 #endif
+        if (m_StartUs >= 0)
+            Profiler::Record(m_Message, "", "scope", m_StartUs, Profiler::ThreadAllocatedBytes() - m_StartBytes, 0);
     }
 
     //////////////////////////////////////////////////////////////////////////